@@ -0,0 +1,64 @@
+#include "../Benchmark.h"
+#include "Archive/BitStreamReader.h"
+#include "Archive/WordBitStreamReader.h"
+#include "../../test/PseudoRandom.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace OP2Utility;
+
+namespace {
+	const std::vector<uint8_t>& SampleData()
+	{
+		static const auto data = MakePseudoRandomData(1 << 20, 5);
+		return data;
+	}
+
+	// Reads every bit of the sample data one bit at a time
+	template <typename BitReader>
+	void TimeReadNextBit(const std::string& name)
+	{
+		const auto& data = SampleData();
+		unsigned int sum = 0;
+
+		auto seconds = Benchmark::Time([&] {
+			BitReader bitReader(const_cast<uint8_t*>(data.data()), data.size());
+			while (!bitReader.EndOfStream()) {
+				sum += bitReader.ReadNextBit();
+			}
+			Benchmark::DoNotOptimize(&sum);
+		});
+
+		Benchmark::ReportRate(name + " ReadNextBit", seconds, data.size() * 8, "bit");
+	}
+
+	// Reads the sample data the way the table driven decoder does: peek a fixed number of bits,
+	// and consume a varying number of them
+	template <typename BitReader>
+	void TimePeekConsume(const std::string& name)
+	{
+		const auto& data = SampleData();
+		unsigned int sum = 0;
+
+		auto seconds = Benchmark::Time([&] {
+			BitReader bitReader(const_cast<uint8_t*>(data.data()), data.size());
+			while (!bitReader.EndOfStream()) {
+				const auto bits = bitReader.PeekBits(10);
+				sum += bits;
+				bitReader.ConsumeBits((bits & 7) + 3);
+			}
+			Benchmark::DoNotOptimize(&sum);
+		});
+
+		Benchmark::ReportRate(name + " PeekBits/ConsumeBits", seconds, data.size() * 8, "bit");
+	}
+}
+
+BENCHMARK(BitStreamReaderThroughput)
+{
+	TimeReadNextBit<Archive::BitStreamReader>("BitStreamReader");
+	TimeReadNextBit<Archive::WordBitStreamReader>("WordBitStreamReader");
+	TimePeekConsume<Archive::BitStreamReader>("BitStreamReader");
+	TimePeekConsume<Archive::WordBitStreamReader>("WordBitStreamReader");
+}
@@ -0,0 +1,137 @@
+#include "../Benchmark.h"
+#include "Archive/HuffLZ.h"
+#include "Archive/HuffLZEncoder.h"
+#include "Archive/HuffLZReader.h"
+#include "Stream/MemoryReader.h"
+#include "../../test/PseudoRandom.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+
+using namespace OP2Utility;
+
+namespace {
+	// Text-like data built from a small vocabulary, similar in redundancy to game data files
+	std::vector<uint8_t> MakeSampleData(std::size_t size)
+	{
+		const char* words[] = { "Eden ", "Plymouth ", "colony ", "structure ", "vehicle ", "research ",
+			"tube ", "command center ", "0x", "12", "\r\n", "= ", "; ", "Agridome ", "Tokamak " };
+
+		std::vector<uint8_t> data;
+		PseudoRandom random(1);
+		while (data.size() < size) {
+			const std::string word = words[random.Next() % (sizeof(words) / sizeof(words[0]))];
+			data.insert(data.end(), word.begin(), word.end());
+		}
+		data.resize(size);
+		return data;
+	}
+
+	const std::vector<uint8_t>& SampleCompressedData(std::size_t& decompressedSize)
+	{
+		static const auto data = MakeSampleData(1 << 20);
+		static const auto compressed = [] {
+			std::vector<uint8_t> compressed;
+			Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed);
+			return compressed;
+		}();
+
+		decompressedSize = data.size();
+		return compressed;
+	}
+
+	template <typename BitReader>
+	void DecompressWithPrefixTable(const std::string& name, unsigned int prefixTableBitCount)
+	{
+		std::size_t decompressedSize;
+		const auto& compressed = SampleCompressedData(decompressedSize);
+		std::vector<char> decompressed(decompressedSize);
+
+		auto seconds = Benchmark::Time([&] {
+			Archive::BasicHuffLZ<BitReader> decompressor(BitReader(const_cast<uint8_t*>(compressed.data()), compressed.size()), prefixTableBitCount);
+			decompressor.GetData(decompressed.data(), decompressed.size());
+			Benchmark::DoNotOptimize(decompressed.data());
+		});
+
+		Benchmark::Report(name + " decompress (prefix table bits: " + std::to_string(prefixTableBitCount) + ")",
+			seconds, decompressedSize);
+	}
+}
+
+BENCHMARK(HuffLZDecompress)
+{
+	for (unsigned int prefixTableBitCount : { 0u, 6u, 8u, 10u, 12u }) {
+		DecompressWithPrefixTable<Archive::BitStreamReader>("HuffLZ", prefixTableBitCount);
+	}
+	DecompressWithPrefixTable<Archive::WordBitStreamReader>("WordHuffLZ", Archive::WordHuffLZ::DefaultPrefixTableBitCount);
+}
+
+BENCHMARK(HuffLZDecompressInto)
+{
+	std::size_t decompressedSize;
+	const auto& compressed = SampleCompressedData(decompressedSize);
+	std::vector<char> decompressed(decompressedSize);
+
+	auto seconds = Benchmark::Time([&] {
+		Archive::WordHuffLZ decompressor(Archive::WordBitStreamReader(compressed.data(), compressed.size()));
+		decompressor.DecompressInto(decompressed.data(), decompressed.size());
+		Benchmark::DoNotOptimize(decompressed.data());
+	});
+
+	Benchmark::Report("WordHuffLZ decompress into output buffer", seconds, decompressedSize);
+}
+
+BENCHMARK(HuffLZReaderSeek)
+{
+	std::size_t decompressedSize;
+	const auto& compressed = SampleCompressedData(decompressedSize);
+	const std::size_t seekCount = 64;
+
+	// The sample may hold more codes than the encoder could finish, so measure what decodes
+	{
+		std::vector<char> decompressed(decompressedSize);
+		Archive::WordHuffLZ decompressor(Archive::WordBitStreamReader(compressed.data(), compressed.size()));
+		decompressedSize = decompressor.DecompressInto(decompressed.data(), decompressed.size());
+	}
+
+	for (uint64_t checkpointInterval : { 0u, 16384u, 65536u }) {
+		Archive::HuffLZReader reader(std::make_unique<Stream::MemoryReader>(compressed.data(), compressed.size()), decompressedSize, checkpointInterval);
+
+		// Alternate between the far end and the middle of the stream
+		auto seconds = Benchmark::Time([&] {
+			char value;
+			for (std::size_t i = 0; i < seekCount; ++i) {
+				reader.Seek((i % 2 == 0) ? decompressedSize - 1 : (decompressedSize / 2 + i));
+				reader.Read(value);
+			}
+			Benchmark::DoNotOptimize(&value);
+		});
+
+		Benchmark::ReportRate("HuffLZReader seek (checkpoint interval: " + std::to_string(checkpointInterval) + ")",
+			seconds, seekCount, "seeks");
+	}
+}
+
+BENCHMARK(HuffLZCompressLevels)
+{
+	const auto data = MakeSampleData(1 << 18);
+	const std::pair<Archive::HuffLZEncoder::CompressionLevel, std::string> levels[] = {
+		{ Archive::HuffLZEncoder::CompressionLevel::Fast, "fast" },
+		{ Archive::HuffLZEncoder::CompressionLevel::Lazy, "lazy" },
+		{ Archive::HuffLZEncoder::CompressionLevel::Optimal, "optimal" },
+	};
+
+	for (const auto& level : levels) {
+		std::vector<uint8_t> compressed;
+		auto seconds = Benchmark::Time([&] {
+			Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed, SIZE_MAX, level.first);
+			Benchmark::DoNotOptimize(compressed.data());
+		});
+
+		const auto ratioPercent = compressed.size() * 100.0 / data.size();
+		Benchmark::Report("HuffLZ compress (level: " + level.second + ", ratio: " + std::to_string(ratioPercent).substr(0, 5) + "%)",
+			seconds, data.size());
+	}
+}
@@ -0,0 +1,156 @@
+#include "../Benchmark.h"
+#include "Archive/VolFile.h"
+#include "Archive/ArchiveIndexCache.h"
+#include "Stream/FileWriter.h"
+#include "XFile.h"
+#include "ParallelFor.h"
+#include "../../test/PseudoRandom.h"
+#include <string>
+#include <vector>
+
+using namespace OP2Utility;
+
+namespace {
+	// Creates a volume of many small uncompressed files, like a typical sprite or sound volume
+	class SmallFileVolume
+	{
+	public:
+		SmallFileVolume(std::size_t fileCount, std::size_t fileSize) : filename("BenchmarkSmallFiles.vol")
+		{
+			std::vector<std::string> filesToPack;
+			const std::string contents(fileSize, 'x');
+			for (std::size_t i = 0; i < fileCount; ++i) {
+				filesToPack.push_back("BenchmarkFile" + std::to_string(i) + ".txt");
+				Stream::FileWriter(filesToPack.back()).Write(contents.data(), contents.size());
+			}
+
+			Archive::VolFile::CreateArchive(filename, filesToPack);
+
+			for (const auto& fileToPack : filesToPack) {
+				XFile::DeletePath(fileToPack);
+			}
+		}
+
+		~SmallFileVolume()
+		{
+			XFile::DeletePath(filename);
+		}
+
+		const std::string filename;
+	};
+
+	void TimeReadAllEntries(const std::string& name, const std::string& volumeFilename, Archive::ArchiveBackend backend)
+	{
+		Archive::VolFile volFile(volumeFilename, backend);
+		std::vector<char> buffer(volFile.GetSize(0));
+
+		auto seconds = Benchmark::Time([&] {
+			for (std::size_t i = 0; i < volFile.GetCount(); ++i) {
+				auto stream = volFile.OpenStream(i);
+				stream->Read(buffer.data(), buffer.size());
+			}
+			Benchmark::DoNotOptimize(buffer.data());
+		});
+
+		Benchmark::ReportRate(name, seconds, volFile.GetCount(), "entries");
+	}
+}
+
+BENCHMARK(VolFileOpenSmallEntries)
+{
+	SmallFileVolume volume(500, 1024);
+	TimeReadAllEntries("VolFile OpenStream+Read 1KB entries (file stream)", volume.filename, Archive::ArchiveBackend::FileStream);
+	TimeReadAllEntries("VolFile OpenStream+Read 1KB entries (mapped)", volume.filename, Archive::ArchiveBackend::MemoryMapped);
+}
+
+BENCHMARK(VolFileGetIndex)
+{
+	SmallFileVolume volume(2000, 16);
+	Archive::VolFile volFile(volume.filename);
+
+	std::vector<std::string> names;
+	for (std::size_t i = 0; i < volFile.GetCount(); ++i) {
+		names.push_back(volFile.GetName(i));
+	}
+
+	std::size_t indexSum = 0;
+	auto seconds = Benchmark::Time([&] {
+		for (const auto& name : names) {
+			indexSum += volFile.GetIndex(name);
+		}
+	});
+	Benchmark::DoNotOptimize(&indexSum);
+
+	Benchmark::ReportRate("VolFile GetIndex, 2000 entries", seconds, names.size(), "lookups");
+}
+
+BENCHMARK(VolFileCreateArchiveLzh)
+{
+	std::vector<Archive::PackSource> sources;
+	PseudoRandom random(1);
+	for (std::size_t i = 0; i < 64; ++i) {
+		// Text-like data, which compresses moderately
+		std::vector<uint8_t> contents(32 * 1024);
+		for (auto& byte : contents) {
+			byte = static_cast<uint8_t>('a' + random.Next() % 8);
+		}
+		sources.push_back(Archive::PackSource::FromBuffer("BenchmarkFile" + std::to_string(i) + ".txt", std::move(contents)));
+	}
+
+	const std::string filename("BenchmarkLzh.vol");
+	for (std::size_t threadCount : { std::size_t(1), HardwareThreadCount() }) {
+		auto seconds = Benchmark::Time([&] {
+			Archive::VolFile::CreateArchiveFromSources(filename, sources, Archive::CompressionType::LZH, Archive::HuffLZEncoder::CompressionLevel::Fast, threadCount);
+		});
+		Benchmark::Report("VolFile CreateArchive LZH, 64 x 32KB, " + std::to_string(threadCount) + " thread(s)", seconds, sources.size() * 32 * 1024);
+	}
+
+	XFile::DeletePath(filename);
+}
+
+BENCHMARK(VolFileExtractFiles)
+{
+	SmallFileVolume volume(2000, 1024);
+	Archive::VolFile volFile(volume.filename);
+
+	std::vector<std::size_t> indexes(volFile.GetCount());
+	for (std::size_t i = 0; i < indexes.size(); ++i) {
+		indexes[i] = i;
+	}
+	std::vector<uint8_t> buffer(volFile.GetSize(0));
+
+	auto seconds = Benchmark::Time([&] {
+		for (auto index : indexes) {
+			volFile.ReadFile(index, buffer.data(), buffer.size());
+		}
+		Benchmark::DoNotOptimize(buffer.data());
+	});
+	Benchmark::ReportRate("VolFile ReadFile each of 2000 1KB entries", seconds, indexes.size(), "entries");
+
+	seconds = Benchmark::Time([&] {
+		volFile.ExtractFiles(indexes, [&](std::size_t, Stream::BidirectionalReader& contents) {
+			contents.Read(buffer.data(), buffer.size());
+		});
+		Benchmark::DoNotOptimize(buffer.data());
+	});
+	Benchmark::ReportRate("VolFile ExtractFiles 2000 1KB entries", seconds, indexes.size(), "entries");
+}
+
+BENCHMARK(VolFileOpenWithIndexCache)
+{
+	SmallFileVolume volume(2000, 16);
+	Archive::ArchiveIndexCache indexCache;
+	Archive::VolFile(volume.filename, Archive::ArchiveBackend::FileStream, &indexCache);
+
+	auto parseSeconds = Benchmark::Time([&] {
+		Archive::VolFile volFile(volume.filename);
+		Benchmark::DoNotOptimize(&volFile);
+	});
+	Benchmark::Report("VolFile open 2000 entries (parsed)", parseSeconds);
+
+	auto cachedSeconds = Benchmark::Time([&] {
+		Archive::VolFile volFile(volume.filename, Archive::ArchiveBackend::FileStream, &indexCache);
+		Benchmark::DoNotOptimize(&volFile);
+	});
+	Benchmark::Report("VolFile open 2000 entries (index cache)", cachedSeconds);
+}
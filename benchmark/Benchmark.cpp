@@ -0,0 +1,86 @@
+#include "Benchmark.h"
+#include "XFile.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace Benchmark
+{
+	namespace {
+		std::vector<std::pair<const char*, Function>>& Registry()
+		{
+			static std::vector<std::pair<const char*, Function>> registry;
+			return registry;
+		}
+	}
+
+	Registration::Registration(const char* name, Function function)
+	{
+		Registry().emplace_back(name, function);
+	}
+
+	double Time(const std::function<void()>& function, double minSeconds)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		// Warm up caches before timing
+		function();
+
+		std::size_t runCount = 0;
+		const auto startTime = Clock::now();
+		std::chrono::duration<double> elapsed{};
+		do {
+			function();
+			++runCount;
+			elapsed = Clock::now() - startTime;
+		} while (elapsed.count() < minSeconds);
+
+		return elapsed.count() / runCount;
+	}
+
+	void Report(const std::string& name, double secondsPerRun, std::size_t bytesPerRun)
+	{
+		std::printf("%-48s %12.3f us", name.c_str(), secondsPerRun * 1e6);
+		if (bytesPerRun > 0) {
+			std::printf(" %10.2f MB/s", bytesPerRun / secondsPerRun / (1024 * 1024));
+		}
+		std::printf("\n");
+	}
+
+	void ReportRate(const std::string& name, double secondsPerRun, std::size_t unitsPerRun, const std::string& unit)
+	{
+		std::printf("%-48s %12.3f us %10.2f M%s/s\n", name.c_str(), secondsPerRun * 1e6,
+			unitsPerRun / secondsPerRun / 1e6, unit.c_str());
+	}
+
+	// Writes to a volatile object with external linkage can not be optimized out
+	const void* volatile optimizationSink;
+
+	void DoNotOptimize(const void* value)
+	{
+		optimizationSink = value;
+	}
+
+	TemporaryFile::TemporaryFile(std::string filename) : filename(std::move(filename)) { }
+
+	TemporaryFile::~TemporaryFile()
+	{
+		OP2Utility::XFile::DeletePath(filename);
+	}
+}
+
+// Runs all benchmarks, or only those whose name contains the first argument
+int main(int argc, char* argv[])
+{
+	const char* filter = argc > 1 ? argv[1] : "";
+
+	for (const auto& benchmark : Benchmark::Registry()) {
+		if (std::strstr(benchmark.first, filter) != nullptr) {
+			benchmark.second();
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// Minimal benchmark registry and timer
+// Benchmarks register themselves at static initialization time, and are run by the benchmark main
+
+namespace Benchmark
+{
+	using Function = void(*)();
+
+	// Registers a benchmark to be run by name
+	struct Registration
+	{
+		Registration(const char* name, Function function);
+	};
+
+	// Runs function repeatedly for at least minSeconds, and returns the average seconds per run
+	double Time(const std::function<void()>& function, double minSeconds = 0.5);
+
+	// Prints the average time per run, and throughput if bytesPerRun is non-zero
+	void Report(const std::string& name, double secondsPerRun, std::size_t bytesPerRun = 0);
+	// Prints the average time per run, and the rate in millions of units per second
+	void ReportRate(const std::string& name, double secondsPerRun, std::size_t unitsPerRun, const std::string& unit);
+
+	// Prevents the optimizer from discarding a computed value
+	void DoNotOptimize(const void* value);
+
+	// Names a file a benchmark writes, and deletes it on destruction
+	class TemporaryFile
+	{
+	public:
+		explicit TemporaryFile(std::string filename);
+		~TemporaryFile();
+		TemporaryFile(const TemporaryFile&) = delete;
+		TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+		const std::string filename;
+	};
+}
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static const Benchmark::Registration name##Registration(#name, name); \
+	static void name()
@@ -0,0 +1,61 @@
+#include "../Benchmark.h"
+#include "Bitmap/BitmapFile.h"
+#include "Stream/DynamicMemoryWriter.h"
+#include "Stream/MemoryReader.h"
+#include "Stream/FileWriter.h"
+#include "XFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+using namespace OP2Utility;
+
+namespace {
+	// An 8 bit indexed bitmap, such as a tileset
+	BitmapFile MakeSampleBitmap(uint32_t width = 1024, int32_t height = -1024)
+	{
+		std::vector<uint8_t> pixels(ImageHeader::CalculatePitch(8, static_cast<int32_t>(width)) * std::abs(height));
+		for (std::size_t i = 0; i < pixels.size(); ++i) {
+			pixels[i] = static_cast<uint8_t>(i * 7);
+		}
+
+		return BitmapFile::CreateIndexed(8, width, height, std::vector<Color>(256), pixels);
+	}
+}
+
+BENCHMARK(BitmapFileRead)
+{
+	Stream::DynamicMemoryWriter writer;
+	MakeSampleBitmap().WriteIndexed(writer);
+	auto contents = writer.GetReader();
+	const auto fileSize = static_cast<std::size_t>(contents.Length());
+
+	auto seconds = Benchmark::Time([&] {
+		auto bitmapFile = BitmapFile::ReadIndexed(contents.Slice(0, fileSize));
+		Benchmark::DoNotOptimize(&bitmapFile);
+	});
+	Benchmark::Report("BitmapFile::ReadIndexed 1024 x 1024 (MemoryReader)", seconds, fileSize);
+}
+
+BENCHMARK(BitmapFileWrite)
+{
+	const std::string filename("BenchmarkWrite.bmp");
+
+	// Narrow bitmaps write a short row and its padding per scan line
+	for (uint32_t width : { 1024u, 30u }) {
+		const auto bitmapFile = MakeSampleBitmap(width, -static_cast<int32_t>(1024 * 1024 / width));
+
+		// A buffer size of 1 passes each write straight to the file stream
+		for (std::size_t bufferSize : { std::size_t(1), Stream::FileWriter::DefaultBufferSize }) {
+			auto seconds = Benchmark::Time([&] {
+				Stream::FileWriter writer(filename, Stream::FileWriter::OpenMode::Default, bufferSize);
+				bitmapFile.WriteIndexed(writer);
+			});
+			const auto fileSize = static_cast<std::size_t>(XFile::GetFileSize(filename));
+			Benchmark::Report("BitmapFile::WriteIndexed width " + std::to_string(width) + " (FileWriter buffer size: " + std::to_string(bufferSize) + ")", seconds, fileSize);
+		}
+	}
+
+	XFile::DeletePath(filename);
+}
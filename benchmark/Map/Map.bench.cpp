@@ -0,0 +1,69 @@
+#include "../Benchmark.h"
+#include "Map/Map.h"
+#include "Stream/FileReader.h"
+#include "Stream/MemoryReader.h"
+#include "Stream/FileWriter.h"
+#include "XFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace OP2Utility;
+
+namespace {
+	// Many tilesets and tile groups, each read with several small reads
+	Map MakeSampleMap()
+	{
+		Map map;
+		for (uint32_t i = 0; i < 512; ++i) {
+			map.tilesetSources.push_back(TilesetSource{ "well" + std::to_string(1000 + i), 32 });
+		}
+		for (uint32_t i = 0; i < 4000; ++i) {
+			map.tileGroups.push_back(TileGroup{ "Group " + std::to_string(i), 2, 2, { i, i + 1, i + 2, i + 3 } });
+		}
+		return map;
+	}
+}
+
+BENCHMARK(MapRead)
+{
+	Benchmark::TemporaryFile sample("BenchmarkSample.map");
+	MakeSampleMap().Write(sample.filename);
+	const auto fileSize = static_cast<std::size_t>(XFile::GetFileSize(sample.filename));
+
+	// A buffer size of 1 reads the file once per field
+	for (std::size_t bufferSize : { std::size_t(1), Stream::FileReader::DefaultBufferSize }) {
+		auto seconds = Benchmark::Time([&] {
+			auto map = Map::ReadMap(Stream::FileReader(sample.filename, bufferSize));
+			Benchmark::DoNotOptimize(&map);
+		});
+		Benchmark::Report("Map::ReadMap (FileReader buffer size: " + std::to_string(bufferSize) + ")", seconds, fileSize);
+	}
+
+	std::vector<uint8_t> contents(fileSize);
+	Stream::FileReader(sample.filename).Read(contents);
+	auto seconds = Benchmark::Time([&] {
+		auto map = Map::ReadMap(Stream::MemoryReader(contents.data(), contents.size()));
+		Benchmark::DoNotOptimize(&map);
+	});
+	Benchmark::Report("Map::ReadMap (MemoryReader)", seconds, fileSize);
+}
+
+BENCHMARK(MapWrite)
+{
+	const auto map = MakeSampleMap();
+	const std::string filename("BenchmarkWrite.map");
+	std::size_t fileSize = 0;
+
+	// A buffer size of 1 passes each field straight to the file stream
+	for (std::size_t bufferSize : { std::size_t(1), Stream::FileWriter::DefaultBufferSize }) {
+		auto seconds = Benchmark::Time([&] {
+			Stream::FileWriter writer(filename, Stream::FileWriter::OpenMode::Default, bufferSize);
+			map.Write(writer);
+		});
+		fileSize = static_cast<std::size_t>(XFile::GetFileSize(filename));
+		Benchmark::Report("Map::Write (FileWriter buffer size: " + std::to_string(bufferSize) + ")", seconds, fileSize);
+	}
+
+	XFile::DeletePath(filename);
+}
@@ -0,0 +1,102 @@
+#include "../Benchmark.h"
+#include "Sprite/ArtFile.h"
+#include "Stream/FileReader.h"
+#include "Stream/FileHandleReader.h"
+#include "Stream/BufferedReader.h"
+#include "Stream/MemoryReader.h"
+#include "Stream/FileWriter.h"
+#include "XFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+using namespace OP2Utility;
+
+namespace {
+	// Many animations of small frames, read a few bytes at a time
+	ArtFile MakeSampleArtFile()
+	{
+		ArtFile artFile;
+		artFile.palettes.push_back(Palette8Bit());
+		artFile.unknownAnimationCount = 0;
+
+		for (uint32_t i = 0; i < 1000; ++i) {
+			ImageMeta imageMeta{};
+			imageMeta.width = 30;
+			imageMeta.height = 20;
+			imageMeta.scanLineByteWidth = 32;
+			artFile.imageMetas.push_back(imageMeta);
+		}
+
+		for (uint32_t i = 0; i < 2000; ++i) {
+			Animation animation{};
+			for (uint16_t frameIndex = 0; frameIndex < 8; ++frameIndex) {
+				Animation::Frame frame{};
+				frame.layerMetadata.count = 2;
+				frame.layerMetadata.bReadOptionalData = frameIndex % 2;
+				frame.layers.resize(2, Animation::Frame::Layer{ frameIndex, 0, static_cast<uint8_t>(frameIndex), {} });
+				animation.frames.push_back(frame);
+			}
+			artFile.animations.push_back(animation);
+		}
+
+		return artFile;
+	}
+}
+
+BENCHMARK(ArtFileRead)
+{
+	Benchmark::TemporaryFile sample("BenchmarkSample.prt");
+	MakeSampleArtFile().Write(sample.filename);
+	const auto fileSize = static_cast<std::size_t>(XFile::GetFileSize(sample.filename));
+
+	// A buffer size of 1 reads the file once per field
+	for (std::size_t bufferSize : { std::size_t(1), Stream::FileReader::DefaultBufferSize }) {
+		auto seconds = Benchmark::Time([&] {
+			auto artFile = ArtFile::Read(Stream::FileReader(sample.filename, bufferSize));
+			Benchmark::DoNotOptimize(&artFile);
+		});
+		Benchmark::Report("ArtFile::Read (FileReader buffer size: " + std::to_string(bufferSize) + ")", seconds, fileSize);
+	}
+
+	// Archive entries are read through a shared file handle, one positional read per unbuffered call
+	const auto fileHandle = std::make_shared<const Stream::FileHandle>(sample.filename);
+	auto seconds = Benchmark::Time([&] {
+		auto artFile = ArtFile::Read(Stream::FileHandleReader(fileHandle));
+		Benchmark::DoNotOptimize(&artFile);
+	});
+	Benchmark::Report("ArtFile::Read (FileHandleReader)", seconds, fileSize);
+
+	seconds = Benchmark::Time([&] {
+		auto artFile = ArtFile::Read(Stream::BufferedReader<Stream::FileHandleReader>(Stream::FileHandleReader(fileHandle)));
+		Benchmark::DoNotOptimize(&artFile);
+	});
+	Benchmark::Report("ArtFile::Read (BufferedReader<FileHandleReader>)", seconds, fileSize);
+
+	std::vector<uint8_t> contents(fileSize);
+	Stream::FileReader(sample.filename).Read(contents);
+	seconds = Benchmark::Time([&] {
+		auto artFile = ArtFile::Read(Stream::MemoryReader(contents.data(), contents.size()));
+		Benchmark::DoNotOptimize(&artFile);
+	});
+	Benchmark::Report("ArtFile::Read (MemoryReader)", seconds, fileSize);
+}
+
+BENCHMARK(ArtFileWrite)
+{
+	const auto artFile = MakeSampleArtFile();
+	const std::string filename("BenchmarkWrite.prt");
+
+	// A buffer size of 1 passes each field straight to the file stream
+	for (std::size_t bufferSize : { std::size_t(1), Stream::FileWriter::DefaultBufferSize }) {
+		auto seconds = Benchmark::Time([&] {
+			Stream::FileWriter writer(filename, Stream::FileWriter::OpenMode::Default, bufferSize);
+			artFile.Write(writer);
+		});
+		const auto fileSize = static_cast<std::size_t>(XFile::GetFileSize(filename));
+		Benchmark::Report("ArtFile::Write (FileWriter buffer size: " + std::to_string(bufferSize) + ")", seconds, fileSize);
+	}
+
+	XFile::DeletePath(filename);
+}
@@ -0,0 +1,40 @@
+#include "../Benchmark.h"
+#include "Stream/FileReader.h"
+#include "Stream/FileWriter.h"
+#include "Stream/SliceReader.h"
+#include "XFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace OP2Utility;
+
+BENCHMARK(FileReaderSlice)
+{
+	const std::string filename("BenchmarkSlices.bin");
+	Stream::FileWriter(filename).Write(std::vector<uint8_t>(1024 * 1024, 0x5A));
+
+	// Small slices, as handed out for sprite pixel data and loose resources
+	const std::size_t sliceCount = 1000;
+	const std::size_t sliceLength = 600;
+	Stream::FileReader reader(filename);
+	std::vector<uint8_t> buffer(sliceLength);
+
+	auto seconds = Benchmark::Time([&] {
+		for (std::size_t i = 0; i < sliceCount; ++i) {
+			auto slice = reader.Slice(i * sliceLength, sliceLength);
+			Benchmark::DoNotOptimize(&slice);
+		}
+	});
+	Benchmark::ReportRate("FileReader::Slice", seconds, sliceCount, "slices");
+
+	seconds = Benchmark::Time([&] {
+		for (std::size_t i = 0; i < sliceCount; ++i) {
+			auto slice = reader.Slice(i * sliceLength, sliceLength);
+			slice.Read(buffer);
+		}
+	});
+	Benchmark::Report("FileReader::Slice and Read", seconds, sliceCount * sliceLength);
+
+	XFile::DeletePath(filename);
+}
@@ -16,6 +16,8 @@
 */
 
 #include "../src/Archive/ArchiveFile.h"
+#include "../src/Archive/ArchiveManifest.h"
+#include "../src/Archive/ArchiveIndexCache.h"
 #include "../src/Archive/ClmFile.h"
 #include "../src/Archive/VolFile.h"
 
@@ -28,6 +30,7 @@
 
 #include "../src/Stream/FileReader.h"
 #include "../src/Stream/SliceReader.h"
+#include "../src/Stream/BufferedReader.h"
 #include "../src/Stream/FileWriter.h"
 #include "../src/Stream/MemoryReader.h"
 #include "../src/Stream/MemoryWriter.h"
@@ -1,5 +1,6 @@
 #include "AdaptiveHuffmanTree.h"
 #include <utility>
+#include <algorithm>
 #include <string>
 #include <stdexcept>
 
@@ -14,7 +15,8 @@ namespace OP2Utility::Archive
 		// Allocate space for tree
 		linkOrData(nodeCount),
 		subtreeCount(nodeCount),
-		parentIndex(nodeCount + terminalNodeCount)
+		parentIndex(nodeCount + terminalNodeCount),
+		prefixBitCount(0)
 	{
 		// Initialize the tree
 		// Initialize terminal nodes
@@ -167,6 +169,78 @@ namespace OP2Utility::Archive
 
 		// Swap Data values (link to children or code value)
 		std::swap(linkOrData[nodeIndex1], linkOrData[nodeIndex2]);
+
+		// Paths passing through either node now lead to different subtrees
+		if (prefixBitCount > 0 && nodeIndex1 != nodeIndex2) {
+			UpdatePrefixTable(nodeIndex1);
+			UpdatePrefixTable(nodeIndex2);
+		}
+	}
+
+
+
+	// Builds (or with a bit count of 0, discards) the prefix lookup table
+	void AdaptiveHuffmanTree::SetPrefixTableBitCount(unsigned int prefixBitCount)
+	{
+		if (prefixBitCount > 16) {
+			throw std::runtime_error("AdaptiveHuffmanTree prefix table bit count of " + std::to_string(prefixBitCount)
+				+ " is larger than the maximum of 16");
+		}
+
+		this->prefixBitCount = prefixBitCount;
+		prefixTable.clear();
+
+		if (prefixBitCount > 0) {
+			prefixTable.resize(std::size_t(1) << prefixBitCount);
+			FillPrefixTable(rootNodeIndex, 0, 0);
+		}
+	}
+
+	unsigned int AdaptiveHuffmanTree::PrefixTableBitCount() const
+	{
+		return prefixBitCount;
+	}
+
+	AdaptiveHuffmanTree::PrefixEntry AdaptiveHuffmanTree::LookupPrefix(unsigned int prefixBits) const
+	{
+		return prefixTable[prefixBits];
+	}
+
+	// Refills the table entries for all paths passing through the given node
+	void AdaptiveHuffmanTree::UpdatePrefixTable(NodeIndex nodeIndex)
+	{
+		// Find the path from the root to the node
+		// Note: The path is collected from the node upward, so the last branch lands in the LSB
+		unsigned int depth = 0;
+		unsigned int prefix = 0;
+		for (NodeIndex curNodeIndex = nodeIndex; curNodeIndex != rootNodeIndex; curNodeIndex = parentIndex[curNodeIndex])
+		{
+			// Links beyond the table depth do not affect the table
+			if (++depth >= prefixBitCount) {
+				return;
+			}
+			// Right children have odd indexes
+			prefix |= (curNodeIndex & 1u) << (depth - 1);
+		}
+
+		FillPrefixTable(nodeIndex, prefix, depth);
+	}
+
+	// Fills all table entries starting with the given prefix, which leads from the root to nodeIndex
+	void AdaptiveHuffmanTree::FillPrefixTable(NodeIndex nodeIndex, unsigned int prefix, unsigned int depth)
+	{
+		if (depth < prefixBitCount && linkOrData[nodeIndex] < nodeCount)
+		{
+			const auto leftChild = linkOrData[nodeIndex];
+			FillPrefixTable(leftChild, prefix << 1, depth + 1);
+			FillPrefixTable(leftChild + 1, (prefix << 1) | 1, depth + 1);
+			return;
+		}
+
+		// All entries sharing this prefix resolve to the same node
+		const unsigned int remainingBits = prefixBitCount - depth;
+		const PrefixEntry entry{ nodeIndex, static_cast<unsigned short>(depth) };
+		std::fill_n(prefixTable.begin() + (std::size_t(prefix) << remainingBits), std::size_t(1) << remainingBits, entry);
 	}
 
 
@@ -174,17 +248,17 @@ namespace OP2Utility::Archive
 	// Used during compression to get the bitstring to emit for a given code.
 	// Returns the bitstring for a given code
 	// Places the length of the bitstring in the bitCount out parameter
-	// NOTE: Bit order subject to change (and likely will change). Currently:
+	// Bit order:
 	// The branch to take between the root and a child of the root is placed in the LSB
 	// Subsequent branches are stored in higher bits
 	unsigned int AdaptiveHuffmanTree::GetEncodedBitString(NodeData code, unsigned int& bitCount)
 	{
 		VerifyNodeDataInBounds(code);
 
-		// Record the path to the root
+		// Record the path to the root, starting from the node which currently holds the code
 		bitCount = 0;
 		unsigned int bitString = 0;
-		NodeIndex curNodeIndex = code;
+		NodeIndex curNodeIndex = parentIndex[code + nodeCount];
 		while (curNodeIndex != rootNodeIndex)
 		{
 			unsigned int bBit = curNodeIndex & 1;  // Get the direction from parent to current node
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <vector>
 
 namespace OP2Utility::Archive
@@ -28,16 +30,31 @@ namespace OP2Utility::Archive
 		// Tree restructuring routines
 		void UpdateCodeCount(NodeData code);		// Perform tree update/restructure
 
+		// Prefix table decompression routines
+		// The prefix table maps the next prefixBitCount bits of input directly to the node reached by
+		// following them from the root (stopping early at a terminal node), resolving several bits per lookup.
+		// The table is patched as the tree is restructured. A prefixBitCount of 0 disables the table.
+		struct PrefixEntry {
+			NodeIndex nodeIndex;	// Node reached after following bitCount bits from the root
+			unsigned short bitCount;	// Number of bits consumed (less than prefixBitCount if a terminal node was reached)
+		};
+		void SetPrefixTableBitCount(unsigned int prefixBitCount);
+		unsigned int PrefixTableBitCount() const;
+		// prefixBits holds the next prefixBitCount bits, with the first bit in the most significant position
+		PrefixEntry LookupPrefix(unsigned int prefixBits) const;
+
 		// Compression routines
-		// NOTE: experimental, API likely to change
 		// Retuns the path from the root node to the node with the given code
 		// Places the path length in bitCount
+		// The branch taken from the root is placed in the LSB, so bits are emitted LSB first
 		unsigned int GetEncodedBitString(NodeData code, unsigned int &bitCount);
 
 	private:
 		void VerifyNodeIndexInBounds(NodeIndex nodeIndex);
 		void VerifyNodeDataInBounds(NodeData code);
 		void SwapNodes(NodeIndex nodeIndex1, NodeIndex nodeIndex2);
+		void UpdatePrefixTable(NodeIndex nodeIndex);
+		void FillPrefixTable(NodeIndex nodeIndex, unsigned int prefix, unsigned int depth);
 
 		// Tree properties
 		NodeType terminalNodeCount;
@@ -51,6 +68,8 @@ namespace OP2Utility::Archive
 		std::vector<NodeType> subtreeCount; // number of occurances of code or codes in subtrees
 		std::vector<NodeType> parentIndex; // index of the parent node to (current node or data)
 							//  Note: This is also used to translate: code -> node_index
+		unsigned int prefixBitCount;
+		std::vector<PrefixEntry> prefixTable; // Indexed by the next prefixBitCount bits of input
 	};
 
 
@@ -83,6 +102,11 @@ namespace OP2Utility::Archive
 	//  (up to nodeCount + terminalNodeCount) are used to find the node which contains
 	//  a given code. i.e. the "parent" of the code.
 
+	// Note: The prefix table only depends on the links of nodes less than prefixBitCount deep.
+	//  Updating counts does not change links, and SwapNodes exchanges the links held by two
+	//  nodes without moving any node. So after a swap, only the table entries for paths passing
+	//  through the two swapped nodes need to be refilled.
+
 	// Note: Parents are always to the "right" of their children. Also every node except
 	//  the root has a sibling. Nodes with a higher count value are always found further
 	//  to the right in the tree. Thus the tree maintains the Sibling Property.
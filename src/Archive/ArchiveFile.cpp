@@ -1,18 +1,72 @@
 #include "ArchiveFile.h"
+#include "DecompressedEntryCache.h"
+#include "ArchiveIndexCache.h"
 #include "../XFile.h"
 #include "../StringUtility.h"
+#include "../ParallelFor.h"
 #include "../Stream/BidirectionalReader.h"
 #include "../Stream/FileWriter.h"
+#include "../Stream/MemoryReader.h"
+#include "../Stream/DynamicMemoryWriter.h"
+#include "../Stream/FileHandle.h"
+#include "../Stream/FileHandleReader.h"
+#include "../Stream/BufferedReader.h"
+#include "../Stream/MemoryMappedFile.h"
+#include "../Stream/SharedMemoryReader.h"
 #include <array>
 #include <string>
 #include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <utility>
 
 namespace OP2Utility::Archive
 {
-	ArchiveFile::ArchiveFile(const std::string& filename) :
-		m_ArchiveFilename(filename), m_Count(0), m_ArchiveFileSize(0) { }
+	namespace {
+		// Packed file names are compared as XFile::PathsAreEqual does: case insensitive, with "./NAME" equal to "NAME"
+		std::string NameIndexKey(const std::string& name)
+		{
+			auto key = StringUtility::ConvertToUpper(name);
+			if (key.compare(0, 2, "./") == 0) {
+				key.erase(0, 2);
+			}
+			return key;
+		}
 
-	ArchiveFile::~ArchiveFile() { }
+		// FNV-1a. Stored in the index cache, so it must not vary between builds, unlike std::hash.
+		uint32_t NameIndexKeyHash(std::string_view key)
+		{
+			uint32_t hash = 2166136261u;
+			for (const auto c : key) {
+				hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+			}
+			return hash;
+		}
+
+		bool ContainsPathSeparator(const std::string& name)
+		{
+			return name.find_first_of("/\\") != std::string::npos;
+		}
+	}
+
+	ArchiveFile::ArchiveFile(const std::string& filename, ArchiveBackend backend) :
+		m_ArchiveFilename(filename), m_Count(0), m_ArchiveFileSize(0)
+	{
+		if (backend == ArchiveBackend::MemoryMapped) {
+			m_MappedFile = std::make_shared<const Stream::MemoryMappedFile>(filename);
+			m_ArchiveFileSize = m_MappedFile->Size();
+		}
+		else {
+			m_FileHandle = std::make_shared<const Stream::FileHandle>(filename);
+			m_ArchiveFileSize = m_FileHandle->Size();
+		}
+	}
+
+	ArchiveFile::~ArchiveFile()
+	{
+		// Another archive may later be created at the same address
+		SetDecompressedEntryCache(nullptr);
+	}
 
 	void ArchiveFile::ExtractAllFiles(const std::string& destDirectory)
 	{
@@ -22,28 +76,150 @@ namespace OP2Utility::Archive
 		}
 	}
 
-	std::size_t ArchiveFile::GetIndex(const std::string& name)
+	// Note: ExtractFile must be safe to call concurrently for different indexes
+	std::vector<ArchiveFile::ExtractionResult> ArchiveFile::ExtractAllFiles(const std::string& destDirectory, std::size_t threadCount)
 	{
-		for (std::size_t i = 0; i < GetCount(); ++i)
-		{
-			if (XFile::PathsAreEqual(GetName(i), name)) {
-				return i;
-			}
+		std::vector<ExtractionResult> results(GetCount());
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			results[i] = ExtractionResult{ i, XFile::Append(destDirectory, GetName(i)), false, "" };
 		}
 
-		throw std::runtime_error("Archive " + m_ArchiveFilename + " does not contain " + name);
+		// Start the largest files first, so a large file started last does not leave other threads idle
+		std::vector<std::size_t> extractionOrder(results.size());
+		std::iota(extractionOrder.begin(), extractionOrder.end(), std::size_t(0));
+		std::stable_sort(extractionOrder.begin(), extractionOrder.end(), [this](std::size_t index1, std::size_t index2) {
+			return GetSize(index1) > GetSize(index2);
+		});
+
+		ParallelFor(extractionOrder.size(), threadCount, [&](std::size_t orderIndex) {
+			auto& result = results[extractionOrder[orderIndex]];
+			try {
+				ExtractFile(result.index, result.pathOut);
+				result.succeeded = true;
+			}
+			catch (const std::exception& e) {
+				result.errorMessage = e.what();
+			}
+		});
+
+		return results;
 	}
 
-	bool ArchiveFile::Contains(const std::string& name)
+	void ArchiveFile::ExtractFiles(const std::vector<std::size_t>& indexes, const ExtractionSink& sink, std::size_t readBufferSize)
 	{
-		for (std::size_t i = 0; i < GetCount(); ++i)
+		for (const auto index : indexes) {
+			VerifyIndexInBounds(index);
+		}
+
+		std::vector<std::size_t> extractionOrder(indexes);
+		std::stable_sort(extractionOrder.begin(), extractionOrder.end(), [this](std::size_t index1, std::size_t index2) {
+			return GetPackedDataOffset(index1) < GetPackedDataOffset(index2);
+		});
+
+		// Stored data of a packed file ends by the start of the next, so bound each packed file by the next offset
+		std::vector<uint64_t> packedDataOffsets;
+		for (std::size_t i = 0; i < GetCount(); ++i) {
+			packedDataOffsets.push_back(GetPackedDataOffset(i));
+		}
+		std::sort(packedDataOffsets.begin(), packedDataOffsets.end());
+		auto getPackedDataEnd = [&](std::size_t index) {
+			auto next = std::upper_bound(packedDataOffsets.begin(), packedDataOffsets.end(), GetPackedDataOffset(index));
+			return (next == packedDataOffsets.end()) ? m_ArchiveFileSize : std::min(*next, m_ArchiveFileSize);
+		};
+
+		std::vector<uint8_t> readBuffer;
+		uint64_t bufferOffset = 0;
+		uint64_t bufferEnd = 0;
+
+		for (std::size_t orderIndex = 0; orderIndex < extractionOrder.size(); ++orderIndex)
 		{
-			if (XFile::PathsAreEqual(GetName(i), name)) {
-				return true;
+			const auto index = extractionOrder[orderIndex];
+			try {
+				const auto offset = std::min(GetPackedDataOffset(index), m_ArchiveFileSize);
+				const auto end = getPackedDataEnd(index);
+
+				std::unique_ptr<Stream::BidirectionalReader> contents;
+				if (m_MappedFile) {
+					contents = OpenPackedStream(index, static_cast<const uint8_t*>(GetMappedData(offset, end - offset)), static_cast<std::size_t>(end - offset));
+				}
+				else if (end - offset <= readBufferSize) {
+					if (offset < bufferOffset || end > bufferEnd) {
+						// Read ahead through the following packed files which fit in the buffer
+						bufferOffset = offset;
+						bufferEnd = end;
+						for (auto next = orderIndex + 1; next < extractionOrder.size(); ++next) {
+							const auto nextEnd = getPackedDataEnd(extractionOrder[next]);
+							if (nextEnd - bufferOffset > readBufferSize) {
+								break;
+							}
+							bufferEnd = std::max(bufferEnd, nextEnd);
+						}
+
+						readBuffer.resize(static_cast<std::size_t>(bufferEnd - bufferOffset));
+						m_FileHandle->ReadExactAt(bufferOffset, readBuffer.data(), readBuffer.size());
+					}
+
+					contents = OpenPackedStream(index, &readBuffer[static_cast<std::size_t>(offset - bufferOffset)], static_cast<std::size_t>(end - offset));
+				}
+
+				// Stored data was too large to buffer, or extends past the next packed file
+				if (!contents) {
+					contents = OpenStream(index);
+				}
+
+				sink(index, *contents);
+			}
+			catch (const std::exception& e) {
+				throw std::runtime_error("Unable to extract " + GetName(index) + " from archive " + m_ArchiveFilename + ". " + e.what());
 			}
 		}
+	}
 
-		return false;
+	void ArchiveFile::ExtractFiles(const std::vector<std::string>& names, const ExtractionSink& sink, std::size_t readBufferSize)
+	{
+		std::vector<std::size_t> indexes;
+		for (const auto& name : names) {
+			indexes.push_back(GetIndex(name));
+		}
+
+		ExtractFiles(indexes, sink, readBufferSize);
+	}
+
+	void ArchiveFile::ExtractFiles(const std::vector<std::size_t>& indexes, const std::string& destDirectory)
+	{
+		ExtractFiles(indexes, [this, &destDirectory](std::size_t index, Stream::BidirectionalReader& contents) {
+			WriteExtractedFile(index, contents, XFile::Append(destDirectory, GetName(index)));
+		});
+	}
+
+	void ArchiveFile::ExtractFiles(const std::vector<std::string>& names, const std::string& destDirectory)
+	{
+		ExtractFiles(names, [this, &destDirectory](std::size_t index, Stream::BidirectionalReader& contents) {
+			WriteExtractedFile(index, contents, XFile::Append(destDirectory, GetName(index)));
+		});
+	}
+
+	void ArchiveFile::WriteExtractedFile(std::size_t, Stream::BidirectionalReader& contents, const std::string& pathOut)
+	{
+		Stream::FileWriter fileWriter(pathOut);
+		fileWriter.Write(contents);
+		fileWriter.Flush();
+	}
+
+	std::size_t ArchiveFile::GetIndex(const std::string& name)
+	{
+		std::size_t index;
+		if (FindIndex(name, index)) {
+			return index;
+		}
+
+		throw std::runtime_error("Archive " + m_ArchiveFilename + " does not contain " + name);
+	}
+
+	bool ArchiveFile::Contains(const std::string& name)
+	{
+		std::size_t index;
+		return FindIndex(name, index);
 	}
 
 	void ArchiveFile::ExtractFile(const std::string& name, const std::string& pathOut)
@@ -56,6 +232,237 @@ namespace OP2Utility::Archive
 		return OpenStream(GetIndex(name));
 	}
 
+	// Packed files are stored as is, unless an archive format compresses them
+	std::unique_ptr<Stream::BidirectionalReader> ArchiveFile::OpenStoredStream(std::size_t index)
+	{
+		return OpenStream(index);
+	}
+
+	bool ArchiveFile::IsCompressed(std::size_t index)
+	{
+		VerifyIndexInBounds(index);
+
+		return false;
+	}
+
+	bool ArchiveFile::CanDecompress(std::size_t index)
+	{
+		VerifyIndexInBounds(index);
+
+		return true;
+	}
+
+	std::unique_ptr<Stream::BidirectionalReader> ArchiveFile::OpenDecompressedStream(std::size_t, std::unique_ptr<Stream::BidirectionalReader> storedStream)
+	{
+		return storedStream;
+	}
+
+	std::vector<uint8_t> ArchiveFile::ReadFile(std::size_t index)
+	{
+		std::vector<uint8_t> buffer(GetSize(index));
+		ReadFile(index, buffer.data(), buffer.size());
+		return buffer;
+	}
+
+	std::vector<uint8_t> ArchiveFile::ReadFile(const std::string& name)
+	{
+		return ReadFile(GetIndex(name));
+	}
+
+	void ArchiveFile::ReadFile(std::size_t index, void* buffer, std::size_t bufferSize)
+	{
+		const auto fileSize = GetSize(index);
+		VerifyBufferHoldsFile(index, bufferSize);
+
+		OpenStream(index)->Read(buffer, fileSize);
+	}
+
+	ArchiveFile::FileView ArchiveFile::GetFileView(std::size_t index)
+	{
+		throw std::runtime_error("Archive " + m_ArchiveFilename + " can not provide an in place view of " + GetName(index) +
+			". Views are only available for uncompressed files in memory mapped archives.");
+	}
+
+	const void* ArchiveFile::GetMappedData(uint64_t offset, uint64_t length) const
+	{
+		if (!m_MappedFile) {
+			throw std::runtime_error("Archive " + m_ArchiveFilename + " is not memory mapped");
+		}
+		if (offset > m_MappedFile->Size() || length > m_MappedFile->Size() - offset) {
+			throw std::runtime_error("Range at offset " + std::to_string(offset) + " of length " + std::to_string(length) +
+				" extends past the end of archive " + m_ArchiveFilename);
+		}
+
+		return static_cast<const char*>(m_MappedFile->Data()) + offset;
+	}
+
+	std::unique_ptr<Stream::SharedMemoryReader> ArchiveFile::OpenMappedReader(uint64_t offset, uint64_t length) const
+	{
+		const void* data = GetMappedData(offset, length);
+		return std::make_unique<Stream::SharedMemoryReader>(m_MappedFile, data, static_cast<std::size_t>(length));
+	}
+
+	std::unique_ptr<Stream::BidirectionalReader> ArchiveFile::OpenArchiveReader(uint64_t offset, uint64_t length) const
+	{
+		if (m_MappedFile) {
+			return OpenMappedReader(offset, length);
+		}
+
+		// Each reader keeps its own position and reads the shared file handle positionally.
+		// Headers and packed files are usually parsed a few bytes at a time, so batch reads of the file handle.
+		return std::make_unique<Stream::BufferedReader<Stream::FileHandleReader>>(Stream::FileHandleReader(m_FileHandle, offset, length));
+	}
+
+	void ArchiveFile::VerifyBufferHoldsFile(std::size_t index, std::size_t bufferSize)
+	{
+		if (bufferSize < GetSize(index)) {
+			throw std::runtime_error("Buffer of size " + std::to_string(bufferSize) + " is too small to hold " +
+				GetName(index) + " of size " + std::to_string(GetSize(index)) + " from archive " + m_ArchiveFilename + ".");
+		}
+	}
+
+	void ArchiveFile::SetDecompressedEntryCache(std::shared_ptr<DecompressedEntryCache> cache)
+	{
+		if (m_DecompressedEntryCache) {
+			m_DecompressedEntryCache->Remove(*this);
+		}
+
+		m_DecompressedEntryCache = std::move(cache);
+	}
+
+	void ArchiveFile::BuildNameIndex()
+	{
+		m_NameIndexKeys.clear();
+		m_NameIndex.clear();
+		m_NameIndex.reserve(m_Count);
+
+		// At most half full, so probe sequences stay short
+		std::size_t bucketCount = 1;
+		while (bucketCount < 2 * m_Count) {
+			bucketCount *= 2;
+		}
+		m_NameIndexBuckets.assign(bucketCount, 0);
+
+		for (std::size_t i = 0; i < m_Count; ++i) {
+			const auto key = NameIndexKey(GetName(i));
+			const auto keyHash = NameIndexKeyHash(key);
+			m_NameIndex.push_back(NameIndexEntry{ keyHash, static_cast<uint32_t>(m_NameIndexKeys.size()), static_cast<uint32_t>(key.size()) });
+			m_NameIndexKeys += key;
+
+			// Later duplicates are not indexed, so lookups find the first, matching a front to back search
+			auto& bucket = m_NameIndexBuckets[FindNameIndexBucket(key, keyHash)];
+			if (bucket == 0) {
+				bucket = static_cast<uint32_t>(i + 1);
+			}
+		}
+	}
+
+	std::string_view ArchiveFile::GetNameIndexKey(std::size_t index) const
+	{
+		const auto& entry = m_NameIndex[index];
+		return std::string_view(m_NameIndexKeys).substr(entry.keyOffset, entry.keyLength);
+	}
+
+	// Linear probing. Returns the bucket holding key, or the empty bucket where it belongs.
+	std::size_t ArchiveFile::FindNameIndexBucket(std::string_view key, uint32_t keyHash) const
+	{
+		const auto bucketMask = m_NameIndexBuckets.size() - 1;
+		for (auto bucket = keyHash & bucketMask; ; bucket = (bucket + 1) & bucketMask) {
+			const auto entryNumber = m_NameIndexBuckets[bucket];
+			if (entryNumber == 0 ||
+				(m_NameIndex[entryNumber - 1].keyHash == keyHash && GetNameIndexKey(entryNumber - 1) == key))
+			{
+				return bucket;
+			}
+		}
+	}
+
+	bool ArchiveFile::ReadCachedIndex(const ArchiveIndexCache* indexCache)
+	{
+		const auto index = indexCache ? indexCache->Find(m_ArchiveFilename) : nullptr;
+		if (!index) {
+			return false;
+		}
+
+		try {
+			Stream::MemoryReader indexReader(index->data(), index->size());
+			ReadIndex(indexReader);
+			ReadNameIndex(indexReader);
+			return true;
+		}
+		catch (const std::exception&) {
+			// Parsing the archive replaces the unusable cached index
+			return false;
+		}
+	}
+
+	void ArchiveFile::StoreCachedIndex(ArchiveIndexCache* indexCache)
+	{
+		if (!indexCache) {
+			return;
+		}
+
+		Stream::DynamicMemoryWriter indexWriter;
+		WriteIndex(indexWriter);
+		indexWriter.Write<uint32_t>(m_NameIndexKeys);
+		indexWriter.Write<uint32_t>(m_NameIndex);
+		indexWriter.Write<uint32_t>(m_NameIndexBuckets);
+
+		auto indexReader = indexWriter.GetReader();
+		std::vector<uint8_t> index(static_cast<std::size_t>(indexReader.Length()));
+		indexReader.Read(index);
+		indexCache->Store(m_ArchiveFilename, std::move(index));
+	}
+
+	// Reads a name index written by StoreCachedIndex, saving the cost of building it again
+	void ArchiveFile::ReadNameIndex(Stream::Reader& reader)
+	{
+		reader.Read<uint32_t>(m_NameIndexKeys);
+		reader.Read<uint32_t>(m_NameIndex);
+		reader.Read<uint32_t>(m_NameIndexBuckets);
+
+		const auto bucketCount = m_NameIndexBuckets.size();
+		bool isValid = m_NameIndex.size() == m_Count &&
+			bucketCount >= std::max<std::size_t>(2 * m_Count, 1) && (bucketCount & (bucketCount - 1)) == 0;
+		for (std::size_t i = 0; isValid && i < m_NameIndex.size(); ++i) {
+			const auto& entry = m_NameIndex[i];
+			isValid = entry.keyOffset <= m_NameIndexKeys.size() && entry.keyLength <= m_NameIndexKeys.size() - entry.keyOffset &&
+				entry.keyHash == NameIndexKeyHash(GetNameIndexKey(i));
+		}
+		// At most m_Count buckets are used, so empty buckets remain to end probe sequences
+		isValid = isValid && std::all_of(m_NameIndexBuckets.begin(), m_NameIndexBuckets.end(), [this](uint32_t entryNumber) {
+			return entryNumber <= m_Count;
+		}) && static_cast<std::size_t>(std::count(m_NameIndexBuckets.begin(), m_NameIndexBuckets.end(), 0u)) >= bucketCount - m_Count;
+
+		if (!isValid) {
+			throw std::runtime_error("Cached name index of " + m_ArchiveFilename + " does not match its packed files");
+		}
+	}
+
+	bool ArchiveFile::FindIndex(const std::string& name, std::size_t& indexOut)
+	{
+		const auto key = NameIndexKey(name);
+
+		// Names with directory components need full path comparison, so search those the slow way
+		if (ContainsPathSeparator(key)) {
+			for (std::size_t i = 0; i < GetCount(); ++i) {
+				if (XFile::PathsAreEqual(GetName(i), name)) {
+					indexOut = i;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		const auto entryNumber = m_NameIndexBuckets[FindNameIndexBucket(key, NameIndexKeyHash(key))];
+		if (entryNumber == 0) {
+			return false;
+		}
+
+		indexOut = entryNumber - 1;
+		return true;
+	}
+
 	void ArchiveFile::VerifyIndexInBounds(std::size_t index)
 	{
 		if (index >= m_Count) {
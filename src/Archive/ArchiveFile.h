@@ -2,22 +2,64 @@
 
 #include "../Stream/BidirectionalReader.h"
 #include <string>
+#include <vector>
 #include <memory>
+#include <functional>
+#include <string_view>
 #include <cstdint>
 #include <cstddef>
 
+namespace OP2Utility::Stream
+{
+	class Reader;
+	class Writer;
+	class FileHandle;
+	class MemoryMappedFile;
+	class SharedMemoryReader;
+}
+
 namespace OP2Utility::Archive
 {
+	class DecompressedEntryCache;
+	class ArchiveIndexCache;
+
+	// How an archive's contents are accessed
+	enum class ArchiveBackend
+	{
+		FileStream,		// Read through positional file reads, safe to share across threads
+		MemoryMapped	// Map the whole archive into memory, and read packed files in place
+	};
+
 	class ArchiveFile
 	{
 	public:
-		ArchiveFile(const std::string& filename);
+		// Read-only view of a packed file's bytes in place within a memory mapped archive.
+		// Valid while the archive is open.
+		struct FileView
+		{
+			const void* data;
+			std::size_t size;
+		};
+
+		// Outcome of extracting a single packed file
+		struct ExtractionResult
+		{
+			std::size_t index;
+			std::string pathOut;
+			bool succeeded;
+			std::string errorMessage; // Reason for failure, if extraction did not succeed
+		};
+
+		ArchiveFile(const std::string& filename, ArchiveBackend backend = ArchiveBackend::FileStream);
 		virtual ~ArchiveFile();
 
 		std::string GetArchiveFilename() const { return m_ArchiveFilename; }
 		uint64_t GetArchiveFileSize() const { return m_ArchiveFileSize; }
 		std::size_t GetCount() const { return m_Count; }
+		bool IsMemoryMapped() const { return m_MappedFile != nullptr; }
 		bool Contains(const std::string& name);
+		// Looks up a packed file by name, case insensitive. Returns false if not found.
+		bool FindIndex(const std::string& name, std::size_t& indexOut);
 		void ExtractFile(const std::string& name, const std::string& pathOut);
 
 		virtual std::size_t GetIndex(const std::string& name);
@@ -25,11 +67,87 @@ namespace OP2Utility::Archive
 		virtual uint32_t GetSize(std::size_t index) = 0;
 		virtual void ExtractFile(std::size_t index, const std::string& pathOut) = 0;
 		virtual void ExtractAllFiles(const std::string& destDirectory);
+		// Receives the (decompressed) contents of each packed file during batch extraction.
+		// contents is only valid during the call.
+		using ExtractionSink = std::function<void(std::size_t index, Stream::BidirectionalReader& contents)>;
+
+		// Extracts many packed files in one forward pass over the archive, in the order their data is stored
+		// rather than the order given, and passes each to sink. Packed files stored near each other are read
+		// together, with reads of up to readBufferSize bytes. Larger packed files are streamed on their own.
+		// Throws on the first failure.
+		void ExtractFiles(const std::vector<std::size_t>& indexes, const ExtractionSink& sink, std::size_t readBufferSize = DefaultBatchReadSize);
+		void ExtractFiles(const std::vector<std::string>& names, const ExtractionSink& sink, std::size_t readBufferSize = DefaultBatchReadSize);
+		// Writes each packed file to destDirectory, as ExtractFile would
+		void ExtractFiles(const std::vector<std::size_t>& indexes, const std::string& destDirectory);
+		void ExtractFiles(const std::vector<std::string>& names, const std::string& destDirectory);
+
+		// Extracts files concurrently on threadCount threads (0 for one per hardware thread).
+		// A failure to extract one file does not stop extraction of the others.
+		// Returns the outcome for each file, in index order.
+		std::vector<ExtractionResult> ExtractAllFiles(const std::string& destDirectory, std::size_t threadCount);
 		virtual std::unique_ptr<Stream::BidirectionalReader> OpenStream(std::size_t index) = 0;
 		virtual std::unique_ptr<Stream::BidirectionalReader> OpenStream(const std::string& name);
+		// Opens a stream of a packed file's data as stored in the archive, before any decompression
+		virtual std::unique_ptr<Stream::BidirectionalReader> OpenStoredStream(std::size_t index);
+		// Whether a packed file's stored data differs from its contents.
+		// If not, OpenStoredStream and OpenStream read the same bytes.
+		virtual bool IsCompressed(std::size_t index);
+		// Whether OpenDecompressedStream supports a packed file's compression
+		virtual bool CanDecompress(std::size_t index);
+		// Opens a stream which decompresses storedStream, a stream of the packed file's stored data from its beginning.
+		// Does not use the decompressed entry cache. Uncompressed files return storedStream.
+		virtual std::unique_ptr<Stream::BidirectionalReader> OpenDecompressedStream(std::size_t index, std::unique_ptr<Stream::BidirectionalReader> storedStream);
+
+		// Reads the entire (decompressed) contents of a packed file
+		std::vector<uint8_t> ReadFile(std::size_t index);
+		std::vector<uint8_t> ReadFile(const std::string& name);
+		// Reads the entire (decompressed) contents of a packed file into buffer, which must hold at least GetSize(index) bytes
+		virtual void ReadFile(std::size_t index, void* buffer, std::size_t bufferSize);
+
+		// Returns the contents of an uncompressed packed file without copying
+		// Only available for memory mapped archives
+		virtual FileView GetFileView(std::size_t index);
+
+		// Compressed files are decompressed once and then served from cache, while they remain cached.
+		// One cache may be shared by many archives. Pass nullptr to stop caching.
+		void SetDecompressedEntryCache(std::shared_ptr<DecompressedEntryCache> cache);
+		std::shared_ptr<DecompressedEntryCache> GetDecompressedEntryCache() const { return m_DecompressedEntryCache; }
+
+		static constexpr std::size_t DefaultBatchReadSize = 4 * 1024 * 1024;
 
 	protected:
+		// Offset of a packed file's stored data within the archive. Batch extraction reads in this order.
+		virtual uint64_t GetPackedDataOffset(std::size_t index) = 0;
+		// Opens a stream of a packed file's contents from its stored data, already read into memory.
+		// packedData starts at GetPackedDataOffset(index), and is followed by availableLength bytes
+		// up to the next packed file or the end of the archive.
+		// Returns nullptr if the stored data extends past availableLength.
+		virtual std::unique_ptr<Stream::BidirectionalReader> OpenPackedStream(std::size_t index, const uint8_t* packedData, std::size_t availableLength) = 0;
+		// Writes a packed file's contents to pathOut, in the format ExtractFile uses
+		virtual void WriteExtractedFile(std::size_t index, Stream::BidirectionalReader& contents, const std::string& pathOut);
+
+		// Indexes packed file names for FindIndex. Call once the names are parsed. ReadCachedIndex restores the name index.
+		void BuildNameIndex();
+
+		// Serializes the parsed index (names, sizes, offsets) for ArchiveIndexCache
+		virtual void WriteIndex(Stream::Writer& writer) = 0;
+		// Restores an index written by WriteIndex, replacing all parsed index state. Throws if invalid.
+		virtual void ReadIndex(Stream::Reader& reader) = 0;
+		// Restores the index, and name index, from indexCache if it holds a copy for the archive as it is now.
+		// Returns false if the archive must be parsed instead. indexCache may be nullptr.
+		bool ReadCachedIndex(const ArchiveIndexCache* indexCache);
+		// Stores the parsed index, and name index, in indexCache, if not nullptr
+		void StoreCachedIndex(ArchiveIndexCache* indexCache);
+
 		void VerifyIndexInBounds(std::size_t index);
+		void VerifyBufferHoldsFile(std::size_t index, std::size_t bufferSize);
+
+		// Memory mapped archive access. Throws if the range is outside the archive.
+		const void* GetMappedData(uint64_t offset, uint64_t length) const;
+		// The reader keeps the archive mapped for its own lifetime
+		std::unique_ptr<Stream::SharedMemoryReader> OpenMappedReader(uint64_t offset, uint64_t length) const;
+		// Opens a range of the archive with whichever backend it uses
+		std::unique_ptr<Stream::BidirectionalReader> OpenArchiveReader(uint64_t offset, uint64_t length) const;
 
 		// Returns the filenames from each path stripping the rest of the path.
 		static std::vector<std::string> GetNamesFromPaths(const std::vector<std::string>& paths);
@@ -45,5 +163,26 @@ namespace OP2Utility::Archive
 		const std::string m_ArchiveFilename;
 		std::size_t m_Count;
 		uint64_t m_ArchiveFileSize;
+		std::shared_ptr<const Stream::FileHandle> m_FileHandle; // nullptr if memory mapped
+		std::shared_ptr<const Stream::MemoryMappedFile> m_MappedFile; // nullptr unless memory mapped
+		std::shared_ptr<DecompressedEntryCache> m_DecompressedEntryCache; // nullptr unless caching
+
+	private:
+		// A packed file's name in m_NameIndexKeys, upper case and without any leading "./"
+		struct NameIndexEntry
+		{
+			uint32_t keyHash;
+			uint32_t keyOffset;
+			uint32_t keyLength;
+		};
+
+		std::string_view GetNameIndexKey(std::size_t index) const;
+		std::size_t FindNameIndexBucket(std::string_view key, uint32_t keyHash) const;
+		void ReadNameIndex(Stream::Reader& reader);
+
+		// A hash table kept in flat arrays, so the index cache can store and restore it without rebuilding it
+		std::string m_NameIndexKeys; // Keys of all packed files, one after another
+		std::vector<NameIndexEntry> m_NameIndex; // Key of each packed file, by index
+		std::vector<uint32_t> m_NameIndexBuckets; // Packed file index + 1 by key hash, or 0 if empty. A power of 2 in size.
 	};
 }
@@ -0,0 +1,137 @@
+#include "ArchiveIndexCache.h"
+#include "ArchiveManifest.h"
+#include "../Stream/FileReader.h"
+#include "../Stream/FileWriter.h"
+#include "../Stream/MemoryReader.h"
+#include "../Stream/DynamicMemoryWriter.h"
+#include "../XFile.h"
+#include "../Tag.h"
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace OP2Utility::Archive
+{
+	namespace
+	{
+		constexpr auto TagIndexCache = MakeTag("OP2I");
+		const uint32_t IndexCacheVersion = 1;
+
+		struct IndexCacheHeader
+		{
+			Tag tag;
+			uint32_t version;
+			uint32_t payloadLength;
+			uint32_t payloadCrc32;
+		};
+	}
+
+	ArchiveIndexCache ArchiveIndexCache::Load(const std::string& filename)
+	{
+		ArchiveIndexCache cache;
+		if (!XFile::IsFile(filename)) {
+			return cache;
+		}
+
+		try {
+			Stream::FileReader reader(filename);
+
+			IndexCacheHeader header;
+			reader.Read(header);
+			if (header.tag != TagIndexCache || header.version != IndexCacheVersion ||
+				header.payloadLength != reader.Length() - reader.Position())
+			{
+				return cache;
+			}
+
+			std::vector<uint8_t> payload(header.payloadLength);
+			reader.Read(payload);
+			if (ArchiveManifest::Crc32(payload.data(), payload.size()) != header.payloadCrc32) {
+				return cache;
+			}
+
+			Stream::MemoryReader payloadReader(payload.data(), payload.size());
+			uint32_t entryCount;
+			payloadReader.Read(entryCount);
+			for (uint32_t i = 0; i < entryCount; ++i) {
+				std::string archiveFilename;
+				Entry entry;
+				payloadReader.Read<uint32_t>(archiveFilename);
+				payloadReader.Read(entry.archiveFileSize);
+				payloadReader.Read(entry.lastWriteTime);
+				payloadReader.Read<uint32_t>(entry.index);
+				cache.entries[archiveFilename] = std::move(entry);
+			}
+		}
+		catch (const std::exception&) {
+			// The cache is rebuilt as archives are opened
+			cache.entries.clear();
+		}
+
+		return cache;
+	}
+
+	void ArchiveIndexCache::Save(const std::string& filename)
+	{
+		for (auto entry = entries.begin(); entry != entries.end();) {
+			entry = IsCurrent(entry->first, entry->second) ? std::next(entry) : entries.erase(entry);
+		}
+
+		Stream::DynamicMemoryWriter payloadWriter;
+		payloadWriter.Write(static_cast<uint32_t>(entries.size()));
+		for (const auto& pair : entries) {
+			payloadWriter.Write<uint32_t>(pair.first);
+			payloadWriter.Write(pair.second.archiveFileSize);
+			payloadWriter.Write(pair.second.lastWriteTime);
+			payloadWriter.Write<uint32_t>(pair.second.index);
+		}
+
+		auto payloadReader = payloadWriter.GetReader();
+		std::vector<uint8_t> payload(static_cast<std::size_t>(payloadReader.Length()));
+		payloadReader.Read(payload);
+
+		const IndexCacheHeader header{ TagIndexCache, IndexCacheVersion, static_cast<uint32_t>(payload.size()),
+			ArchiveManifest::Crc32(payload.data(), payload.size()) };
+
+		const std::string temporaryFilename = filename + ".tmp";
+		{
+			Stream::FileWriter writer(temporaryFilename);
+			writer.Write(header);
+			writer.Write(payload);
+			writer.Flush();
+		}
+		XFile::RenameFile(temporaryFilename, filename);
+		modified = false;
+	}
+
+	const std::vector<uint8_t>* ArchiveIndexCache::Find(const std::string& archiveFilename) const
+	{
+		const auto entry = entries.find(archiveFilename);
+		if (entry == entries.end()) {
+			return nullptr;
+		}
+
+		return IsCurrent(archiveFilename, entry->second) ? &entry->second.index : nullptr;
+	}
+
+	void ArchiveIndexCache::Store(const std::string& archiveFilename, std::vector<uint8_t> index)
+	{
+		entries[archiveFilename] = Entry{ XFile::GetFileSize(archiveFilename), XFile::GetLastWriteTime(archiveFilename), std::move(index) };
+		modified = true;
+	}
+
+	bool ArchiveIndexCache::IsModified() const
+	{
+		return modified || !std::all_of(entries.begin(), entries.end(), [](const auto& pair) {
+			return IsCurrent(pair.first, pair.second);
+		});
+	}
+
+	bool ArchiveIndexCache::IsCurrent(const std::string& archiveFilename, const Entry& entry)
+	{
+		return XFile::IsFile(archiveFilename) &&
+			entry.archiveFileSize == XFile::GetFileSize(archiveFilename) &&
+			entry.lastWriteTime == XFile::GetLastWriteTime(archiveFilename);
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace OP2Utility::Archive
+{
+	// Parsed archive indexes and name indexes, saved together in one file, so archives can be reopened without parsing their headers.
+	// Entries are keyed by archive path, and are only used while the archive's size and modification time are unchanged.
+	// Not safe to use from several threads at once.
+	class ArchiveIndexCache
+	{
+	public:
+		// Returns an empty cache if the file does not exist or is not a valid cache
+		static ArchiveIndexCache Load(const std::string& filename);
+		// Replaces the file as a whole, so a partly written cache is never loaded
+		// Entries of archives which were deleted or changed since they were stored are dropped first
+		void Save(const std::string& filename);
+
+		// Returns the cached index of an archive, or nullptr if it is not cached or the archive has changed since
+		const std::vector<uint8_t>* Find(const std::string& archiveFilename) const;
+		void Store(const std::string& archiveFilename, std::vector<uint8_t> index);
+
+		std::size_t GetCount() const { return entries.size(); }
+		// True if entries were stored since the cache was loaded, or are out of date and should be dropped
+		bool IsModified() const;
+
+	private:
+		struct Entry
+		{
+			uint64_t archiveFileSize;
+			int64_t lastWriteTime;
+			std::vector<uint8_t> index;
+		};
+
+		static bool IsCurrent(const std::string& archiveFilename, const Entry& entry);
+
+		std::unordered_map<std::string, Entry> entries;
+		bool modified = false;
+	};
+}
@@ -0,0 +1,268 @@
+#include "ArchiveManifest.h"
+#include "ArchiveFile.h"
+#include "../Stream/BidirectionalReader.h"
+#include "../Stream/FileReader.h"
+#include "../Stream/FileWriter.h"
+#include "../ParallelFor.h"
+#include "../Tag.h"
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <memory>
+#include <utility>
+
+namespace OP2Utility::Archive
+{
+	namespace
+	{
+		constexpr auto TagManifest = MakeTag("OP2M");
+		const uint32_t ManifestVersion = 1;
+
+		// Reflected polynomial 0xEDB88320, processing the least significant bit first
+		const auto Crc32Table = [] {
+			std::array<uint32_t, 256> table{};
+			for (uint32_t i = 0; i < table.size(); ++i) {
+				uint32_t value = i;
+				for (int bit = 0; bit < 8; ++bit) {
+					value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : (value >> 1);
+				}
+				table[i] = value;
+			}
+			return table;
+		}();
+
+		struct VerificationTask
+		{
+			ArchiveFile* archive;
+			const ArchiveManifest::Entry* entry;
+			std::size_t index; // Index of the packed file within the archive
+			std::size_t resultIndex;
+		};
+
+		// Fills in the size and checksum of a packed file's contents, once its stored data has been checksummed.
+		// Uncompressed files reuse the stored data's checksum. Compressed files are decompressed from
+		// storedStream directly, so a decompressed entry cache is not filled with every file.
+		void ChecksumContents(ArchiveFile& archive, std::size_t index, std::unique_ptr<Stream::BidirectionalReader> storedStream, ArchiveManifest::Entry& entry)
+		{
+			entry.contentsChecksummed = archive.CanDecompress(index);
+			if (!entry.contentsChecksummed) {
+				entry.size = 0;
+				entry.crc32 = 0;
+				return;
+			}
+
+			if (!archive.IsCompressed(index)) {
+				entry.size = entry.storedSize;
+				entry.crc32 = entry.storedCrc32;
+				return;
+			}
+
+			storedStream->SeekBeginning();
+			auto stream = archive.OpenDecompressedStream(index, std::move(storedStream));
+			entry.size = stream->Length();
+			entry.crc32 = ArchiveManifest::Crc32(*stream);
+		}
+
+		void VerifyEntry(ArchiveFile& archive, std::size_t index, const ArchiveManifest::Entry& entry)
+		{
+			ArchiveManifest::Entry actual;
+
+			auto storedStream = archive.OpenStoredStream(index);
+			actual.storedSize = storedStream->Length();
+			if (actual.storedSize != entry.storedSize) {
+				throw std::runtime_error("Stored size of " + std::to_string(actual.storedSize) +
+					" bytes does not match manifest size of " + std::to_string(entry.storedSize) + " bytes");
+			}
+			actual.storedCrc32 = ArchiveManifest::Crc32(*storedStream);
+			if (actual.storedCrc32 != entry.storedCrc32) {
+				throw std::runtime_error("Stored data checksum does not match manifest");
+			}
+
+			ChecksumContents(archive, index, std::move(storedStream), actual);
+			if (actual.contentsChecksummed != entry.contentsChecksummed) {
+				throw std::runtime_error(entry.contentsChecksummed ?
+					"Contents can not be decompressed to compare with manifest" :
+					"Manifest has no contents checksum to compare with");
+			}
+			if (actual.size != entry.size) {
+				throw std::runtime_error("Size of " + std::to_string(actual.size) +
+					" bytes does not match manifest size of " + std::to_string(entry.size) + " bytes");
+			}
+			if (actual.crc32 != entry.crc32) {
+				throw std::runtime_error("Contents checksum does not match manifest");
+			}
+		}
+	}
+
+	// Note: OpenStoredStream and OpenDecompressedStream must be safe to call concurrently for different indexes
+	ArchiveManifest ArchiveManifest::Create(ArchiveFile& archive, std::size_t threadCount)
+	{
+		ArchiveManifest manifest;
+		manifest.entries.resize(archive.GetCount());
+		for (std::size_t i = 0; i < manifest.entries.size(); ++i) {
+			manifest.entries[i].name = archive.GetName(i);
+		}
+
+		ParallelFor(manifest.entries.size(), threadCount, [&](std::size_t index) {
+			auto& entry = manifest.entries[index];
+
+			auto storedStream = archive.OpenStoredStream(index);
+			entry.storedSize = storedStream->Length();
+			entry.storedCrc32 = Crc32(*storedStream);
+
+			ChecksumContents(archive, index, std::move(storedStream), entry);
+		});
+
+		return manifest;
+	}
+
+	std::string ArchiveManifest::GetManifestFilename(const std::string& archiveFilename)
+	{
+		return archiveFilename + ".manifest";
+	}
+
+	void ArchiveManifest::Save(const std::string& filename) const
+	{
+		Stream::FileWriter writer(filename);
+
+		writer.Write(TagManifest);
+		writer.Write(ManifestVersion);
+		writer.Write(static_cast<uint32_t>(entries.size()));
+
+		for (const auto& entry : entries) {
+			writer.Write<uint32_t>(entry.name);
+			writer.Write(entry.storedSize);
+			writer.Write(entry.storedCrc32);
+			writer.Write(static_cast<uint8_t>(entry.contentsChecksummed));
+			writer.Write(entry.size);
+			writer.Write(entry.crc32);
+		}
+
+		writer.Flush();
+	}
+
+	ArchiveManifest ArchiveManifest::Load(const std::string& filename)
+	{
+		Stream::FileReader reader(filename);
+
+		Tag tag;
+		reader.Read(tag);
+		if (tag != TagManifest) {
+			throw std::runtime_error("Archive manifest " + filename + " does not begin with the tag " + TagManifest);
+		}
+
+		uint32_t version;
+		reader.Read(version);
+		if (version != ManifestVersion) {
+			throw std::runtime_error("Archive manifest " + filename + " has unsupported version " + std::to_string(version));
+		}
+
+		uint32_t entryCount;
+		reader.Read(entryCount);
+
+		ArchiveManifest manifest;
+		for (uint32_t i = 0; i < entryCount; ++i) {
+			Entry entry;
+			reader.Read<uint32_t>(entry.name);
+			reader.Read(entry.storedSize);
+			reader.Read(entry.storedCrc32);
+			uint8_t contentsChecksummed;
+			reader.Read(contentsChecksummed);
+			entry.contentsChecksummed = contentsChecksummed != 0;
+			reader.Read(entry.size);
+			reader.Read(entry.crc32);
+			manifest.entries.push_back(std::move(entry));
+		}
+
+		return manifest;
+	}
+
+	std::vector<ArchiveManifest::VerificationResult> ArchiveManifest::Verify(ArchiveFile& archive, std::size_t threadCount) const
+	{
+		return Verify({ &archive }, { this }, threadCount);
+	}
+
+	std::vector<ArchiveManifest::VerificationResult> ArchiveManifest::Verify(const std::vector<ArchiveFile*>& archives,
+		const std::vector<const ArchiveManifest*>& manifests, std::size_t threadCount)
+	{
+		if (archives.size() != manifests.size()) {
+			throw std::runtime_error("Each archive to verify must have a manifest");
+		}
+
+		std::vector<VerificationResult> results;
+		std::vector<VerificationTask> tasks;
+
+		for (std::size_t archiveIndex = 0; archiveIndex < archives.size(); ++archiveIndex)
+		{
+			auto& archive = *archives[archiveIndex];
+			const auto& archiveFilename = archive.GetArchiveFilename();
+			std::vector<bool> listed(archive.GetCount(), false);
+
+			for (const auto& entry : manifests[archiveIndex]->entries) {
+				results.push_back(VerificationResult{ archiveFilename, entry.name, false, "" });
+
+				std::size_t index;
+				if (!archive.FindIndex(entry.name, index)) {
+					results.back().errorMessage = "Not found in archive";
+					continue;
+				}
+
+				listed[index] = true;
+				tasks.push_back(VerificationTask{ &archive, &entry, index, results.size() - 1 });
+			}
+
+			for (std::size_t index = 0; index < listed.size(); ++index) {
+				if (!listed[index]) {
+					results.push_back(VerificationResult{ archiveFilename, archive.GetName(index), false, "Not listed in manifest" });
+				}
+			}
+		}
+
+		// Start the largest files first, so a large file started last does not leave other threads idle
+		std::stable_sort(tasks.begin(), tasks.end(), [](const VerificationTask& task1, const VerificationTask& task2) {
+			return task1.entry->storedSize + task1.entry->size > task2.entry->storedSize + task2.entry->size;
+		});
+
+		ParallelFor(tasks.size(), threadCount, [&](std::size_t taskIndex) {
+			const auto& task = tasks[taskIndex];
+			auto& result = results[task.resultIndex];
+			try {
+				VerifyEntry(*task.archive, task.index, *task.entry);
+				result.succeeded = true;
+			}
+			catch (const std::exception& e) {
+				result.errorMessage = e.what();
+			}
+		});
+
+		return results;
+	}
+
+	uint32_t ArchiveManifest::Crc32(const void* data, std::size_t size, uint32_t crc)
+	{
+		const auto* bytes = static_cast<const uint8_t*>(data);
+
+		crc = ~crc;
+		for (std::size_t i = 0; i < size; ++i) {
+			crc = Crc32Table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+		}
+
+		return ~crc;
+	}
+
+	uint32_t ArchiveManifest::Crc32(Stream::BidirectionalReader& reader)
+	{
+		const std::size_t maxChunkSize = 64 * 1024;
+		std::vector<uint8_t> copyBuffer;
+		uint32_t crc = 0;
+
+		for (uint64_t bytesLeft = reader.Length() - reader.Position(); bytesLeft > 0; ) {
+			const auto chunkSize = static_cast<std::size_t>(std::min<uint64_t>(bytesLeft, maxChunkSize));
+			crc = Crc32(reader.Borrow(chunkSize, copyBuffer), chunkSize, crc);
+			bytesLeft -= chunkSize;
+		}
+
+		return crc;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace OP2Utility::Stream
+{
+	class BidirectionalReader;
+}
+
+namespace OP2Utility::Archive
+{
+	class ArchiveFile;
+
+	// Checksums of each packed file in an archive, for detecting corruption without extracting.
+	// Saved as a sidecar file beside the archive (see GetManifestFilename).
+	class ArchiveManifest
+	{
+	public:
+		struct Entry
+		{
+			std::string name;
+			uint64_t storedSize; // Size of the data as stored in the archive, which may be compressed
+			uint32_t storedCrc32;
+			bool contentsChecksummed; // False if the contents can not be decompressed, leaving size and crc32 0
+			uint64_t size; // Size of the (decompressed) contents
+			uint32_t crc32;
+		};
+
+		// Outcome of verifying a single packed file
+		struct VerificationResult
+		{
+			std::string archiveFilename;
+			std::string name;
+			bool succeeded;
+			std::string errorMessage; // Reason for failure, if verification did not succeed
+		};
+
+		std::vector<Entry> entries; // In archive index order
+
+		// Reads and checksums every packed file, on threadCount threads (0 for one per hardware thread).
+		// Packed files the archive can not decompress only have their stored data checksummed.
+		static ArchiveManifest Create(ArchiveFile& archive, std::size_t threadCount = 0);
+
+		// Sidecar filename used for an archive's manifest
+		static std::string GetManifestFilename(const std::string& archiveFilename);
+
+		void Save(const std::string& filename) const;
+		static ArchiveManifest Load(const std::string& filename);
+
+		// Checks each packed file of the archive against the manifest, on threadCount threads (0 for one per hardware thread).
+		// Packed files are matched by name. Files missing from either the archive or the manifest fail verification.
+		// Returns the outcome for each manifest entry, in manifest order, followed by any packed files not in the manifest.
+		std::vector<VerificationResult> Verify(ArchiveFile& archive, std::size_t threadCount = 0) const;
+
+		// Verifies many archives, each against its own manifest, sharing one pool of threads across all packed files.
+		// archives and manifests are paired by position. Results are grouped by archive, in the order given.
+		static std::vector<VerificationResult> Verify(const std::vector<ArchiveFile*>& archives,
+			const std::vector<const ArchiveManifest*>& manifests, std::size_t threadCount = 0);
+
+		// CRC-32 (as used by zip), continuing from a previous crc for data split over several calls
+		static uint32_t Crc32(const void* data, std::size_t size, uint32_t crc = 0);
+		// CRC-32 of the remainder of a stream. Throws if the stream ends early.
+		static uint32_t Crc32(Stream::BidirectionalReader& reader);
+	};
+}
@@ -1,15 +1,21 @@
 #include "BitStreamReader.h"
+#include "../Stream/Reader.h"
 #include <stdexcept>
 #include <string>
 #include <limits>
+#include <algorithm>
+#include <cstring>
 
 namespace OP2Utility::Archive
 {
 	BitStreamReader::BitStreamReader(void *buffer, std::size_t bufferSize) :
 		m_BufferBitSize(bufferSize << 3),
 		m_Buffer(static_cast<unsigned char*>(buffer)),
+		m_ChunkStart(0),
+		m_ChunkEnd(bufferSize),
 		m_ReadBitIndex(0),
-		m_ReadBuff(0)
+		m_ReadBuff(0),
+		m_StreamReader(nullptr)
 	{
 		// Check bufferSize does not exceed the max addressable bit index
 		if (bufferSize > std::numeric_limits<decltype(m_BufferBitSize)>::max() / 8) {
@@ -17,6 +23,39 @@ namespace OP2Utility::Archive
 		}
 	}
 
+	BitStreamReader::BitStreamReader(Stream::Reader& streamReader, std::size_t streamLength, std::size_t chunkSize) :
+		m_BufferBitSize(streamLength << 3),
+		m_Buffer(nullptr),
+		m_ChunkStart(0),
+		m_ChunkEnd(0),
+		m_ReadBitIndex(0),
+		m_ReadBuff(0),
+		m_StreamReader(&streamReader),
+		m_Chunk(std::max<std::size_t>(chunkSize, 4)) // Room for the bytes spanned by a peek
+	{
+		if (streamLength > std::numeric_limits<decltype(m_BufferBitSize)>::max() / 8) {
+			throw std::runtime_error("BitStreamReader cannot support a stream length of " + std::to_string(streamLength));
+		}
+
+		m_Buffer = m_Chunk.data();
+	}
+
+	BitStreamReader::BitStreamReader(const BitStreamReader& bitStreamReader) :
+		m_BufferBitSize(bitStreamReader.m_BufferBitSize),
+		m_Buffer(bitStreamReader.m_Buffer),
+		m_ChunkStart(bitStreamReader.m_ChunkStart),
+		m_ChunkEnd(bitStreamReader.m_ChunkEnd),
+		m_ReadBitIndex(bitStreamReader.m_ReadBitIndex),
+		m_ReadBuff(bitStreamReader.m_ReadBuff),
+		m_StreamReader(bitStreamReader.m_StreamReader),
+		m_Chunk(bitStreamReader.m_Chunk)
+	{
+		// A stream backed reader must point into its own copy of the chunk
+		if (m_StreamReader) {
+			m_Buffer = m_Chunk.data();
+		}
+	}
+
 
 
 
@@ -31,7 +70,7 @@ namespace OP2Utility::Archive
 
 		// Check if a new byte needs to be buffered
 		if ((m_ReadBitIndex & 0x07) == 0) {
-			m_ReadBuff = m_Buffer[m_ReadBitIndex >> 3];
+			m_ReadBuff = GetByte(m_ReadBitIndex >> 3);
 		}
 
 		// Extract the uppermost bit
@@ -57,7 +96,7 @@ namespace OP2Utility::Archive
 		if (i == 0)
 		{
 			// Read the next byte and return it
-			value = m_Buffer[m_ReadBitIndex >> 3];
+			value = GetByte(m_ReadBitIndex >> 3);
 			m_ReadBitIndex += 8;
 			return value;
 		}
@@ -70,7 +109,7 @@ namespace OP2Utility::Archive
 			m_ReadBuff = 0;
 		}
 		else {
-			m_ReadBuff = m_Buffer[m_ReadBitIndex >> 3];
+			m_ReadBuff = GetByte(m_ReadBitIndex >> 3);
 		}
 
 		value |= (m_ReadBuff >> (8 - i));
@@ -79,6 +118,37 @@ namespace OP2Utility::Archive
 	}
 
 
+	unsigned int BitStreamReader::PeekBits(unsigned int bitCount)
+	{
+		if (bitCount > MaxPeekBitCount) {
+			throw std::runtime_error("BitStreamReader can not peek " + std::to_string(bitCount)
+				+ " bits. Maximum is " + std::to_string(MaxPeekBitCount));
+		}
+
+		// Gather the 3 bytes spanned by the peek, zero filled past the end of the stream
+		const std::size_t byteIndex = m_ReadBitIndex >> 3;
+		const std::size_t streamLength = m_BufferBitSize >> 3;
+		unsigned int window = 0;
+		for (std::size_t i = byteIndex; i < byteIndex + 3; ++i) {
+			window = (window << 8) | (i < streamLength ? GetByte(i) : 0);
+		}
+
+		const unsigned int bitOffset = m_ReadBitIndex & 0x07;
+		return (window >> (24 - bitOffset - bitCount)) & ((1u << bitCount) - 1);
+	}
+
+	void BitStreamReader::ConsumeBits(unsigned int bitCount)
+	{
+		m_ReadBitIndex = std::min(m_ReadBitIndex + bitCount, m_BufferBitSize);
+
+		// Refill the read buffer with the remaining bits of a partially read byte
+		const unsigned int bitOffset = m_ReadBitIndex & 0x07;
+		if (bitOffset != 0) {
+			m_ReadBuff = static_cast<unsigned char>(GetByte(m_ReadBitIndex >> 3) << bitOffset);
+		}
+	}
+
+
 	bool BitStreamReader::EndOfStream() const
 	{
 		return m_ReadBitIndex >= m_BufferBitSize;
@@ -88,4 +158,37 @@ namespace OP2Utility::Archive
 	{
 		return m_ReadBitIndex;
 	}
+
+
+	// Returns the byte at byteIndex, loading a new chunk from the source stream if needed
+	// Note: Bytes are requested in increasing order (aside from re-reading bytes at or after the
+	//  current read position), and never past the end of the stream
+	unsigned char BitStreamReader::GetByte(std::size_t byteIndex)
+	{
+		if (byteIndex >= m_ChunkEnd) {
+			LoadChunk(byteIndex);
+		}
+
+		return m_Buffer[byteIndex - m_ChunkStart];
+	}
+
+	void BitStreamReader::LoadChunk(std::size_t byteIndex)
+	{
+		if (!m_StreamReader) {
+			throw std::runtime_error("BitStreamReader attempted to read past the end of its buffer");
+		}
+
+		// Keep loaded bytes from the current read position onward, as a peek may extend past the chunk
+		const std::size_t keepStart = std::max(m_ChunkStart, std::min(m_ReadBitIndex >> 3, byteIndex));
+		const std::size_t keepLength = m_ChunkEnd > keepStart ? m_ChunkEnd - keepStart : 0;
+		std::memmove(m_Chunk.data(), m_Chunk.data() + (keepStart - m_ChunkStart), keepLength);
+
+		const std::size_t streamLength = m_BufferBitSize >> 3;
+		const std::size_t readLength = std::min(m_Chunk.size() - keepLength, streamLength - m_ChunkEnd);
+
+		m_StreamReader->Read(m_Chunk.data() + keepLength, readLength);
+
+		m_ChunkStart = keepStart;
+		m_ChunkEnd += readLength;
+	}
 }
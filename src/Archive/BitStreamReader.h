@@ -1,6 +1,12 @@
 #pragma once
 
 #include <cstddef>
+#include <vector>
+
+namespace OP2Utility::Stream
+{
+	class Reader;
+}
 
 namespace OP2Utility::Archive
 {
@@ -8,18 +14,40 @@ namespace OP2Utility::Archive
 	class BitStreamReader
 	{
 	public:
+		static const std::size_t DefaultChunkSize = 0x4000;
+		static const unsigned int MaxPeekBitCount = 16;
+
 		BitStreamReader(void *buffer, std::size_t bufferSize); // Construct stream around given buffer
 
+		// Construct stream around streamLength bytes pulled from streamReader, chunkSize bytes at a time
+		// Only a single chunk is held in memory. The streamReader must outlive the BitStreamReader.
+		// Note: Copies share the streamReader, so only one copy should be read from
+		BitStreamReader(Stream::Reader& streamReader, std::size_t streamLength, std::size_t chunkSize = DefaultChunkSize);
+		BitStreamReader(const BitStreamReader& bitStreamReader);
+		BitStreamReader& operator=(const BitStreamReader& bitStreamReader) = delete;
+
 		bool ReadNextBit();			// Get bit at Read index and advance index
 		int  ReadNext8Bits();		// Get next 8 bits at Read index and advance index
+		// Get next bitCount bits (up to 16) at Read index without advancing, first bit in the MSB
+		// Bits past the end of the stream read as 0
+		unsigned int PeekBits(unsigned int bitCount);
+		void ConsumeBits(unsigned int bitCount); // Advance Read index by bitCount bits (stops at the end of the stream)
 		bool EndOfStream() const;	// Returns true if the last bit has been read
 		std::size_t GetBitReadPos() const; // Returns the position (in bits) of the read pointer
 	private:
+		unsigned char GetByte(std::size_t byteIndex);
+		void LoadChunk(std::size_t byteIndex);
+
 		std::size_t m_BufferBitSize;// Size of buffer in bits
-		unsigned char *m_Buffer;	// Byte array of data
+		unsigned char *m_Buffer;	// Byte array of data (current chunk when reading from a stream)
+		std::size_t m_ChunkStart;	// Byte index of m_Buffer[0] within the bit stream
+		std::size_t m_ChunkEnd;		// Byte index just past the end of m_Buffer within the bit stream
 
 		std::size_t m_ReadBitIndex;	// Current bit being read from the stream
 
 		unsigned char m_ReadBuff;	// 1 Byte read buffer (shift bits out of)
+
+		Stream::Reader* m_StreamReader; // Source of chunks, or nullptr if reading from a fixed buffer
+		std::vector<unsigned char> m_Chunk;
 	};
 }
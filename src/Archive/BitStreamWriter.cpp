@@ -0,0 +1,48 @@
+#include "BitStreamWriter.h"
+
+namespace OP2Utility::Archive
+{
+	BitStreamWriter::BitStreamWriter() :
+		m_WriteBitIndex(0)
+	{
+	}
+
+
+	void BitStreamWriter::WriteBit(bool bit)
+	{
+		// Start a new byte when the previous one is full
+		if ((m_WriteBitIndex & 0x07) == 0) {
+			m_Buffer.push_back(0);
+		}
+
+		if (bit) {
+			m_Buffer.back() |= 0x80 >> (m_WriteBitIndex & 0x07);
+		}
+
+		m_WriteBitIndex++;
+	}
+
+	void BitStreamWriter::WriteBits(unsigned int bits, unsigned int bitCount)
+	{
+		while (bitCount > 0) {
+			--bitCount;
+			WriteBit((bits >> bitCount) & 1);
+		}
+	}
+
+
+	std::size_t BitStreamWriter::GetBitWritePos() const
+	{
+		return m_WriteBitIndex;
+	}
+
+	std::size_t BitStreamWriter::GetByteCount() const
+	{
+		return m_Buffer.size();
+	}
+
+	const std::vector<uint8_t>& BitStreamWriter::GetBuffer() const
+	{
+		return m_Buffer;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OP2Utility::Archive
+{
+	// This is designed for use in the .vol file compressor
+	// Bits are packed MSB first, matching the order BitStreamReader reads them in
+	class BitStreamWriter
+	{
+	public:
+		BitStreamWriter();
+
+		void WriteBit(bool bit);	// Append a single bit to the stream
+		void WriteBits(unsigned int bits, unsigned int bitCount); // Append the lower bitCount bits, MSB first
+
+		std::size_t GetBitWritePos() const; // Returns the number of bits written so far
+		std::size_t GetByteCount() const;	// Returns the number of bytes needed to hold all written bits
+
+		// Returns the written bytes. Unused bits of the last byte are zero.
+		const std::vector<uint8_t>& GetBuffer() const;
+	private:
+		std::vector<uint8_t> m_Buffer;
+		std::size_t m_WriteBitIndex;	// Number of bits written to the stream
+	};
+}
@@ -1,16 +1,22 @@
 #include "ClmFile.h"
-#include "../Stream/SliceReader.h"
+#include "../Stream/MemoryReader.h"
+#include "../Stream/MemoryMappedFile.h"
+#include "../Stream/SharedMemoryReader.h"
 #include "../XFile.h"
 #include <stdexcept>
 #include <algorithm>
 #include <cstring>
+#include <numeric>
 
 namespace OP2Utility::Archive
 {
-	ClmFile::ClmFile(const std::string& filename) : ArchiveFile(filename), clmFileReader(filename)
+	ClmFile::ClmFile(const std::string& filename, ArchiveBackend backend, ArchiveIndexCache* indexCache) : ArchiveFile(filename, backend)
 	{
-		m_ArchiveFileSize = clmFileReader.Length();
-		ReadHeader();
+		if (!ReadCachedIndex(indexCache)) {
+			ReadHeader(*OpenArchiveReader(0, m_ArchiveFileSize));
+			BuildNameIndex();
+			StoreCachedIndex(indexCache);
+		}
 	}
 
 	ClmFile::~ClmFile() { }
@@ -19,9 +25,9 @@ namespace OP2Utility::Archive
 	// Reads in the header when the volume is first opened and does some
 	// basic error checking on the header.
 	// Throws an error is problems encountered while reading the header.
-	void ClmFile::ReadHeader()
+	void ClmFile::ReadHeader(Stream::Reader& archiveReader)
 	{
-		clmFileReader.Read(clmHeader);
+		archiveReader.Read(clmHeader);
 
 		try {
 			clmHeader.VerifyFileVersion();
@@ -34,9 +40,26 @@ namespace OP2Utility::Archive
 		m_Count = clmHeader.packedFilesCount;
 
 		indexEntries = std::vector<IndexEntry>(m_Count);
-		clmFileReader.Read(indexEntries);
+		archiveReader.Read(indexEntries);
+	}
+
+
+	void ClmFile::WriteIndex(Stream::Writer& writer)
+	{
+		writer.Write(clmHeader);
+		writer.Write(indexEntries);
 	}
 
+	void ClmFile::ReadIndex(Stream::Reader& reader)
+	{
+		reader.Read(clmHeader);
+		clmHeader.VerifyFileVersion();
+
+		m_Count = clmHeader.packedFilesCount;
+
+		indexEntries = std::vector<IndexEntry>(m_Count);
+		reader.Read(indexEntries);
+	}
 
 	// Returns the internal file name of the packed file corresponding to index.
 	// Throws an error if packed file index is not valid.
@@ -60,21 +83,10 @@ namespace OP2Utility::Archive
 	void ClmFile::ExtractFile(std::size_t index, const std::string& pathOut)
 	{
 		VerifyIndexInBounds(index);
-		const auto& indexEntry = indexEntries[index];
-
-		auto header = WaveHeader::Create(clmHeader.waveFormat, indexEntry.dataLength);
 
 		try
 		{
-			Stream::FileWriter waveFileWriter(pathOut);
-
-			waveFileWriter.Write(header);
-
-			auto slice = clmFileReader.Slice(
-				indexEntry.dataOffset,
-				indexEntry.dataLength);
-
-			waveFileWriter.Write(slice);
+			WriteExtractedFile(index, *OpenStream(index), pathOut);
 		}
 		catch (const std::exception& e)
 		{
@@ -82,47 +94,84 @@ namespace OP2Utility::Archive
 		}
 	}
 
+	void ClmFile::WriteExtractedFile(std::size_t index, Stream::BidirectionalReader& contents, const std::string& pathOut)
+	{
+		auto header = WaveHeader::Create(clmHeader.waveFormat, indexEntries[index].dataLength);
+
+		Stream::FileWriter waveFileWriter(pathOut);
+
+		waveFileWriter.Write(header);
+		waveFileWriter.Write(contents);
+		waveFileWriter.Flush();
+	}
+
 	std::unique_ptr<Stream::BidirectionalReader> ClmFile::OpenStream(std::size_t index)
 	{
 		VerifyIndexInBounds(index);
+		return OpenArchiveReader(indexEntries[index].dataOffset, indexEntries[index].dataLength);
+	}
+
+	uint64_t ClmFile::GetPackedDataOffset(std::size_t index)
+	{
+		return indexEntries[index].dataOffset;
+	}
+
+	std::unique_ptr<Stream::BidirectionalReader> ClmFile::OpenPackedStream(std::size_t index, const uint8_t* packedData, std::size_t availableLength)
+	{
 		const auto& indexEntry = indexEntries[index];
+		if (indexEntry.dataLength > availableLength) {
+			return nullptr;
+		}
+
+		return std::make_unique<Stream::MemoryReader>(packedData, indexEntry.dataLength);
+	}
 
-		auto slice = clmFileReader.Slice(
-			indexEntry.dataOffset,
-			indexEntry.dataLength);
+	ArchiveFile::FileView ClmFile::GetFileView(std::size_t index)
+	{
+		VerifyIndexInBounds(index);
+
+		if (!m_MappedFile) {
+			return ArchiveFile::GetFileView(index);
+		}
 
-		return std::make_unique<Stream::FileSliceReader>(slice);
+		const auto& indexEntry = indexEntries[index];
+		return FileView{ GetMappedData(indexEntry.dataOffset, indexEntry.dataLength), indexEntry.dataLength };
 	}
 
 	// Creates a new Archive file with the file name archiveFilename. The
 	// files listed in the container filesToPack are packed into the archive.
 	// Automatically strips file name extensions from filesToPack.
 	// Returns nonzero if successful and zero otherwise.
-	void ClmFile::CreateArchive(const std::string& archiveFilename, std::vector<std::string> filesToPack)
+	void ClmFile::CreateArchive(const std::string& archiveFilename, std::vector<std::string> filesToPack, bool deduplicate)
+	{
+		CreateArchiveFromSources(archiveFilename, PackSource::FromFiles(filesToPack), deduplicate);
+	}
+
+	void ClmFile::CreateArchiveFromSources(const std::string& archiveFilename, std::vector<PackSource> sources, bool deduplicate)
 	{
 		// Sort files alphabetically based on the filename only (not including the full path).
 		// Packed files must be locatable by a binary search of their filename.
-		std::sort(filesToPack.begin(), filesToPack.end(), ComparePathFilenames);
-
-		std::vector<std::unique_ptr<Stream::FileReader>> filesToPackReaders;
+		std::sort(sources.begin(), sources.end(), [](const PackSource& source1, const PackSource& source2) {
+			return ComparePathFilenames(source1.name, source2.name);
+		});
 
-		// Opens all files for packing. If there is a problem opening a file, an exception is raised.
-		for (const auto& filename : filesToPack) {
-			filesToPackReaders.push_back(std::make_unique<Stream::FileReader>(filename));
+		std::vector<std::string> sourceNames;
+		for (const auto& source : sources) {
+			sourceNames.push_back(source.name);
 		}
 
 		// Initialize vectors with default values for the number of files to pack.
 		// Allows directly reading data into the vector using a Reader.
-		std::vector<WaveFormatEx> waveFormats(filesToPack.size());
-		std::vector<IndexEntry> indexEntries(filesToPack.size());
+		std::vector<WaveFormatEx> waveFormats(sources.size());
+		std::vector<IndexEntry> indexEntries(sources.size());
 
-		ReadAllWaveHeaders(filesToPackReaders, waveFormats, indexEntries);
+		// Each file is opened in turn. If there is a problem opening a file, an exception is raised.
+		ReadAllWaveHeaders(sources, waveFormats, indexEntries);
 
 		// Check if all wave formats are the same
-		CompareWaveFormats(waveFormats, filesToPack);
+		CompareWaveFormats(waveFormats, sourceNames);
 
-		std::vector<std::string> names = GetNamesFromPaths(filesToPack);
-		names = StripFilenameExtensions(names);
+		std::vector<std::string> names = StripFilenameExtensions(sourceNames);
 
 		for (const auto& name : names) {
 			if (name.size() > 8) {
@@ -133,42 +182,50 @@ namespace OP2Utility::Archive
 		// Allowing duplicate names when packing may cause unintended results during search and file extraction.
 		VerifySortedContainerHasNoDuplicateNames(names);
 
+		// Index of the file whose audio data each file uses
+		std::vector<std::size_t> dataSources(sources.size());
+		if (deduplicate) {
+			dataSources = PackSource::FindDuplicates(sources);
+		}
+		else {
+			std::iota(dataSources.begin(), dataSources.end(), std::size_t(0));
+		}
+
 		// Write the archive header and copy files into the archive
-		WriteArchive(archiveFilename, filesToPackReaders, indexEntries, names, PrepareWaveFormat(waveFormats));
+		WriteArchive(archiveFilename, sources, indexEntries, names, PrepareWaveFormat(waveFormats), dataSources);
 	}
 
 	// Reads the beginning of each file and verifies it is formatted as a WAVE file. Locates
 	// the WaveFormatEx structure and start of data. The WaveFormat is stored in the waveFormats container.
-	// The current stream position is set to the start of the data chunk.
-	// Note: This function assumes that all stream positions are initially set to the beginning
-	//  of the file. When reading the wave file header, it does not seek to the file start.
-	void ClmFile::ReadAllWaveHeaders(std::vector<std::unique_ptr<Stream::FileReader>>& filesToPackReaders, std::vector<WaveFormatEx>& waveFormats, std::vector<IndexEntry>& indexEntries)
+	// Each file is only open while its header is read.
+	void ClmFile::ReadAllWaveHeaders(const std::vector<PackSource>& sources, std::vector<WaveFormatEx>& waveFormats, std::vector<IndexEntry>& indexEntries)
 	{
 		RiffHeader header;
 
 		// Read in all the headers and find start of data
-		for (std::size_t i = 0; i < filesToPackReaders.size(); ++i)
+		for (std::size_t i = 0; i < sources.size(); ++i)
 		{
+			auto reader = sources[i].Open();
+
 			// Read the file header
-			filesToPackReaders[i]->Read(header);
+			reader->Read(header);
 			if (header.riffTag != tagRIFF || header.waveTag != tagWAVE) {
-				throw std::runtime_error("Error reading header from file " + filesToPackReaders[i]->GetFilename());
+				throw std::runtime_error("Error reading header from file " + sources[i].name);
 			}
 
 			// Check that the file size makes sense (matches with header chunk length + 8)
-			if (header.chunkSize + 8 != filesToPackReaders[i]->Length()) {
-				throw std::runtime_error("Chunk size does not match file length in " + filesToPackReaders[i]->GetFilename());
+			if (header.chunkSize + 8 != reader->Length()) {
+				throw std::runtime_error("Chunk size does not match file length in " + sources[i].name);
 			}
 
 			// Find the format tag
-			FindChunk(tagFMT_, *filesToPackReaders[i]);
+			FindChunk(tagFMT_, *reader);
 			// Read in the wave format
-			filesToPackReaders[i]->Read(waveFormats[i]);
+			reader->Read(waveFormats[i]);
 			waveFormats[i].cbSize = 0;
 
 			// Find the start of the data and record length
-			indexEntries[i].dataLength = FindChunk(tagDATA, *filesToPackReaders[i]);
-			// Note: Current stream position is set to the start of the wave data
+			indexEntries[i].dataLength = FindChunk(tagDATA, *reader);
 		}
 	}
 
@@ -208,22 +265,23 @@ namespace OP2Utility::Archive
 
 	// Compares wave format structures in the waveFormats container
 	// If 2 wave formats are discovered of different type, an error is thrown.
-	void ClmFile::CompareWaveFormats(const std::vector<WaveFormatEx>& waveFormats, const std::vector<std::string>& filesToPack)
+	void ClmFile::CompareWaveFormats(const std::vector<WaveFormatEx>& waveFormats, const std::vector<std::string>& names)
 	{
 		for (std::size_t i = 0; i < waveFormats.size(); ++i)
 		{
 			if (memcmp(&waveFormats[0], &waveFormats[i], sizeof(WaveFormatEx))) {
-				throw std::runtime_error("Files " + filesToPack[0] + " and " + filesToPack[i] +
+				throw std::runtime_error("Files " + names[0] + " and " + names[i] +
 					" contain differnt wave formats. Clm files cannot contain 2 wave files with different formats.");
 			}
 		}
 	}
 
 	void ClmFile::WriteArchive(const std::string& archiveFilename,
-		const std::vector<std::unique_ptr<Stream::FileReader>>& filesToPackReaders,
+		const std::vector<PackSource>& sources,
 		std::vector<IndexEntry>& indexEntries,
 		const std::vector<std::string>& names,
-		const WaveFormatEx& waveFormat)
+		const WaveFormatEx& waveFormat,
+		const std::vector<std::size_t>& dataSources)
 	{
 		// ClmFile cannot contain more than 32 bit size internal file count.
 		ClmHeader header = ClmHeader::MakeHeader(waveFormat, static_cast<uint32_t>(names.size()));
@@ -233,16 +291,25 @@ namespace OP2Utility::Archive
 		clmFileWriter.Write(header);
 
 		// Prepare and write Archive Index
-		PrepareIndex(sizeof(header), names, indexEntries);
+		PrepareIndex(sizeof(header), names, indexEntries, dataSources);
 		clmFileWriter.Write(indexEntries);
 
-		// Copy files into the archive
+		// Copy files into the archive, opening each in turn. Duplicates share the data already copied.
 		for (std::size_t i = 0; i < header.packedFilesCount; ++i) {
-			clmFileWriter.Write(*filesToPackReaders[i]);
+			if (dataSources[i] != i) {
+				continue;
+			}
+
+			auto reader = sources[i].Open();
+			FindChunk(tagDATA, *reader);
+			clmFileWriter.Write(*reader);
 		}
+
+		clmFileWriter.Flush();
 	}
 
-	void ClmFile::PrepareIndex(int headerSize, const std::vector<std::string>& names, std::vector<IndexEntry>& indexEntries)
+	void ClmFile::PrepareIndex(int headerSize, const std::vector<std::string>& names, std::vector<IndexEntry>& indexEntries,
+		const std::vector<std::size_t>& dataSources)
 	{
 		uint64_t offset = headerSize + names.size() * sizeof(IndexEntry);
 		for (std::size_t i = 0; i < names.size(); ++i)
@@ -253,6 +320,11 @@ namespace OP2Utility::Archive
 #pragma warning( suppress : 4996 )
 			std::strncpy(indexEntries[i].filename.data(), names[i].data(), sizeof(IndexEntry::filename));
 
+			if (dataSources[i] != i) {
+				indexEntries[i].dataOffset = indexEntries[dataSources[i]].dataOffset;
+				continue;
+			}
+
 			if (offset + indexEntries[i].dataLength > UINT32_MAX) {
 				throw std::runtime_error("Index Entry offset is too large to create CLM file");
 			}
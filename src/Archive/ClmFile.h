@@ -2,6 +2,7 @@
 
 #include "WaveFile.h"
 #include "ArchiveFile.h"
+#include "PackSource.h"
 #include "../Tag.h"
 #include "../Stream/FileReader.h"
 #include "../Stream/FileWriter.h"
@@ -16,7 +17,8 @@ namespace OP2Utility::Archive
 	class ClmFile : public ArchiveFile
 	{
 	public:
-		ClmFile(const std::string& filename);
+		// With an indexCache, the index is restored from the cache if current, or else parsed and stored in the cache
+		ClmFile(const std::string& filename, ArchiveBackend backend = ArchiveBackend::FileStream, ArchiveIndexCache* indexCache = nullptr);
 		~ClmFile() override;
 
 		std::string GetName(std::size_t index) override;
@@ -26,8 +28,23 @@ namespace OP2Utility::Archive
 		// Opens a stream containing packed audio PCM data
 		std::unique_ptr<Stream::BidirectionalReader> OpenStream(std::size_t index) override;
 
+		// Views of packed audio PCM data are available for memory mapped archives
+		FileView GetFileView(std::size_t index) override;
+
 		// Create a new archive with the files specified in filesToPack
-		static void CreateArchive(const std::string& archiveFilename, std::vector<std::string> filesToPack);
+		// Files are opened one at a time, only while being read
+		// With deduplicate, files with identical contents share one copy of their audio data
+		static void CreateArchive(const std::string& archiveFilename, std::vector<std::string> filesToPack, bool deduplicate = false);
+		// Create a new archive from wave file sources, such as in-memory buffers, named by PackSource::name
+		static void CreateArchiveFromSources(const std::string& archiveFilename, std::vector<PackSource> sources, bool deduplicate = false);
+
+	protected:
+		uint64_t GetPackedDataOffset(std::size_t index) override;
+		std::unique_ptr<Stream::BidirectionalReader> OpenPackedStream(std::size_t index, const uint8_t* packedData, std::size_t availableLength) override;
+		// Writes a wave file header before the packed audio PCM data
+		void WriteExtractedFile(std::size_t index, Stream::BidirectionalReader& contents, const std::string& pathOut) override;
+		void WriteIndex(Stream::Writer& writer) override;
+		void ReadIndex(Stream::Reader& reader) override;
 
 	private:
 #pragma pack(push, 1)
@@ -62,19 +79,20 @@ namespace OP2Utility::Archive
 #pragma pack(pop)
 
 		// Private functions for reading archive
-		void ReadHeader();
+		void ReadHeader(Stream::Reader& archiveReader);
 
 		// Private functions for packing files
-		static void ReadAllWaveHeaders(std::vector<std::unique_ptr<Stream::FileReader>>& filesToPackReaders, std::vector<WaveFormatEx>& waveFormats, std::vector<IndexEntry>& indexEntries);
+		static void ReadAllWaveHeaders(const std::vector<PackSource>& sources, std::vector<WaveFormatEx>& waveFormats, std::vector<IndexEntry>& indexEntries);
 		static uint32_t FindChunk(Tag chunkTag, Stream::BidirectionalReader& seekableStreamReader);
-		static void CompareWaveFormats(const std::vector<WaveFormatEx>& waveFormatsconst, const std::vector<std::string>& filesToPack);
-		static void WriteArchive(const std::string& archiveFilename, const std::vector<std::unique_ptr<Stream::FileReader>>& filesToPackReaders,
-			std::vector<IndexEntry>& indexEntries, const std::vector<std::string>& names, const WaveFormatEx& waveFormat);
-		static void PrepareIndex(int headerSize, const std::vector<std::string>& names, std::vector<IndexEntry>& indexEntries);
+		static void CompareWaveFormats(const std::vector<WaveFormatEx>& waveFormatsconst, const std::vector<std::string>& names);
+		static void WriteArchive(const std::string& archiveFilename, const std::vector<PackSource>& sources,
+			std::vector<IndexEntry>& indexEntries, const std::vector<std::string>& names, const WaveFormatEx& waveFormat,
+			const std::vector<std::size_t>& dataSources);
+		static void PrepareIndex(int headerSize, const std::vector<std::string>& names, std::vector<IndexEntry>& indexEntries,
+			const std::vector<std::size_t>& dataSources);
 		static std::vector<std::string> StripFilenameExtensions(std::vector<std::string> paths);
 		static WaveFormatEx PrepareWaveFormat(const std::vector<WaveFormatEx>& waveFormats);
 
-		Stream::FileReader clmFileReader;
 		ClmHeader clmHeader;
 		std::vector<IndexEntry> indexEntries;
 	};
@@ -0,0 +1,129 @@
+#include "DecompressedEntryCache.h"
+#include <utility>
+
+namespace OP2Utility::Archive
+{
+	DecompressedEntryCache::DecompressedEntryCache(std::size_t byteBudget) :
+		byteBudget(byteBudget),
+		bytesUsed(0),
+		hits(0),
+		misses(0),
+		evictions(0)
+	{ }
+
+	DecompressedEntryCache::Contents DecompressedEntryCache::Find(const ArchiveFile& archive, std::size_t index)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		const auto entry = entryIndex.find(Key{ &archive, index });
+		if (entry == entryIndex.end()) {
+			++misses;
+			return nullptr;
+		}
+
+		++hits;
+		// Move to the front, marking it most recently used
+		entries.splice(entries.begin(), entries, entry->second);
+		return entry->second->contents;
+	}
+
+	DecompressedEntryCache::Contents DecompressedEntryCache::GetOrLoad(const ArchiveFile& archive, std::size_t index, const std::function<std::vector<uint8_t>()>& load)
+	{
+		auto contents = Find(archive, index);
+		if (contents) {
+			return contents;
+		}
+
+		// Load without holding the lock, so other entries can be used meanwhile
+		contents = std::make_shared<const std::vector<uint8_t>>(load());
+		Insert(archive, index, contents);
+		return contents;
+	}
+
+	void DecompressedEntryCache::Insert(const ArchiveFile& archive, std::size_t index, Contents contents)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		InsertLocked(Key{ &archive, index }, std::move(contents));
+	}
+
+	void DecompressedEntryCache::Remove(const ArchiveFile& archive)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (auto entry = entries.begin(); entry != entries.end(); ) {
+			auto next = std::next(entry);
+			if (entry->key.archive == &archive) {
+				EraseLocked(entry);
+			}
+			entry = next;
+		}
+	}
+
+	void DecompressedEntryCache::Clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		entries.clear();
+		entryIndex.clear();
+		bytesUsed = 0;
+	}
+
+	void DecompressedEntryCache::SetByteBudget(std::size_t byteBudget)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		this->byteBudget = byteBudget;
+		EvictToBudgetLocked(byteBudget);
+	}
+
+	std::size_t DecompressedEntryCache::GetByteBudget() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return byteBudget;
+	}
+
+	DecompressedEntryCache::Statistics DecompressedEntryCache::GetStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return Statistics{ hits, misses, evictions, entries.size(), bytesUsed };
+	}
+
+	void DecompressedEntryCache::InsertLocked(const Key& key, Contents contents)
+	{
+		if (!contents || contents->size() > byteBudget) {
+			return;
+		}
+
+		// Another thread may have loaded the same entry
+		const auto existing = entryIndex.find(key);
+		if (existing != entryIndex.end()) {
+			EraseLocked(existing->second);
+		}
+
+		EvictToBudgetLocked(byteBudget - contents->size());
+
+		bytesUsed += contents->size();
+		entries.push_front(Entry{ key, std::move(contents) });
+		entryIndex[key] = entries.begin();
+	}
+
+	void DecompressedEntryCache::EraseLocked(std::list<Entry>::iterator entry)
+	{
+		bytesUsed -= entry->contents->size();
+		entryIndex.erase(entry->key);
+		entries.erase(entry);
+	}
+
+	void DecompressedEntryCache::EvictToBudgetLocked(std::size_t byteBudget)
+	{
+		while (bytesUsed > byteBudget) {
+			EraseLocked(std::prev(entries.end()));
+			++evictions;
+		}
+	}
+
+	std::size_t DecompressedEntryCache::KeyHash::operator()(const Key& key) const
+	{
+		return std::hash<const ArchiveFile*>()(key.archive) ^ (key.index * static_cast<std::size_t>(0x9E3779B97F4A7C15ull));
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace OP2Utility::Archive
+{
+	class ArchiveFile;
+
+	// Least recently used cache of decompressed packed file contents, keyed by (archive, index).
+	// Holds at most byteBudget bytes of contents. Safe to share between archives and threads.
+	class DecompressedEntryCache
+	{
+	public:
+		using Contents = std::shared_ptr<const std::vector<uint8_t>>;
+
+		struct Statistics
+		{
+			std::size_t hits;
+			std::size_t misses;
+			std::size_t evictions;
+			std::size_t entryCount;
+			std::size_t bytesUsed;
+		};
+
+		DecompressedEntryCache(std::size_t byteBudget);
+
+		// Returns the cached contents, or nullptr if not cached
+		Contents Find(const ArchiveFile& archive, std::size_t index);
+		// Returns the cached contents, or caches and returns the result of load
+		Contents GetOrLoad(const ArchiveFile& archive, std::size_t index, const std::function<std::vector<uint8_t>()>& load);
+		// Contents larger than the byte budget are not cached
+		void Insert(const ArchiveFile& archive, std::size_t index, Contents contents);
+
+		void Remove(const ArchiveFile& archive);
+		void Clear();
+
+		// Evicts least recently used entries if the new budget is smaller
+		void SetByteBudget(std::size_t byteBudget);
+		std::size_t GetByteBudget() const;
+		Statistics GetStatistics() const;
+
+	private:
+		struct Key
+		{
+			const ArchiveFile* archive;
+			std::size_t index;
+
+			bool operator==(const Key& other) const {
+				return archive == other.archive && index == other.index;
+			}
+		};
+
+		struct KeyHash
+		{
+			std::size_t operator()(const Key& key) const;
+		};
+
+		struct Entry
+		{
+			Key key;
+			Contents contents;
+		};
+
+		void InsertLocked(const Key& key, Contents contents);
+		void EraseLocked(std::list<Entry>::iterator entry);
+		void EvictToBudgetLocked(std::size_t byteBudget);
+
+		mutable std::mutex mutex;
+		std::list<Entry> entries; // Most recently used first
+		std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> entryIndex;
+		std::size_t byteBudget;
+		std::size_t bytesUsed;
+		std::size_t hits;
+		std::size_t misses;
+		std::size_t evictions;
+	};
+}
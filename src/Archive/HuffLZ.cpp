@@ -1,20 +1,31 @@
 #include "HuffLZ.h"
 #include <cstring>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
 
 namespace OP2Utility::Archive
 {
 	// Constructs the object around an existing bit stream
-	HuffLZ::HuffLZ(const BitStreamReader& bitStream) :
+	template <typename BitReader>
+	BasicHuffLZ<BitReader>::BasicHuffLZ(const BitReader& bitStream, unsigned int prefixTableBitCount) :
 		m_BitStreamReader(bitStream),
 		m_AdaptiveHuffmanTree(AdaptiveHuffmanTree(314)),
 		m_BuffWriteIndex(0),
 		m_BuffReadIndex(0),
 		m_EOS(false)
 	{
+		if (prefixTableBitCount > BitReader::MaxPeekBitCount) {
+			throw std::runtime_error("HuffLZ prefix table bit count of " + std::to_string(prefixTableBitCount)
+				+ " exceeds the maximum of " + std::to_string(BitReader::MaxPeekBitCount));
+		}
+
+		m_AdaptiveHuffmanTree.SetPrefixTableBitCount(prefixTableBitCount);
 		InitializeDecompressBuffer();
 	}
 
-	void HuffLZ::InitializeDecompressBuffer() {
+	template <typename BitReader>
+	void BasicHuffLZ<BitReader>::InitializeDecompressBuffer() {
 		// Initialize the decompress buffer to spaces
 		std::memset(m_DecompressBuffer, ' ', 4096);
 	}
@@ -24,7 +35,8 @@ namespace OP2Utility::Archive
 	// data is available to fill the buffer, more of the input is decompressed up to
 	// the end of the input stream or until the buffer is filled. Returns the total
 	// number of bytes that were copied.
-	std::size_t HuffLZ::GetData(char *buffer, std::size_t bufferSize)
+	template <typename BitReader>
+	std::size_t BasicHuffLZ<BitReader>::GetData(char *buffer, std::size_t bufferSize)
 	{
 		std::size_t numBytesCopied;
 		std::size_t numBytesTotal = 0;
@@ -56,7 +68,8 @@ namespace OP2Utility::Archive
 	// Note: If the buffer wraps around, the remaining data before the wrap around
 	//  is returned. A subsequent call will get the data after the wrap around.
 	// Note: If sizeAvailableData == 0 then the end of the stream has been reached
-	const char* HuffLZ::GetInternalBuffer(std::size_t *sizeAvailableData)
+	template <typename BitReader>
+	const char* BasicHuffLZ<BitReader>::GetInternalBuffer(std::size_t *sizeAvailableData)
 	{
 		const char* currentPos;
 
@@ -80,7 +93,63 @@ namespace OP2Utility::Archive
 		return currentPos;
 	}
 
-	void HuffLZ::FillDecompressBuffer()
+	// Decompresses codes directly into a linear output buffer. Repeated blocks which start
+	// before the beginning of the output read from the initial window of spaces.
+	template <typename BitReader>
+	std::size_t BasicHuffLZ<BitReader>::DecompressInto(char *buffer, std::size_t bufferSize)
+	{
+		std::size_t writeIndex = 0;
+
+		while (writeIndex < bufferSize && !m_EOS)
+		{
+			// Get the next code and update the tree
+			const unsigned int code = GetNextCode();
+			m_AdaptiveHuffmanTree.UpdateCodeCount(code);
+
+			if (code < 256)
+			{
+				// code is an ASCII code. Output it.
+				buffer[writeIndex++] = static_cast<char>(code);
+			}
+			else
+			{
+				// code is a repeat block code. Length of block is (code - 253)
+				const std::size_t distance = GetRepeatOffset() + 1;
+				std::size_t length = std::min<std::size_t>(code - 253, bufferSize - writeIndex);
+
+				// Part of the block lies before the start of the output
+				if (distance > writeIndex)
+				{
+					const std::size_t spaceCount = std::min(length, distance - writeIndex);
+					std::memset(&buffer[writeIndex], ' ', spaceCount);
+					writeIndex += spaceCount;
+					length -= spaceCount;
+				}
+
+				if (length > 0)
+				{
+					const char* source = &buffer[writeIndex - distance];
+					if (length <= distance) {
+						std::memcpy(&buffer[writeIndex], source, length);
+					}
+					else {
+						// Overlapping block repeats data written by this same copy
+						for (std::size_t i = 0; i < length; ++i) {
+							buffer[writeIndex + i] = source[i];
+						}
+					}
+					writeIndex += length;
+				}
+			}
+
+			m_EOS = m_BitStreamReader.EndOfStream();
+		}
+
+		return writeIndex;
+	}
+
+	template <typename BitReader>
+	void BasicHuffLZ<BitReader>::FillDecompressBuffer()
 	{
 		const int maxFill = 4096 - (314 - 253) - 1;
 		// Decompress until the buffer is nearly full
@@ -104,7 +173,8 @@ namespace OP2Utility::Archive
 
 	// Copies all available data into buff up to a maximum of size bytes
 	// This routine handles the case when the copy must wrap around the circular buffer
-	std::size_t HuffLZ::CopyAvailableData(char *buff, std::size_t size)
+	template <typename BitReader>
+	std::size_t BasicHuffLZ<BitReader>::CopyAvailableData(char *buff, std::size_t size)
 	{
 		std::size_t numBytesToCopy;
 		std::size_t numBytesTotal = 0;
@@ -157,7 +227,8 @@ namespace OP2Utility::Archive
 
 	// Performs one tree lookup and decompresses a portion based on the returned code.
 	// Returns true if the end of the stream has been reached
-	bool HuffLZ::DecompressCode()
+	template <typename BitReader>
+	bool BasicHuffLZ<BitReader>::DecompressCode()
 	{
 		unsigned short code;
 		unsigned int start;
@@ -195,13 +266,25 @@ namespace OP2Utility::Archive
 
 
 	// Performs a tree lookup guided by the bitstream to find the next code
-	int HuffLZ::GetNextCode()
+	template <typename BitReader>
+	int BasicHuffLZ<BitReader>::GetNextCode()
 	{
 		int nodeIndex;
 		bool bBit;
 
 		// Use bitstream to find a terminal node
 		nodeIndex = m_AdaptiveHuffmanTree.GetRootNodeIndex();
+
+		// Resolve the first several bits with a single table lookup
+		const unsigned int prefixBitCount = m_AdaptiveHuffmanTree.PrefixTableBitCount();
+		if (prefixBitCount > 0)
+		{
+			const auto prefixEntry = m_AdaptiveHuffmanTree.LookupPrefix(m_BitStreamReader.PeekBits(prefixBitCount));
+			m_BitStreamReader.ConsumeBits(prefixEntry.bitCount);
+			nodeIndex = prefixEntry.nodeIndex;
+		}
+
+		// Follow any remaining bits a bit at a time
 		while (!m_AdaptiveHuffmanTree.IsLeaf(nodeIndex))
 		{
 			bBit = m_BitStreamReader.ReadNextBit();
@@ -216,7 +299,8 @@ namespace OP2Utility::Archive
 	// Reads a variable length code from the bit stream (9-14 bits)
 	// Smaller offsets have a shorter bit code
 	// Returns a 12-bit offset (0..4095)
-	unsigned int HuffLZ::GetRepeatOffset()
+	template <typename BitReader>
+	unsigned int BasicHuffLZ<BitReader>::GetRepeatOffset()
 	{
 		// Get the next 8 bits
 		unsigned int offset = m_BitStreamReader.ReadNext8Bits();
@@ -234,7 +318,8 @@ namespace OP2Utility::Archive
 		return offset;
 	}
 
-	void HuffLZ::WriteCharToBuffer(char c)
+	template <typename BitReader>
+	void BasicHuffLZ<BitReader>::WriteCharToBuffer(char c)
 	{
 		m_DecompressBuffer[m_BuffWriteIndex] = c;			// Write the char to the buffer
 		m_BuffWriteIndex = (m_BuffWriteIndex + 1) & 0x0FFF;	// Wrap around 4096
@@ -242,7 +327,8 @@ namespace OP2Utility::Archive
 
 
 
-	HuffLZ::OffsetModifiers HuffLZ::GetOffsetModifiers(unsigned int offset) {
+	template <typename BitReader>
+	typename BasicHuffLZ<BitReader>::OffsetModifiers BasicHuffLZ<BitReader>::GetOffsetModifiers(unsigned int offset) {
 		if (offset < 0x20) {
 			return { 1, 0 };
 		}
@@ -261,4 +347,8 @@ namespace OP2Utility::Archive
 
 		return { 6, offset - 0xC0 };
 	}
+
+
+	template class BasicHuffLZ<BitStreamReader>;
+	template class BasicHuffLZ<WordBitStreamReader>;
 }
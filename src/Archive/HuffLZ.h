@@ -1,22 +1,37 @@
+#pragma once
+
 // This decompressor is meant to be compatible with
 // the compression in .vol files.
 
 #include "AdaptiveHuffmanTree.h"
 #include "BitStreamReader.h"
+#include "WordBitStreamReader.h"
 #include <cstddef>
 
 namespace OP2Utility::Archive
 {
-	class HuffLZ
+	// BitReader is the source of compressed bits (BitStreamReader or WordBitStreamReader)
+	template <typename BitReader>
+	class BasicHuffLZ
 	{
 	public:
-		HuffLZ(const BitStreamReader& bitStreamReader);
+		// Number of bits resolved per code lookup table access when decoding
+		static const unsigned int DefaultPrefixTableBitCount = 10;
+
+		// A prefixTableBitCount of 0 decodes codes a bit at a time by walking the tree
+		BasicHuffLZ(const BitReader& bitStreamReader, unsigned int prefixTableBitCount = DefaultPrefixTableBitCount);
 
 		std::size_t GetData(char *buffer, std::size_t bufferSize);	// Copy decoded data into given buffer.
 													// Returns number of bytes copied
 		const char* GetInternalBuffer(std::size_t *sizeAvailableData);
 		// Give access to internal decompress
 		// buffer (no memory copy required)
+
+		// Decompress straight into the given buffer, stopping when it is full or the stream ends.
+		// Repeated blocks are copied from the output itself, without the circular buffer or a second copy.
+		// Use only on a newly constructed object, and not together with GetData or GetInternalBuffer.
+		// Returns number of bytes written
+		std::size_t DecompressInto(char *buffer, std::size_t bufferSize);
 	private:
 		void InitializeDecompressBuffer();
 		void FillDecompressBuffer();				// Decompress until buffer is near full
@@ -33,11 +48,18 @@ namespace OP2Utility::Archive
 		static OffsetModifiers GetOffsetModifiers(unsigned int offset);
 
 		// Member variables
-		BitStreamReader m_BitStreamReader;
+		BitReader m_BitStreamReader;
 		AdaptiveHuffmanTree m_AdaptiveHuffmanTree;
 		char m_DecompressBuffer[4096];				// Circular decompression buffer
 		std::size_t m_BuffWriteIndex;
 		std::size_t m_BuffReadIndex;
 		bool m_EOS;									// End of Stream
 	};
+
+	using HuffLZ = BasicHuffLZ<BitStreamReader>;
+	using WordHuffLZ = BasicHuffLZ<WordBitStreamReader>; // Faster bit reads, otherwise identical to HuffLZ
+
+	// Definitions are in HuffLZ.cpp
+	extern template class BasicHuffLZ<BitStreamReader>;
+	extern template class BasicHuffLZ<WordBitStreamReader>;
 }
@@ -0,0 +1,344 @@
+#include "HuffLZEncoder.h"
+#include <cstring>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+namespace OP2Utility::Archive
+{
+	namespace
+	{
+		const std::size_t WindowSize = 4096;
+		const std::size_t MinMatchLength = 3;
+		const std::size_t MaxMatchLength = 60; // Codes 256 to 313 encode lengths (code - 253)
+		const unsigned int HashBits = 15;
+		const std::size_t MaxChainLength = 256;
+		const std::size_t CodeCount = 314;
+		// Positions parsed together by optimal parsing, which are priced by the tree as it was before the block
+		const std::size_t OptimalBlockSize = 1024;
+	}
+
+	HuffLZEncoder::HuffLZEncoder(const void* data, std::size_t size) :
+		m_History(WindowSize + size, ' '),
+		m_HashHead(std::size_t(1) << HashBits, -1),
+		m_HashPrev(WindowSize, -1),
+		m_AdaptiveHuffmanTree(314),
+		m_CodeCount(0)
+	{
+		if (size > 0) {
+			std::memcpy(&m_History[WindowSize], data, size);
+		}
+	}
+
+	bool HuffLZEncoder::Compress(const void* data, std::size_t size, std::vector<uint8_t>& compressedOut, std::size_t maxCompressedSize, CompressionLevel level)
+	{
+		HuffLZEncoder encoder(data, size);
+		bool completed = encoder.Encode(maxCompressedSize, level);
+		compressedOut = encoder.m_BitStreamWriter.GetBuffer();
+		return completed;
+	}
+
+
+	bool HuffLZEncoder::Encode(std::size_t maxCompressedSize, CompressionLevel level)
+	{
+		// The decompress buffer starts out filled with spaces, so they may be matched against.
+		// Only the most recent positions are useful, as the longest match is 60 bytes.
+		for (std::size_t position = WindowSize - MaxMatchLength; position < WindowSize; ++position) {
+			InsertHash(position);
+		}
+
+		if (level == CompressionLevel::Optimal) {
+			return EncodeOptimal(maxCompressedSize);
+		}
+
+		std::size_t position = WindowSize;
+		std::size_t distance;
+		std::size_t matchLength = FindLongestMatch(position, distance);
+		while (position < m_History.size())
+		{
+			std::size_t insertedCount = 0;
+
+			// Lazy matching: a longer match at the next position is worth a literal now
+			if (level == CompressionLevel::Lazy && matchLength >= MinMatchLength && matchLength < MaxMatchLength)
+			{
+				InsertHash(position);
+				insertedCount = 1;
+
+				std::size_t nextDistance;
+				const std::size_t nextMatchLength = FindLongestMatch(position + 1, nextDistance);
+				if (nextMatchLength > matchLength) {
+					WriteCode(m_History[position++]);
+					matchLength = nextMatchLength;
+					distance = nextDistance;
+
+					if (IsAbandoned(maxCompressedSize)) {
+						return false;
+					}
+					continue;
+				}
+			}
+
+			if (matchLength >= MinMatchLength) {
+				WriteMatch(matchLength, distance);
+			}
+			else {
+				matchLength = 1;
+				WriteCode(m_History[position]);
+			}
+
+			for (std::size_t i = insertedCount; i < matchLength; ++i) {
+				InsertHash(position + i);
+			}
+			position += matchLength;
+
+			if (IsAbandoned(maxCompressedSize)) {
+				return false;
+			}
+
+			matchLength = (position < m_History.size()) ? FindLongestMatch(position, distance) : 0;
+		}
+
+		return true;
+	}
+
+	// Parses each block by dynamic programming, for the sequence of literals and matches with the fewest bits.
+	// Code lengths are taken from the adaptive Huffman tree at the start of each block, so prices follow
+	// the tree as it adapts, while staying fixed within a block.
+	bool HuffLZEncoder::EncodeOptimal(std::size_t maxCompressedSize)
+	{
+		const unsigned int unreachable = UINT32_MAX;
+		std::vector<unsigned int> codeLengths(CodeCount);
+		std::vector<Match> matches;
+		std::vector<std::size_t> matchStarts(OptimalBlockSize + 1);
+		std::vector<unsigned int> costs(OptimalBlockSize + 1);
+		std::vector<Match> steps(OptimalBlockSize + 1); // Step taken to reach each position, a literal if length is 1
+		std::vector<Match> parse;
+
+		std::size_t position = WindowSize;
+		while (position < m_History.size())
+		{
+			const std::size_t blockLength = std::min(OptimalBlockSize, m_History.size() - position);
+
+			for (unsigned int code = 0; code < CodeCount; ++code) {
+				m_AdaptiveHuffmanTree.GetEncodedBitString(static_cast<AdaptiveHuffmanTree::NodeData>(code), codeLengths[code]);
+			}
+
+			// Find matches for each position, without crossing the end of the block
+			matches.clear();
+			for (std::size_t i = 0; i < blockLength; ++i) {
+				matchStarts[i] = matches.size();
+				FindMatches(position + i, std::min(MaxMatchLength, blockLength - i), matches);
+				InsertHash(position + i);
+			}
+			matchStarts[blockLength] = matches.size();
+
+			std::fill(costs.begin(), costs.begin() + blockLength + 1, unreachable);
+			costs[0] = 0;
+			for (std::size_t i = 0; i < blockLength; ++i)
+			{
+				const unsigned int literalCost = costs[i] + codeLengths[m_History[position + i]];
+				if (literalCost < costs[i + 1]) {
+					costs[i + 1] = literalCost;
+					steps[i + 1] = Match{ 1, 0 };
+				}
+
+				// Matches are ordered by increasing length. Each is the closest match of at least its length,
+				// so shorter lengths down to the previous match's length use the same distance.
+				std::size_t minLength = MinMatchLength;
+				for (std::size_t m = matchStarts[i]; m < matchStarts[i + 1]; ++m)
+				{
+					const auto& match = matches[m];
+					const auto encoding = GetOffsetEncoding(static_cast<unsigned int>(match.distance - 1));
+					const unsigned int offsetCost = costs[i] + 8 + encoding.extraBitCount;
+
+					for (std::size_t length = minLength; length <= match.length; ++length) {
+						const unsigned int cost = offsetCost + codeLengths[length + 253];
+						if (cost < costs[i + length]) {
+							costs[i + length] = cost;
+							steps[i + length] = Match{ length, match.distance };
+						}
+					}
+					minLength = match.length + 1;
+				}
+			}
+
+			parse.clear();
+			for (std::size_t i = blockLength; i > 0; i -= steps[i].length) {
+				parse.push_back(steps[i]);
+			}
+
+			for (auto step = parse.rbegin(); step != parse.rend(); ++step)
+			{
+				if (step->length == 1) {
+					WriteCode(m_History[position]);
+				}
+				else {
+					WriteMatch(step->length, step->distance);
+				}
+				position += step->length;
+
+				if (IsAbandoned(maxCompressedSize)) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool HuffLZEncoder::IsAbandoned(std::size_t maxCompressedSize) const
+	{
+		return m_CodeCount > MaxCodeCount || m_BitStreamWriter.GetByteCount() > maxCompressedSize;
+	}
+
+	// Searches the window for the longest string matching the data at position
+	// Returns the match length (0 if no match was found), and the distance back to the match
+	std::size_t HuffLZEncoder::FindLongestMatch(std::size_t position, std::size_t& distanceOut)
+	{
+		const std::size_t maxLength = std::min(MaxMatchLength, m_History.size() - position);
+		if (maxLength < MinMatchLength) {
+			return 0;
+		}
+
+		std::size_t bestLength = 0;
+		int candidate = m_HashHead[Hash(position)];
+
+		for (std::size_t chain = 0; candidate >= 0 && chain < MaxChainLength; ++chain)
+		{
+			const std::size_t candidatePosition = static_cast<std::size_t>(candidate);
+			const std::size_t distance = position - candidatePosition;
+			if (distance > WindowSize) {
+				break;
+			}
+
+			// Matches may overlap the current position, since the decoder copies one byte at a time
+			std::size_t length = 0;
+			while (length < maxLength && m_History[candidatePosition + length] == m_History[position + length]) {
+				++length;
+			}
+
+			if (length > bestLength) {
+				bestLength = length;
+				distanceOut = distance;
+				if (length == maxLength) {
+					break;
+				}
+			}
+
+			candidate = m_HashPrev[candidatePosition % WindowSize];
+		}
+
+		return bestLength;
+	}
+
+	// Appends the closest match of each length found, in order of increasing length (at most maxLength)
+	void HuffLZEncoder::FindMatches(std::size_t position, std::size_t maxLength, std::vector<Match>& matchesOut)
+	{
+		if (maxLength < MinMatchLength || position + MinMatchLength > m_History.size()) {
+			return;
+		}
+
+		std::size_t bestLength = MinMatchLength - 1;
+		int candidate = m_HashHead[Hash(position)];
+
+		// Candidates are visited from closest to furthest
+		for (std::size_t chain = 0; candidate >= 0 && chain < MaxChainLength; ++chain)
+		{
+			const std::size_t candidatePosition = static_cast<std::size_t>(candidate);
+			const std::size_t distance = position - candidatePosition;
+			if (distance > WindowSize) {
+				break;
+			}
+
+			std::size_t length = 0;
+			while (length < maxLength && m_History[candidatePosition + length] == m_History[position + length]) {
+				++length;
+			}
+
+			if (length > bestLength) {
+				bestLength = length;
+				matchesOut.push_back(Match{ length, distance });
+				if (length == maxLength) {
+					break;
+				}
+			}
+
+			candidate = m_HashPrev[candidatePosition % WindowSize];
+		}
+	}
+
+	void HuffLZEncoder::InsertHash(std::size_t position)
+	{
+		if (position + MinMatchLength > m_History.size()) {
+			return;
+		}
+
+		const unsigned int hash = Hash(position);
+		m_HashPrev[position % WindowSize] = m_HashHead[hash];
+		m_HashHead[hash] = static_cast<int>(position);
+	}
+
+	unsigned int HuffLZEncoder::Hash(std::size_t position) const
+	{
+		const unsigned int value = (m_History[position] << 16) | (m_History[position + 1] << 8) | m_History[position + 2];
+		return (value * 2654435761u) >> (32 - HashBits);
+	}
+
+
+	// Emits the Huffman code for the given code and updates the tree, mirroring HuffLZ::DecompressCode
+	void HuffLZEncoder::WriteCode(unsigned int code)
+	{
+		unsigned int bitCount;
+		const auto bitString = m_AdaptiveHuffmanTree.GetEncodedBitString(static_cast<AdaptiveHuffmanTree::NodeData>(code), bitCount);
+
+		// The branch from the root is stored in the LSB
+		for (unsigned int i = 0; i < bitCount; ++i) {
+			m_BitStreamWriter.WriteBit((bitString >> i) & 1);
+		}
+
+		m_AdaptiveHuffmanTree.UpdateCodeCount(static_cast<AdaptiveHuffmanTree::NodeData>(code));
+		++m_CodeCount;
+	}
+
+	void HuffLZEncoder::WriteMatch(std::size_t length, std::size_t distance)
+	{
+		WriteCode(static_cast<unsigned int>(length + 253));
+		WriteRepeatOffset(static_cast<unsigned int>(distance - 1));
+	}
+
+	// Emits a 12-bit offset (0..4095) as a variable length code (9-14 bits)
+	// This is the inverse of HuffLZ::GetRepeatOffset
+	void HuffLZEncoder::WriteRepeatOffset(unsigned int offset)
+	{
+		const auto encoding = GetOffsetEncoding(offset);
+
+		m_BitStreamWriter.WriteBits(encoding.leadingBits, 8);
+		m_BitStreamWriter.WriteBits(offset, encoding.extraBitCount);
+	}
+
+	// The upper 6 bits of the offset select a range of leading 8 bit values. The lower 6 bits
+	// of the offset are split between the end of the leading 8 bits and the extra bits.
+	HuffLZEncoder::OffsetEncoding HuffLZEncoder::GetOffsetEncoding(unsigned int offset)
+	{
+		const unsigned int upperBits = offset >> 6;
+		const unsigned int lowerBits = offset & 0x3F;
+
+		if (upperBits < 1) {
+			return { lowerBits >> 1, 1 };
+		}
+		if (upperBits < 4) {
+			return { 0x20 + ((upperBits - 1) << 4) + (lowerBits >> 2), 2 };
+		}
+		if (upperBits < 0x0C) {
+			return { 0x50 + ((upperBits - 4) << 3) + (lowerBits >> 3), 3 };
+		}
+		if (upperBits < 0x18) {
+			return { 0x90 + ((upperBits - 0x0C) << 2) + (lowerBits >> 4), 4 };
+		}
+		if (upperBits < 0x30) {
+			return { 0xC0 + ((upperBits - 0x18) << 1) + (lowerBits >> 5), 5 };
+		}
+
+		return { upperBits + 0xC0, 6 };
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+// This compressor produces data compatible with
+// the compression in .vol files. (See HuffLZ for the decompressor)
+
+#include "AdaptiveHuffmanTree.h"
+#include "BitStreamWriter.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OP2Utility::Archive
+{
+	class HuffLZEncoder
+	{
+	public:
+		// Trade off between compression time and compressed size. All levels decode with HuffLZ.
+		enum class CompressionLevel
+		{
+			Fast,		// Greedy: always take the longest match
+			Lazy,		// Emit a literal instead when the next position has a longer match
+			Optimal		// Choose the cheapest sequence of codes, priced by the adaptive Huffman tree
+		};
+
+		// Compresses data into an LZH bit stream, which HuffLZ decompresses back into the original data.
+		// Returns false if compression was abandoned, in which case compressedOut is incomplete:
+		//  - The compressed stream would be larger than maxCompressedSize
+		//  - The data needs more codes than the adaptive Huffman tree can count
+		static bool Compress(const void* data, std::size_t size, std::vector<uint8_t>& compressedOut,
+			std::size_t maxCompressedSize = SIZE_MAX, CompressionLevel level = CompressionLevel::Fast);
+
+		// Maximum number of codes in a stream before the 16 bit tree counts could overflow
+		static const std::size_t MaxCodeCount = 0xFFFF - 314 - 16;
+
+	private:
+		HuffLZEncoder(const void* data, std::size_t size);
+
+		struct Match
+		{
+			std::size_t length;
+			std::size_t distance;
+		};
+
+		bool Encode(std::size_t maxCompressedSize, CompressionLevel level);
+		bool EncodeOptimal(std::size_t maxCompressedSize);
+		std::size_t FindLongestMatch(std::size_t position, std::size_t& distanceOut);
+		void FindMatches(std::size_t position, std::size_t maxLength, std::vector<Match>& matchesOut);
+		bool IsAbandoned(std::size_t maxCompressedSize) const;
+		void InsertHash(std::size_t position);
+		unsigned int Hash(std::size_t position) const;
+
+		void WriteCode(unsigned int code);
+		void WriteRepeatOffset(unsigned int offset);
+		void WriteMatch(std::size_t length, std::size_t distance);
+
+		struct OffsetEncoding {
+			unsigned int leadingBits; // 8 bits read by the decoder to find the offset modifiers
+			unsigned int extraBitCount;
+		};
+		static OffsetEncoding GetOffsetEncoding(unsigned int offset);
+
+		// History is the initial window contents (spaces) followed by the data to compress
+		std::vector<uint8_t> m_History;
+		std::vector<int> m_HashHead;	// Most recent position with a given hash, or -1
+		std::vector<int> m_HashPrev;	// Previous position with the same hash, indexed modulo the window size
+
+		AdaptiveHuffmanTree m_AdaptiveHuffmanTree;
+		BitStreamWriter m_BitStreamWriter;
+		std::size_t m_CodeCount;
+	};
+}
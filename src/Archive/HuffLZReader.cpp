@@ -0,0 +1,189 @@
+#include "HuffLZReader.h"
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace OP2Utility::Archive
+{
+	HuffLZReader::HuffLZReader(std::unique_ptr<Stream::BidirectionalReader> compressedStream, uint64_t decompressedLength, uint64_t checkpointInterval) :
+		compressedStream(std::move(compressedStream)),
+		decompressedLength(decompressedLength),
+		position(0),
+		checkpointInterval(checkpointInterval)
+	{
+		if (!this->compressedStream) {
+			throw std::runtime_error("HuffLZReader requires a compressed stream");
+		}
+
+		if (this->compressedStream->Length() > std::numeric_limits<std::size_t>::max() / 8) {
+			throw std::runtime_error("Compressed stream is too large to decompress");
+		}
+
+		RestartDecompression();
+	}
+
+	HuffLZReader::~HuffLZReader() { }
+
+
+	std::size_t HuffLZReader::ReadPartial(void* buffer, std::size_t size) noexcept
+	{
+		auto bytesLeft = decompressedLength - position;
+		// Note: if !(size < bytesLeft) then bytesLeft fits within a size_t
+		std::size_t readSize = (size < bytesLeft) ? size : static_cast<std::size_t>(bytesLeft);
+
+		try {
+			return Decompress(static_cast<char*>(buffer), readSize);
+		}
+		catch (const std::exception&) {
+			// Decompressor state is unknown after a failure, so report no data
+			return 0;
+		}
+	}
+
+	void HuffLZReader::ReadImplementation(void* buffer, std::size_t size)
+	{
+		if (size > decompressedLength - position) {
+			throw std::runtime_error("Size of bytes to read exceeds remaining size of decompressed stream.");
+		}
+
+		auto bytesTransferred = Decompress(static_cast<char*>(buffer), size);
+
+		if (bytesTransferred < size) {
+			throw std::runtime_error("Compressed stream ended before reaching the expected decompressed length of " +
+				std::to_string(decompressedLength));
+		}
+	}
+
+
+	uint64_t HuffLZReader::Length()
+	{
+		return decompressedLength;
+	}
+
+	uint64_t HuffLZReader::Position()
+	{
+		return position;
+	}
+
+
+	void HuffLZReader::Seek(uint64_t position)
+	{
+		if (position > decompressedLength) {
+			throw std::runtime_error("Seek to absolute offset of " + std::to_string(position) + " is beyond the bounds of the decompressed stream.");
+		}
+
+		MoveTo(position);
+	}
+
+	void HuffLZReader::SeekForward(uint64_t offset)
+	{
+		if (offset > decompressedLength - position) {
+			throw std::runtime_error("Seek forward by offset of " + std::to_string(offset) + " is beyond the bounds of the decompressed stream.");
+		}
+
+		MoveTo(position + offset);
+	}
+
+	void HuffLZReader::SeekBackward(uint64_t offset)
+	{
+		if (offset > position) {
+			throw std::runtime_error("Seek backward by offset of " + std::to_string(offset) + " is beyond the bounds of the decompressed stream.");
+		}
+
+		Seek(position - offset);
+	}
+
+
+	// Decompresses up to size bytes, recording a checkpoint each time output first reaches a checkpoint position
+	std::size_t HuffLZReader::Decompress(char* buffer, std::size_t size)
+	{
+		std::size_t bytesTotal = 0;
+
+		while (bytesTotal < size)
+		{
+			std::size_t chunkSize = size - bytesTotal;
+			const uint64_t nextCheckpointPosition = (checkpoints.size() + 1) * checkpointInterval;
+			if (checkpointInterval > 0 && nextCheckpointPosition - position < chunkSize) {
+				chunkSize = static_cast<std::size_t>(nextCheckpointPosition - position);
+			}
+
+			const auto bytesTransferred = decompressor->GetData(&buffer[bytesTotal], chunkSize);
+			position += bytesTransferred;
+			bytesTotal += bytesTransferred;
+
+			if (bytesTransferred < chunkSize) {
+				break;
+			}
+			if (checkpointInterval > 0 && position == nextCheckpointPosition && position < decompressedLength) {
+				RecordCheckpoint();
+			}
+		}
+
+		return bytesTotal;
+	}
+
+	void HuffLZReader::RecordCheckpoint()
+	{
+		checkpoints.push_back(Checkpoint{ compressedStream->Position(), std::make_unique<const WordHuffLZ>(*decompressor) });
+	}
+
+	// Resumes from the closest known decoder state at or before position, then decodes up to position
+	void HuffLZReader::MoveTo(uint64_t position)
+	{
+		// Number of checkpoints at or before position
+		const std::size_t checkpointCount = (checkpointInterval == 0) ? 0 :
+			static_cast<std::size_t>(std::min<uint64_t>(position / checkpointInterval, checkpoints.size()));
+		const uint64_t checkpointPosition = checkpointCount * checkpointInterval;
+
+		if (position < this->position || checkpointPosition > this->position) {
+			if (checkpointCount > 0) {
+				RestoreCheckpoint(checkpointCount - 1);
+			}
+			else {
+				RestartDecompression();
+			}
+		}
+
+		SkipDecompressedData(position - this->position);
+	}
+
+	void HuffLZReader::RestartDecompression()
+	{
+		compressedStream->SeekBeginning();
+
+		// Cast is safe, as compressed stream length was checked during construction
+		const auto compressedLength = static_cast<std::size_t>(compressedStream->Length());
+		// Memory backed streams are decompressed in place
+		if (const auto* compressedData = compressedStream->TryGetContiguous(compressedLength)) {
+			decompressor = std::make_unique<WordHuffLZ>(WordBitStreamReader(compressedData, compressedLength));
+		}
+		else {
+			decompressor = std::make_unique<WordHuffLZ>(WordBitStreamReader(*compressedStream, compressedLength));
+		}
+		position = 0;
+	}
+
+	void HuffLZReader::RestoreCheckpoint(std::size_t checkpointIndex)
+	{
+		const auto& checkpoint = checkpoints[checkpointIndex];
+
+		// The decoder holds its own copy of the current compressed chunk, so reading continues after it
+		compressedStream->Seek(checkpoint.compressedPosition);
+		decompressor = std::make_unique<WordHuffLZ>(*checkpoint.decompressor);
+		position = (checkpointIndex + 1) * checkpointInterval;
+	}
+
+	// Decompresses and discards data, as the decompressor can not skip ahead
+	void HuffLZReader::SkipDecompressedData(uint64_t offset)
+	{
+		std::array<char, 4096> discardBuffer;
+
+		while (offset > 0) {
+			std::size_t chunkSize = (offset < discardBuffer.size()) ? static_cast<std::size_t>(offset) : discardBuffer.size();
+			ReadImplementation(discardBuffer.data(), chunkSize);
+			offset -= chunkSize;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "HuffLZ.h"
+#include "../Stream/BidirectionalReader.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace OP2Utility::Archive
+{
+	// Decompresses an LZH compressed stream as it is read.
+	// Memory use is bounded by one compressed input chunk plus the 4KB decompression window,
+	// regardless of the size of the compressed or decompressed data.
+	// Seeking forward decodes and discards data. Seeking backward restarts decompression
+	// from the beginning of the compressed stream, or from the nearest checkpoint if enabled.
+	// Checkpoints snapshot the decoder state (about 30KB each) every checkpointInterval bytes
+	// of output as it is first decoded, so later seeks only decode from the nearest checkpoint.
+	class HuffLZReader : public Stream::BidirectionalReader
+	{
+	public:
+		// compressedStream: LZH compressed data. Decompression starts from its beginning.
+		// decompressedLength: Size of the data once decompressed, reported by Length()
+		// checkpointInterval: Bytes of output between decoder checkpoints. 0 disables checkpoints.
+		HuffLZReader(std::unique_ptr<Stream::BidirectionalReader> compressedStream, uint64_t decompressedLength, uint64_t checkpointInterval = 0);
+		~HuffLZReader() override;
+
+		std::size_t ReadPartial(void* buffer, std::size_t size) noexcept override;
+
+		// BidirectionalReader methods
+		uint64_t Length() override;
+		uint64_t Position() override;
+
+		void Seek(uint64_t position) override;
+		void SeekForward(uint64_t offset) override;
+		void SeekBackward(uint64_t offset) override;
+
+	protected:
+		void ReadImplementation(void* buffer, std::size_t size) override;
+
+	private:
+		struct Checkpoint
+		{
+			uint64_t compressedPosition; // Position of compressedStream after the decoder's last chunk
+			std::unique_ptr<const WordHuffLZ> decompressor;
+		};
+
+		std::size_t Decompress(char* buffer, std::size_t size);
+		void RecordCheckpoint();
+		void MoveTo(uint64_t position);
+		void RestartDecompression();
+		void RestoreCheckpoint(std::size_t checkpointIndex);
+		void SkipDecompressedData(uint64_t offset);
+
+		std::unique_ptr<Stream::BidirectionalReader> compressedStream;
+		std::unique_ptr<WordHuffLZ> decompressor;
+		const uint64_t decompressedLength;
+		uint64_t position;
+		const uint64_t checkpointInterval;
+		std::vector<Checkpoint> checkpoints; // Checkpoint i is at position (i + 1) * checkpointInterval
+	};
+}
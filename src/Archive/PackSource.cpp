@@ -0,0 +1,140 @@
+#include "PackSource.h"
+#include "../Stream/FileReader.h"
+#include "../Stream/SharedMemoryReader.h"
+#include "../XFile.h"
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <map>
+#include <utility>
+
+namespace OP2Utility::Archive
+{
+	namespace {
+		// 64 bit FNV-1a hash of the contents
+		uint64_t HashContents(const PackSource& source)
+		{
+			auto reader = source.Open();
+			std::array<uint8_t, 64 * 1024> buffer;
+
+			uint64_t hash = 14695981039346656037ull;
+			std::size_t bytesRead;
+			while ((bytesRead = reader->ReadPartial(buffer.data(), buffer.size())) > 0) {
+				for (std::size_t i = 0; i < bytesRead; ++i) {
+					hash = (hash ^ buffer[i]) * 1099511628211ull;
+				}
+			}
+
+			return hash;
+		}
+
+		// Sources must be the same size
+		bool ContentsEqual(const PackSource& source1, const PackSource& source2)
+		{
+			auto reader1 = source1.Open();
+			auto reader2 = source2.Open();
+			std::array<uint8_t, 64 * 1024> buffer1;
+			std::array<uint8_t, 64 * 1024> buffer2;
+
+			for (uint64_t bytesLeft = source1.size; bytesLeft > 0; ) {
+				const auto chunkSize = static_cast<std::size_t>(std::min<uint64_t>(bytesLeft, buffer1.size()));
+				reader1->Read(buffer1.data(), chunkSize);
+				reader2->Read(buffer2.data(), chunkSize);
+				if (!std::equal(buffer1.begin(), buffer1.begin() + chunkSize, buffer2.begin())) {
+					return false;
+				}
+				bytesLeft -= chunkSize;
+			}
+
+			return true;
+		}
+	}
+
+	PackSource PackSource::FromFile(const std::string& path)
+	{
+		return PackSource{
+			XFile::GetFilename(path),
+			XFile::GetFileSize(path),
+			[path]() { return std::make_unique<Stream::FileReader>(path); }
+		};
+	}
+
+	std::vector<PackSource> PackSource::FromFiles(const std::vector<std::string>& paths)
+	{
+		std::vector<PackSource> sources;
+
+		for (const auto& path : paths) {
+			try {
+				sources.push_back(FromFile(path));
+			}
+			catch (const std::exception& e) {
+				throw std::runtime_error("Error attempting to find size of " + path + " for packing. Internal Error: " + e.what());
+			}
+		}
+
+		return sources;
+	}
+
+	PackSource PackSource::FromBuffer(const std::string& name, std::vector<uint8_t> contents)
+	{
+		const auto sharedContents = std::make_shared<const std::vector<uint8_t>>(std::move(contents));
+
+		return PackSource{
+			name,
+			sharedContents->size(),
+			[sharedContents]() { return std::make_unique<Stream::SharedMemoryReader>(sharedContents, sharedContents->data(), sharedContents->size()); }
+		};
+	}
+
+	std::unique_ptr<Stream::BidirectionalReader> PackSource::Open() const
+	{
+		auto reader = openReader();
+
+		if (reader->Length() != size) {
+			throw std::runtime_error("Size of " + name + " changed from " + std::to_string(size) +
+				" to " + std::to_string(reader->Length()) + " bytes after packing began");
+		}
+
+		return reader;
+	}
+
+	std::vector<std::size_t> PackSource::FindDuplicates(const std::vector<PackSource>& sources)
+	{
+		std::vector<std::size_t> duplicateOf(sources.size());
+
+		std::unordered_map<uint64_t, std::vector<std::size_t>> indexesBySize;
+		for (std::size_t i = 0; i < sources.size(); ++i) {
+			duplicateOf[i] = i;
+			indexesBySize[sources[i].size].push_back(i);
+		}
+
+		for (const auto& sizeGroup : indexesBySize)
+		{
+			const auto& indexes = sizeGroup.second;
+			if (indexes.size() < 2) {
+				continue;
+			}
+
+			// Sources with distinct contents, by hash, in index order
+			std::multimap<uint64_t, std::size_t> uniqueByHash;
+			for (const auto index : indexes)
+			{
+				const auto hash = HashContents(sources[index]);
+				const auto candidates = uniqueByHash.equal_range(hash);
+
+				auto match = std::find_if(candidates.first, candidates.second, [&](const std::pair<const uint64_t, std::size_t>& candidate) {
+					return ContentsEqual(sources[candidate.second], sources[index]);
+				});
+				if (match != candidates.second) {
+					duplicateOf[index] = match->second;
+				}
+				else {
+					uniqueByHash.emplace(hash, index);
+				}
+			}
+		}
+
+		return duplicateOf;
+	}
+}
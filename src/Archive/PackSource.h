@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../Stream/BidirectionalReader.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+namespace OP2Utility::Archive
+{
+	// A file to pack into an archive, given by name and size, with a function to open its contents.
+	// Archives are laid out from the names and sizes, and each source is only opened while it is copied,
+	// so packing many files does not hold them all open at once.
+	struct PackSource
+	{
+		using ReaderFactory = std::function<std::unique_ptr<Stream::BidirectionalReader>()>;
+
+		std::string name;
+		uint64_t size;
+		ReaderFactory openReader;
+
+		// Named after the file, without its directory. The file is not opened until it is read.
+		static PackSource FromFile(const std::string& path);
+		static std::vector<PackSource> FromFiles(const std::vector<std::string>& paths);
+		// Contents are held by the source until it is destroyed
+		static PackSource FromBuffer(const std::string& name, std::vector<uint8_t> contents);
+
+		// Opens the contents, checking they are still the expected size
+		std::unique_ptr<Stream::BidirectionalReader> Open() const;
+
+		// Returns, for each source, the index of the first source with identical contents (its own index if none).
+		// Only sources the same size as another are read. Those with matching hashes are then compared in full.
+		static std::vector<std::size_t> FindDuplicates(const std::vector<PackSource>& sources);
+	};
+}
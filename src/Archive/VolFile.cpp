@@ -1,10 +1,20 @@
 #include "VolFile.h"
-#include "../Stream/SliceReader.h"
+#include "HuffLZReader.h"
+#include "HuffLZEncoder.h"
+#include "../Stream/FileReader.h"
+#include "../Stream/MemoryMappedFile.h"
+#include "../Stream/MemoryReader.h"
+#include "../Stream/SharedMemoryReader.h"
+#include "../Stream/FileHandle.h"
+#include "../StringUtility.h"
 #include "../XFile.h"
+#include "../ParallelFor.h"
 #include <stdexcept>
 #include <algorithm>
 #include <climits>
 #include <typeinfo>
+#include <cstring>
+#include <unordered_map>
 
 namespace OP2Utility::Archive
 {
@@ -16,11 +26,15 @@ namespace OP2Utility::Archive
 	constexpr auto TagVBLK = MakeTag("VBLK"); // Packed file tag
 
 
-	VolFile::VolFile(const std::string& filename) : ArchiveFile(filename), archiveFileReader(filename)
+	VolFile::VolFile(const std::string& filename, ArchiveBackend backend, ArchiveIndexCache* indexCache) :
+		ArchiveFile(filename, backend),
+		m_StreamCheckpointInterval(0)
 	{
-		m_ArchiveFileSize = archiveFileReader.Length();
-
-		ReadVolHeader();
+		if (!ReadCachedIndex(indexCache)) {
+			ReadVolHeader(*OpenArchiveReader(0, m_ArchiveFileSize));
+			BuildNameIndex();
+			StoreCachedIndex(indexCache);
+		}
 	}
 
 	VolFile::~VolFile() { }
@@ -50,9 +64,9 @@ namespace OP2Utility::Archive
 
 
 
-	int VolFile::GetFileOffset(std::size_t index)
+	uint64_t VolFile::GetFileOffset(std::size_t index)
 	{
-		return m_IndexEntries[index].dataBlockOffset + sizeof(SectionHeader);
+		return static_cast<uint64_t>(m_IndexEntries[index].dataBlockOffset) + sizeof(SectionHeader);
 	}
 
 	int VolFile::GetFilenameOffset(std::size_t index)
@@ -60,29 +74,178 @@ namespace OP2Utility::Archive
 		return m_IndexEntries[index].filenameOffset;
 	}
 
+	// Opens a stream of the packed file's contents. LZH compressed files are decompressed as they are read,
+	// unless a decompressed entry cache is set.
 	std::unique_ptr<Stream::BidirectionalReader> VolFile::OpenStream(std::size_t index)
 	{
-		SectionHeader sectionHeader = GetSectionHeader(index);
+		VerifyIndexInBounds(index);
+
+		if (m_IndexEntries[index].compressionType == CompressionType::LZH && m_DecompressedEntryCache) {
+			auto contents = GetCachedContents(index);
+			return std::make_unique<Stream::SharedMemoryReader>(contents, contents->data(), contents->size());
+		}
 
-		return std::make_unique<Stream::FileSliceReader>(archiveFileReader.Slice(archiveFileReader.Position(), static_cast<uint64_t>(sectionHeader.length)));
+		return OpenDecompressedStream(index, OpenDataBlock(index));
 	}
 
-	VolFile::SectionHeader VolFile::GetSectionHeader(std::size_t index)
+	std::unique_ptr<Stream::BidirectionalReader> VolFile::OpenStoredStream(std::size_t index)
+	{
+		return OpenDataBlock(index);
+	}
+
+	bool VolFile::IsCompressed(std::size_t index)
+	{
+		return GetCompressionCode(index) != CompressionType::Uncompressed;
+	}
+
+	// RLE and LZ compressed files can not be decompressed
+	bool VolFile::CanDecompress(std::size_t index)
+	{
+		const auto compressionType = GetCompressionCode(index);
+		return compressionType == CompressionType::Uncompressed || compressionType == CompressionType::LZH;
+	}
+
+	// Opens a stream which decodes the packed file's data block according to its compression type
+	std::unique_ptr<Stream::BidirectionalReader> VolFile::OpenDecompressedStream(std::size_t index, std::unique_ptr<Stream::BidirectionalReader> dataBlock)
 	{
 		VerifyIndexInBounds(index);
 
-		archiveFileReader.Seek(m_IndexEntries[index].dataBlockOffset);
+		switch (m_IndexEntries[index].compressionType)
+		{
+		case CompressionType::Uncompressed:
+			return dataBlock;
+		case CompressionType::LZH:
+			return std::make_unique<HuffLZReader>(std::move(dataBlock), GetSize(index), m_StreamCheckpointInterval);
+		default:
+			throw std::runtime_error("Compression type is not supported.");
+		}
+	}
+
+	uint64_t VolFile::GetPackedDataOffset(std::size_t index)
+	{
+		return m_IndexEntries[index].dataBlockOffset;
+	}
+
+	// Decodes the data block from memory, following its section header
+	std::unique_ptr<Stream::BidirectionalReader> VolFile::OpenPackedStream(std::size_t index, const uint8_t* packedData, std::size_t availableLength)
+	{
+		if (availableLength < sizeof(SectionHeader)) {
+			return nullptr;
+		}
 
 		SectionHeader sectionHeader;
-		archiveFileReader.Read(sectionHeader);
+		std::memcpy(&sectionHeader, packedData, sizeof(sectionHeader));
+		VerifySectionHeader(sectionHeader, index);
+
+		if (sectionHeader.length > availableLength - sizeof(SectionHeader)) {
+			return nullptr;
+		}
+
+		return OpenDecompressedStream(index, std::make_unique<Stream::MemoryReader>(packedData + sizeof(SectionHeader), static_cast<std::size_t>(sectionHeader.length)));
+	}
+
+	void VolFile::ReadFile(std::size_t index, void* buffer, std::size_t bufferSize)
+	{
+		VerifyIndexInBounds(index);
+
+		if (m_IndexEntries[index].compressionType != CompressionType::LZH) {
+			ArchiveFile::ReadFile(index, buffer, bufferSize);
+			return;
+		}
+
+		VerifyBufferHoldsFile(index, bufferSize);
 
+		if (m_DecompressedEntryCache) {
+			auto contents = GetCachedContents(index);
+			std::memcpy(buffer, contents->data(), contents->size());
+			return;
+		}
+
+		DecompressInto(index, static_cast<char*>(buffer));
+	}
+
+	void VolFile::SetStreamCheckpointInterval(uint64_t checkpointInterval)
+	{
+		m_StreamCheckpointInterval = checkpointInterval;
+	}
+
+	// Decompresses a whole LZH file into buffer, which must hold GetSize(index) bytes
+	void VolFile::DecompressInto(std::size_t index, char* buffer)
+	{
+		const auto fileSize = GetSize(index);
+
+		std::size_t decompressedSize;
+		if (m_MappedFile) {
+			// Decompress straight from the mapped archive
+			const auto blockLength = GetSectionHeader(index).length;
+			WordHuffLZ decompressor(WordBitStreamReader(GetMappedData(GetFileOffset(index), blockLength), blockLength));
+			decompressedSize = decompressor.DecompressInto(buffer, fileSize);
+		}
+		else {
+			auto slice = OpenDataBlock(index);
+			WordHuffLZ decompressor(WordBitStreamReader(*slice, static_cast<std::size_t>(slice->Length())));
+			decompressedSize = decompressor.DecompressInto(buffer, fileSize);
+		}
+
+		if (decompressedSize != fileSize) {
+			throw std::runtime_error("Compressed data for " + GetName(index) + " in archive " + m_ArchiveFilename +
+				" ended before reaching the expected decompressed length of " + std::to_string(fileSize));
+		}
+	}
+
+	DecompressedEntryCache::Contents VolFile::GetCachedContents(std::size_t index)
+	{
+		return m_DecompressedEntryCache->GetOrLoad(*this, index, [this, index]() {
+			std::vector<uint8_t> contents(GetSize(index));
+			DecompressInto(index, reinterpret_cast<char*>(contents.data()));
+			return contents;
+		});
+	}
+
+	ArchiveFile::FileView VolFile::GetFileView(std::size_t index)
+	{
+		VerifyIndexInBounds(index);
+
+		if (!m_MappedFile || m_IndexEntries[index].compressionType != CompressionType::Uncompressed) {
+			return ArchiveFile::GetFileView(index);
+		}
+
+		const auto blockLength = GetSectionHeader(index).length;
+		return FileView{ GetMappedData(GetFileOffset(index), blockLength), blockLength };
+	}
+
+	// Returns an independent stream of a packed file's (possibly compressed) data block.
+	// Safe to call concurrently. Memory mapped archives return a view of the mapping.
+	std::unique_ptr<Stream::BidirectionalReader> VolFile::OpenDataBlock(std::size_t index)
+	{
+		return OpenArchiveReader(GetFileOffset(index), GetSectionHeader(index).length);
+	}
+
+	// Safe to call concurrently: the header is read positionally, without a shared file position
+	VolFile::SectionHeader VolFile::GetSectionHeader(std::size_t index)
+	{
+		VerifyIndexInBounds(index);
+
+		SectionHeader sectionHeader;
+		if (m_MappedFile) {
+			std::memcpy(&sectionHeader, GetMappedData(m_IndexEntries[index].dataBlockOffset, sizeof(sectionHeader)), sizeof(sectionHeader));
+		}
+		else {
+			m_FileHandle->ReadExactAt(m_IndexEntries[index].dataBlockOffset, &sectionHeader, sizeof(sectionHeader));
+		}
+
+		VerifySectionHeader(sectionHeader, index);
+
+		return sectionHeader;
+	}
+
+	void VolFile::VerifySectionHeader(const SectionHeader& sectionHeader, std::size_t index)
+	{
 		//Volume Block
 		if (sectionHeader.tag != TagVBLK) {
 			throw std::runtime_error("Archive file " + m_ArchiveFilename +
 				" is missing VBLK tag for requested file at index " + std::to_string(index));
 		}
-
-		return sectionHeader;
 	}
 
 	// Extracts the internal file at the given index to the filename.
@@ -108,11 +271,10 @@ namespace OP2Utility::Archive
 	{
 		try
 		{
-			// Calling GetSectionHeader moves the streamReader's position to just past the SectionHeader
-			SectionHeader sectionHeader = GetSectionHeader(index);
-			auto slice = archiveFileReader.Slice(sectionHeader.length);
+			auto slice = OpenDataBlock(index);
 			Stream::FileWriter fileStreamWriter(pathOut);
-			fileStreamWriter.Write(slice);
+			fileStreamWriter.Write(*slice);
+			fileStreamWriter.Flush();
 		}
 		catch (const std::exception& e)
 		{
@@ -124,23 +286,12 @@ namespace OP2Utility::Archive
 	{
 		try
 		{
-			// Calling GetSectionHeader moves the streamReader's position to just past the SectionHeader
-			SectionHeader sectionHeader = GetSectionHeader(index);
-
-			// Load data into temporary memory buffer
-			std::size_t length = sectionHeader.length;
-			std::vector<uint8_t> buffer(length);
-			archiveFileReader.Read(buffer);
-
-			HuffLZ decompressor(BitStreamReader(buffer.data(), length));
+			// Data is decompressed as it is copied, without buffering the whole file
+			auto decompressedStream = OpenStream(index);
 
 			Stream::FileWriter fileStreamWriter(pathOut);
-
-			do
-			{
-				const void *buffer = decompressor.GetInternalBuffer(&length);
-				fileStreamWriter.Write(buffer, length);
-			} while (length);
+			fileStreamWriter.Write(*decompressedStream);
+			fileStreamWriter.Flush();
 		}
 		catch (const std::exception& e)
 		{
@@ -150,54 +301,382 @@ namespace OP2Utility::Archive
 
 
 
-	void VolFile::CreateArchive(const std::string& volumeFilename, std::vector<std::string> filesToPack)
+	void VolFile::CreateArchive(const std::string& volumeFilename, std::vector<std::string> filesToPack, CompressionType compressionType,
+		HuffLZEncoder::CompressionLevel compressionLevel, std::size_t threadCount, bool deduplicate)
 	{
+		VerifyVolumeNotPacked(volumeFilename, filesToPack);
+
+		CreateArchiveFromSources(volumeFilename, PackSource::FromFiles(filesToPack), compressionType, compressionLevel, threadCount, deduplicate);
+	}
+
+	void VolFile::CreateArchiveFromSources(const std::string& volumeFilename, std::vector<PackSource> sources, CompressionType compressionType,
+		HuffLZEncoder::CompressionLevel compressionLevel, std::size_t threadCount, bool deduplicate)
+	{
+		if (compressionType != CompressionType::Uncompressed && compressionType != CompressionType::LZH) {
+			throw std::runtime_error("Volume " + volumeFilename + " can only be created uncompressed or with LZH compression");
+		}
+
 		// Sort files alphabetically based on the filename only (not including the full path).
 		// Packed files must be locatable by a binary search of their filename.
-		std::sort(filesToPack.begin(), filesToPack.end(), ComparePathFilenames);
+		SortPackSources(sources);
 
 		CreateVolumeInfo volInfo;
 
-		volInfo.filesToPack = filesToPack;
-		volInfo.names = GetNamesFromPaths(filesToPack);
+		for (const auto& source : sources) {
+			volInfo.names.push_back(source.name);
+		}
+		volInfo.sources = std::move(sources);
+		volInfo.compressionType = compressionType;
+		volInfo.compressionLevel = compressionLevel;
 
 		// Allowing duplicate names when packing may cause unintended results during binary search and file extraction.
 		VerifySortedContainerHasNoDuplicateNames(volInfo.names);
 
-		// Open input files and prepare header and indexing info
+		if (deduplicate) {
+			volInfo.dataBlockSources = PackSource::FindDuplicates(volInfo.sources);
+		}
+
+		// Prepare header and indexing info from the file sizes
 		PrepareHeader(volInfo, volumeFilename);
 
-		WriteVolume(volumeFilename, volInfo);
+		WriteVolume(volumeFilename, volInfo, threadCount);
 	}
 
-	void VolFile::WriteVolume(const std::string& filename, CreateVolumeInfo& volInfo)
+	void VolFile::VerifyVolumeNotPacked(const std::string& volumeFilename, const std::vector<std::string>& filesToPack)
 	{
-		for (const auto& path : volInfo.filesToPack) {
-			if (XFile::PathsAreEqual(filename, path)) {
-				throw std::runtime_error("Cannot include a volume being overwritten in new volume " + filename);
+		for (const auto& path : filesToPack) {
+			if (XFile::PathsAreEqual(volumeFilename, path)) {
+				throw std::runtime_error("Cannot include a volume being written in itself " + volumeFilename);
 			}
 		}
+	}
 
+	void VolFile::WriteVolume(const std::string& filename, CreateVolumeInfo& volInfo, std::size_t threadCount)
+	{
 		Stream::FileWriter volWriter(filename);
 
+		// Compressed sizes, and so data block offsets, are only known once files are written.
+		// The header size does not depend on them, so the header is written again afterwards.
+		WriteHeader(volWriter, volInfo);
+		if (volInfo.compressionType == CompressionType::LZH) {
+			WriteCompressedFiles(volWriter, volInfo, threadCount);
+		}
+		else {
+			WriteFiles(volWriter, volInfo);
+		}
+
+		volWriter.Seek(0);
 		WriteHeader(volWriter, volInfo);
-		WriteFiles(volWriter, volInfo);
+		volWriter.Flush();
+	}
+
+	void VolFile::UpdateArchive(const std::string& volumeFilename, std::vector<std::string> filesToPack, const std::vector<std::string>& namesToRemove,
+		CompressionType compressionType, HuffLZEncoder::CompressionLevel compressionLevel)
+	{
+		VerifyVolumeNotPacked(volumeFilename, filesToPack);
+
+		UpdateArchiveFromSources(volumeFilename, PackSource::FromFiles(filesToPack), namesToRemove, compressionType, compressionLevel);
+	}
+
+	void VolFile::UpdateArchiveFromSources(const std::string& volumeFilename, std::vector<PackSource> sources, const std::vector<std::string>& namesToRemove,
+		CompressionType compressionType, HuffLZEncoder::CompressionLevel compressionLevel)
+	{
+		if (compressionType != CompressionType::Uncompressed && compressionType != CompressionType::LZH) {
+			throw std::runtime_error("Volume " + volumeFilename + " can only be updated uncompressed or with LZH compression");
+		}
+
+		SortPackSources(sources);
+		std::vector<std::string> names;
+		for (const auto& source : sources) {
+			names.push_back(source.name);
+		}
+		VerifySortedContainerHasNoDuplicateNames(names);
+
+		std::vector<UpdateEntry> entries;
+		CreateVolumeInfo volInfo;
+		std::vector<FreeRange> freeRanges;
+		uint64_t volumeEnd;
+		{
+			VolFile volume(volumeFilename);
+
+			entries = volume.GetUpdateEntries();
+			RemoveUpdateEntries(entries, namesToRemove, volumeFilename);
+			AddUpdateEntries(entries, std::move(sources));
+
+			// Packed files must remain locatable by a binary search of their filename
+			std::sort(entries.begin(), entries.end(), [](const UpdateEntry& entry1, const UpdateEntry& entry2) {
+				return ComparePathFilenames(entry1.name, entry2.name);
+			});
+
+			for (const auto& entry : entries) {
+				volInfo.names.push_back(entry.name);
+				volInfo.indexEntries.push_back(entry.indexEntry);
+			}
+			PrepareTables(volInfo, volumeFilename);
+
+			volumeEnd = FindFreeRanges(entries, GetHeaderLength(volInfo), freeRanges);
+
+			// Blocks in the way of a larger header are read before anything is written
+			for (auto& entry : entries) {
+				if (entry.relocate) {
+					auto slice = volume.OpenDataBlock(entry.index);
+					entry.relocatedData.resize(static_cast<std::size_t>(slice->Length()));
+					slice->Read(entry.relocatedData);
+				}
+			}
+		}
+
+		{
+			Stream::FileWriter volWriter(volumeFilename, Stream::FileWriter::OpenMode::CanOpenExisting);
+
+			for (std::size_t i = 0; i < entries.size(); ++i) {
+				WriteUpdatedBlock(volWriter, entries[i], volInfo.indexEntries[i], freeRanges, volumeEnd, compressionType, compressionLevel);
+			}
+
+			volWriter.Seek(0);
+			WriteHeader(volWriter, volInfo);
+			volWriter.Flush();
+		}
+
+		// Drop unused space at the end of the volume
+		XFile::ResizeFile(volumeFilename, volumeEnd);
+	}
+
+	void VolFile::CompactArchive(const std::string& volumeFilename)
+	{
+		const auto compactFilename = XFile::AppendToFilename(volumeFilename, ".compact");
+		{
+			VolFile volume(volumeFilename);
+
+			CreateVolumeInfo volInfo;
+			for (std::size_t i = 0; i < volume.GetCount(); ++i) {
+				volInfo.names.push_back(volume.m_StringTable[i]);
+				volInfo.indexEntries.push_back(volume.m_IndexEntries[i]);
+			}
+			PrepareTables(volInfo, volumeFilename);
+
+			Stream::FileWriter volWriter(compactFilename);
+			WriteHeader(volWriter, volInfo);
+
+			// Copy data blocks as is, without decompressing them
+			uint64_t dataBlockOffset = GetHeaderLength(volInfo);
+			std::unordered_map<uint32_t, uint32_t> compactedOffsets; // Original offset to new offset of each data block
+			for (std::size_t i = 0; i < volInfo.fileCount(); ++i)
+			{
+				auto compactedOffset = compactedOffsets.find(volume.m_IndexEntries[i].dataBlockOffset);
+				if (compactedOffset != compactedOffsets.end()) {
+					volInfo.indexEntries[i].dataBlockOffset = compactedOffset->second;
+					continue;
+				}
+
+				if (dataBlockOffset > UINT32_MAX) {
+					throw std::runtime_error("Unable to compact volume " + volumeFilename + ". Volume is too large.");
+				}
+				volInfo.indexEntries[i].dataBlockOffset = static_cast<uint32_t>(dataBlockOffset);
+				compactedOffsets.emplace(volume.m_IndexEntries[i].dataBlockOffset, volInfo.indexEntries[i].dataBlockOffset);
+
+				auto slice = volume.OpenDataBlock(i);
+				const auto blockLength = static_cast<uint32_t>(slice->Length());
+				volWriter.Write(SectionHeader(TagVBLK, blockLength));
+				volWriter.Write(*slice);
+				WriteBlockPadding(volWriter, blockLength);
+
+				dataBlockOffset += GetBlockSpan(blockLength);
+			}
+
+			volWriter.Seek(0);
+			WriteHeader(volWriter, volInfo);
+			volWriter.Flush();
+		}
+
+		XFile::RenameFile(compactFilename, volumeFilename);
+	}
+
+	std::vector<VolFile::UpdateEntry> VolFile::GetUpdateEntries()
+	{
+		std::vector<UpdateEntry> entries;
+
+		for (std::size_t i = 0; i < GetCount(); ++i) {
+			entries.push_back(UpdateEntry{ m_StringTable[i], m_IndexEntries[i], i, GetSectionHeader(i).length, PackSource(), false, {} });
+		}
+
+		return entries;
+	}
+
+	void VolFile::RemoveUpdateEntries(std::vector<UpdateEntry>& entries, const std::vector<std::string>& namesToRemove, const std::string& volumeFilename)
+	{
+		for (const auto& name : namesToRemove)
+		{
+			const auto upperName = StringUtility::ConvertToUpper(name);
+			const auto entry = std::find_if(entries.begin(), entries.end(), [&upperName](const UpdateEntry& entry) {
+				return StringUtility::ConvertToUpper(entry.name) == upperName;
+			});
+
+			if (entry == entries.end()) {
+				throw std::runtime_error("Unable to remove " + name + ". It is not contained in volume " + volumeFilename);
+			}
+
+			entries.erase(entry);
+		}
+	}
+
+	// Sources replace existing entries of the same name, or are added as new entries
+	void VolFile::AddUpdateEntries(std::vector<UpdateEntry>& entries, std::vector<PackSource> sources)
+	{
+		for (auto& source : sources)
+		{
+			const auto upperName = StringUtility::ConvertToUpper(source.name);
+			auto entry = std::find_if(entries.begin(), entries.end(), [&upperName](const UpdateEntry& entry) {
+				return StringUtility::ConvertToUpper(entry.name) == upperName;
+			});
+
+			if (entry == entries.end()) {
+				entries.push_back(UpdateEntry{ source.name, IndexEntry(), 0, 0, std::move(source), false, {} });
+			}
+			else {
+				entry->name = source.name;
+				entry->source = std::move(source);
+			}
+		}
+	}
+
+	// Finds the unused space between kept data blocks, from the end of the header to the last kept block.
+	// Kept blocks which overlap the header are marked for relocation. Returns the end of the last kept block.
+	uint64_t VolFile::FindFreeRanges(std::vector<UpdateEntry>& entries, uint64_t headerLength, std::vector<FreeRange>& freeRanges)
+	{
+		std::vector<const UpdateEntry*> keptEntries;
+		for (auto& entry : entries)
+		{
+			if (entry.source.openReader) {
+				continue;
+			}
+
+			entry.relocate = (entry.indexEntry.dataBlockOffset < headerLength);
+			if (!entry.relocate) {
+				keptEntries.push_back(&entry);
+			}
+		}
+
+		std::sort(keptEntries.begin(), keptEntries.end(), [](const UpdateEntry* entry1, const UpdateEntry* entry2) {
+			return entry1->indexEntry.dataBlockOffset < entry2->indexEntry.dataBlockOffset;
+		});
+
+		freeRanges.clear();
+		uint64_t freeOffset = headerLength;
+		for (const auto* entry : keptEntries)
+		{
+			const uint64_t blockOffset = entry->indexEntry.dataBlockOffset;
+			if (blockOffset > freeOffset) {
+				freeRanges.push_back(FreeRange{ freeOffset, blockOffset - freeOffset });
+			}
+
+			freeOffset = std::max(freeOffset, blockOffset + GetBlockSpan(entry->blockLength));
+		}
+
+		return freeOffset;
+	}
+
+	// Returns the offset for a block, taken from the first large enough free range, or else the end of the volume
+	uint32_t VolFile::AllocateBlock(std::vector<FreeRange>& freeRanges, uint64_t& volumeEnd, uint64_t blockSpan)
+	{
+		uint64_t offset;
+
+		const auto freeRange = std::find_if(freeRanges.begin(), freeRanges.end(), [blockSpan](const FreeRange& range) {
+			return range.length >= blockSpan;
+		});
+
+		if (freeRange != freeRanges.end()) {
+			offset = freeRange->offset;
+			freeRange->offset += blockSpan;
+			freeRange->length -= blockSpan;
+		}
+		else {
+			offset = volumeEnd;
+			volumeEnd += blockSpan;
+		}
+
+		if (offset > UINT32_MAX) {
+			throw std::runtime_error("Volume is too large.");
+		}
+
+		return static_cast<uint32_t>(offset);
+	}
+
+	// Writes the data block of a new, replaced or relocated entry, and sets its index entry to match
+	void VolFile::WriteUpdatedBlock(Stream::BidirectionalWriter& volWriter, UpdateEntry& entry, IndexEntry& indexEntry,
+		std::vector<FreeRange>& freeRanges, uint64_t& volumeEnd, CompressionType compressionType, HuffLZEncoder::CompressionLevel compressionLevel)
+	{
+		try {
+			if (entry.relocate)
+			{
+				const auto blockLength = static_cast<uint32_t>(entry.relocatedData.size());
+				indexEntry.dataBlockOffset = AllocateBlock(freeRanges, volumeEnd, GetBlockSpan(blockLength));
+
+				volWriter.Seek(indexEntry.dataBlockOffset);
+				WriteBlock(volWriter, entry.relocatedData);
+				WriteBlockPadding(volWriter, blockLength);
+			}
+			else if (entry.source.openReader)
+			{
+				auto fileReader = entry.source.Open();
+
+				const uint64_t fileSize = entry.source.size;
+				if (fileSize > UINT32_MAX) {
+					throw std::runtime_error("File is too large to fit inside a volume archive");
+				}
+				indexEntry.fileSize = static_cast<uint32_t>(fileSize);
+
+				uint32_t blockLength;
+				if (compressionType == CompressionType::LZH)
+				{
+					// The block length is only known once compressed
+					const auto blockData = CompressBlock(indexEntry, *fileReader, compressionLevel);
+					blockLength = static_cast<uint32_t>(blockData.size());
+					indexEntry.dataBlockOffset = AllocateBlock(freeRanges, volumeEnd, GetBlockSpan(blockLength));
+
+					volWriter.Seek(indexEntry.dataBlockOffset);
+					WriteBlock(volWriter, blockData);
+				}
+				else
+				{
+					blockLength = indexEntry.fileSize;
+					indexEntry.dataBlockOffset = AllocateBlock(freeRanges, volumeEnd, GetBlockSpan(blockLength));
+
+					volWriter.Seek(indexEntry.dataBlockOffset);
+					WriteUncompressedBlock(volWriter, indexEntry, *fileReader);
+				}
+
+				WriteBlockPadding(volWriter, blockLength);
+			}
+		}
+		catch (const std::exception& e) {
+			throw std::runtime_error("Unable to pack file " + entry.name + ". Internal error: " + e.what());
+		}
 	}
 
 	void VolFile::WriteFiles(Stream::Writer& volWriter, CreateVolumeInfo &volInfo)
 	{
+		uint64_t dataBlockOffset = GetHeaderLength(volInfo);
+
 		// Write each file header and contents
 		for (std::size_t i = 0; i < volInfo.fileCount(); ++i)
 		{
-			volWriter.Write(SectionHeader(TagVBLK, volInfo.indexEntries[i].fileSize));
+			if (volInfo.SharesDataBlock(i)) {
+				ShareDataBlock(volInfo, i);
+				continue;
+			}
+
+			auto& indexEntry = volInfo.indexEntries[i];
+			SetDataBlockOffset(indexEntry, dataBlockOffset, volInfo.names[i]);
 
 			try {
-				volWriter.Write(*volInfo.fileStreamReaders[i]);
-				int padding = 0;
+				// Only the file being packed is open
+				auto fileReader = volInfo.sources[i].Open();
+				uint32_t blockLength = WriteUncompressedBlock(volWriter, indexEntry, *fileReader);
+
+				WriteBlockPadding(volWriter, blockLength);
 
-				// Add padding after the file, ensuring it ends on a 4 byte boundary
-				// Use a bitmask to quickly calculate the modulo 4 (remainder) of fileSize
-				volWriter.Write(&padding, (-volInfo.indexEntries[i].fileSize) & 3);
+				dataBlockOffset += GetBlockSpan(blockLength);
 			}
 			catch (const std::exception& e) {
 				throw std::runtime_error("Unable to pack file " + volInfo.names[i] + ". Internal error: " + e.what());
@@ -205,6 +684,120 @@ namespace OP2Utility::Archive
 		}
 	}
 
+	// Files are compressed concurrently, and each is written as soon as all files before it are written.
+	// Compressed blocks are freed once written, so memory use is bounded by the number of pending files, not the volume size.
+	void VolFile::WriteCompressedFiles(Stream::Writer& volWriter, CreateVolumeInfo &volInfo, std::size_t threadCount)
+	{
+		if (threadCount == 0) {
+			threadCount = HardwareThreadCount();
+		}
+
+		uint64_t dataBlockOffset = GetHeaderLength(volInfo);
+		std::vector<std::vector<uint8_t>> blocks(volInfo.fileCount());
+
+		// Allow each thread to work ahead while earlier files wait to be written
+		ParallelOrderedFor(volInfo.fileCount(), threadCount, 2 * threadCount,
+			[&](std::size_t i) {
+				if (volInfo.SharesDataBlock(i)) {
+					return;
+				}
+
+				try {
+					// Only files being compressed are open
+					auto fileReader = volInfo.sources[i].Open();
+					blocks[i] = CompressBlock(volInfo.indexEntries[i], *fileReader, volInfo.compressionLevel);
+				}
+				catch (const std::exception& e) {
+					throw std::runtime_error("Unable to pack file " + volInfo.names[i] + ". Internal error: " + e.what());
+				}
+			},
+			[&](std::size_t i) {
+				if (volInfo.SharesDataBlock(i)) {
+					ShareDataBlock(volInfo, i);
+					return;
+				}
+
+				SetDataBlockOffset(volInfo.indexEntries[i], dataBlockOffset, volInfo.names[i]);
+
+				WriteBlock(volWriter, blocks[i]);
+				const auto blockLength = static_cast<uint32_t>(blocks[i].size());
+				WriteBlockPadding(volWriter, blockLength);
+
+				dataBlockOffset += GetBlockSpan(blockLength);
+				std::vector<uint8_t>().swap(blocks[i]);
+			});
+	}
+
+	void VolFile::SetDataBlockOffset(IndexEntry& indexEntry, uint64_t dataBlockOffset, const std::string& name)
+	{
+		if (dataBlockOffset > UINT32_MAX) {
+			throw std::runtime_error("Unable to pack file " + name + ". Volume is too large.");
+		}
+		indexEntry.dataBlockOffset = static_cast<uint32_t>(dataBlockOffset);
+	}
+
+	// Points the index entry at the data block already written for an earlier file with identical contents
+	void VolFile::ShareDataBlock(CreateVolumeInfo &volInfo, std::size_t index)
+	{
+		const auto& sourceEntry = volInfo.indexEntries[volInfo.dataBlockSources[index]];
+
+		volInfo.indexEntries[index].dataBlockOffset = sourceEntry.dataBlockOffset;
+		volInfo.indexEntries[index].compressionType = sourceEntry.compressionType;
+	}
+
+	// Add padding after a block, ensuring it ends on a 4 byte boundary
+	void VolFile::WriteBlockPadding(Stream::Writer& volWriter, uint32_t blockLength)
+	{
+		int padding = 0;
+
+		// Use a bitmask to quickly calculate the modulo 4 (remainder) of blockLength
+		volWriter.Write(&padding, (-blockLength) & 3);
+	}
+
+	// Returns the space taken by a block, including its section header and padding
+	uint64_t VolFile::GetBlockSpan(uint64_t blockLength)
+	{
+		return (sizeof(SectionHeader) + blockLength + 3) & ~uint64_t(3);
+	}
+
+	// Returns the length of the written block, excluding the section header
+	uint32_t VolFile::WriteUncompressedBlock(Stream::Writer& volWriter, IndexEntry& indexEntry, Stream::BidirectionalReader& fileReader)
+	{
+		indexEntry.compressionType = CompressionType::Uncompressed;
+
+		const auto blockLength = static_cast<uint32_t>(indexEntry.fileSize);
+		volWriter.Write(SectionHeader(TagVBLK, blockLength));
+		volWriter.Write(fileReader);
+
+		return blockLength;
+	}
+
+	// Returns the data block contents, and sets the compression type to match
+	// Files which do not get smaller when compressed are stored uncompressed
+	std::vector<uint8_t> VolFile::CompressBlock(IndexEntry& indexEntry, Stream::BidirectionalReader& fileReader, HuffLZEncoder::CompressionLevel compressionLevel)
+	{
+		std::vector<uint8_t> buffer(static_cast<uint32_t>(indexEntry.fileSize));
+		fileReader.Read(buffer);
+
+		std::vector<uint8_t> compressedBuffer;
+		if (buffer.size() > 0 && HuffLZEncoder::Compress(buffer.data(), buffer.size(), compressedBuffer, buffer.size() - 1, compressionLevel)) {
+			indexEntry.compressionType = CompressionType::LZH;
+		}
+		else {
+			indexEntry.compressionType = CompressionType::Uncompressed;
+			compressedBuffer.swap(buffer);
+		}
+
+		return compressedBuffer;
+	}
+
+	void VolFile::WriteBlock(Stream::Writer& volWriter, const std::vector<uint8_t>& blockData)
+	{
+		// Block size is bounded by the file size, which fits in 32 bits
+		volWriter.Write(SectionHeader(TagVBLK, static_cast<uint32_t>(blockData.size())));
+		volWriter.Write(blockData);
+	}
+
 	void VolFile::WriteHeader(Stream::Writer& volWriter, const CreateVolumeInfo &volInfo)
 	{
 		// Write the header
@@ -234,43 +827,51 @@ namespace OP2Utility::Archive
 		volWriter.Write(&padding, volInfo.paddedIndexTableLength - volInfo.indexTableLength);
 	}
 
-	void VolFile::OpenAllInputFiles(CreateVolumeInfo &volInfo, const std::string& volumeFilename)
+	// Returns the offset of the first data block
+	uint64_t VolFile::GetHeaderLength(const CreateVolumeInfo &volInfo)
 	{
-		volInfo.fileStreamReaders.clear();
+		return static_cast<uint64_t>(volInfo.paddedStringTableLength) + volInfo.paddedIndexTableLength + 32;
+	}
 
-		for (const auto& filename : volInfo.filesToPack) {
-			try {
-				volInfo.fileStreamReaders.push_back(std::make_unique<Stream::FileReader>(filename));
-			}
-			catch (const std::exception& e) {
-				throw std::runtime_error("Error attempting to open " + filename +
-					" for reading into volume " + volumeFilename + ". Internal Error: " + e.what());
-			}
-		}
+	void VolFile::SortPackSources(std::vector<PackSource>& sources)
+	{
+		std::sort(sources.begin(), sources.end(), [](const PackSource& source1, const PackSource& source2) {
+			return ComparePathFilenames(source1.name, source2.name);
+		});
 	}
 
 	void VolFile::PrepareHeader(CreateVolumeInfo &volInfo, const std::string& volumeFilename)
 	{
-		OpenAllInputFiles(volInfo, volumeFilename);
-
-		volInfo.stringTableLength = 0;
-
-		// Get file sizes and calculate length of string table
+		// Get file sizes
 		for (std::size_t i = 0; i < volInfo.fileCount(); ++i)
 		{
 			IndexEntry indexEntry;
 
-			uint64_t fileSize = volInfo.fileStreamReaders[i]->Length();
+			uint64_t fileSize = volInfo.sources[i].size;
 			if (fileSize > UINT32_MAX) {
-				throw std::runtime_error("File " + volInfo.filesToPack[i] +
+				throw std::runtime_error("File " + volInfo.names[i] +
 					" is too large to fit inside a volume archive. Writing volume " + volumeFilename + " aborted.");
 			}
 
 			indexEntry.fileSize = static_cast<uint32_t>(fileSize);
-			indexEntry.filenameOffset = volInfo.stringTableLength;
+			indexEntry.dataBlockOffset = 0; // Set once the data block is written
 			indexEntry.compressionType = CompressionType::Uncompressed;
 
 			volInfo.indexEntries.push_back(indexEntry);
+		}
+
+		PrepareTables(volInfo, volumeFilename);
+	}
+
+	// Sets filename offsets of volInfo.indexEntries from volInfo.names, and calculates the table lengths
+	void VolFile::PrepareTables(CreateVolumeInfo &volInfo, const std::string& volumeFilename)
+	{
+		volInfo.stringTableLength = 0;
+
+		// Calculate length of string table
+		for (std::size_t i = 0; i < volInfo.fileCount(); ++i)
+		{
+			volInfo.indexEntries[i].filenameOffset = volInfo.stringTableLength;
 
 			// Add length of internal filename plus null terminator to string table length.
 			if (static_cast<uint64_t>(volInfo.stringTableLength) + volInfo.names[i].size() + 1 > UINT32_MAX) {
@@ -289,27 +890,14 @@ namespace OP2Utility::Archive
 		// Calculate the zero padded length of the string table and index table
 		volInfo.paddedStringTableLength = (volInfo.stringTableLength + 7) & ~3;
 		volInfo.paddedIndexTableLength = (volInfo.indexTableLength + 3) & ~3;
-
-		if (volInfo.indexEntries.size() == 0) {
-			return;
-		}
-
-		volInfo.indexEntries[0].dataBlockOffset = volInfo.paddedStringTableLength + volInfo.paddedIndexTableLength + 32;
-
-		// Calculate offsets to the files
-		for (std::size_t i = 1; i < volInfo.fileCount(); ++i)
-		{
-			const IndexEntry& previousIndex = volInfo.indexEntries[i - 1];
-			volInfo.indexEntries[i].dataBlockOffset = (previousIndex.dataBlockOffset + previousIndex.fileSize + 11) & ~3;
-		}
 	}
 
 	// Reads a tag in the .vol file and returns the length of that section.
 	// If tag does not match what is in the file or if the length is invalid then an error is thrown.
-	uint32_t VolFile::ReadTag(Tag tagName)
+	uint32_t VolFile::ReadTag(Stream::BidirectionalReader& volumeReader, Tag tagName)
 	{
 		SectionHeader tag;
-		archiveFileReader.Read(tag);
+		volumeReader.Read(tag);
 
 		if (tag.tag != tagName) {
 			throw std::runtime_error("The tag " + tagName +
@@ -327,39 +915,39 @@ namespace OP2Utility::Archive
 
 	// Reads the header structure of the .vol file and sets up indexing/structure variables
 	// Returns true is the header structure is valid and false otherwise
-	void VolFile::ReadVolHeader()
+	void VolFile::ReadVolHeader(Stream::BidirectionalReader& volumeReader)
 	{
 		// Make sure file is big enough to contain header tag
-		if (archiveFileReader.Length() < sizeof(SectionHeader)) {
+		if (volumeReader.Length() < sizeof(SectionHeader)) {
 			throw std::runtime_error("The volume file " + m_ArchiveFilename + " is not large enough to contain the 'VOL ' section header");
 		}
 
-		m_HeaderLength = ReadTag(TagVOL_);
+		m_HeaderLength = ReadTag(volumeReader, TagVOL_);
 
 		// Make sure the file is large enough to contain the header
-		if (archiveFileReader.Length() < m_HeaderLength + sizeof(SectionHeader)) {
+		if (volumeReader.Length() < m_HeaderLength + sizeof(SectionHeader)) {
 			throw std::runtime_error("The volume file " + m_ArchiveFilename + " is not large enough to contain the volh section header");
 		}
 
-		uint32_t volhSize = ReadTag(TagVOLH);
+		uint32_t volhSize = ReadTag(volumeReader, TagVOLH);
 		if (volhSize != 0) {
 			throw std::runtime_error("The length associated with tag volh is not zero in volume " + m_ArchiveFilename);
 		}
 
-		m_StringTableLength = ReadTag(TagVOLS);
+		m_StringTableLength = ReadTag(volumeReader, TagVOLS);
 
 		if (m_HeaderLength < m_StringTableLength + sizeof(SectionHeader) * 2 + sizeof(m_StringTableLength)) {
 			throw std::runtime_error("The string table does not fit in the header of volume " + m_ArchiveFilename);
 		}
 
-		ReadStringTable();
+		ReadStringTable(volumeReader);
 
-		m_IndexTableLength = ReadTag(TagVOLI);
+		m_IndexTableLength = ReadTag(volumeReader, TagVOLI);
 		m_IndexEntryCount = m_IndexTableLength / sizeof(IndexEntry);
 
+		m_IndexEntries.resize(m_IndexEntryCount);
 		if (m_IndexTableLength > 0) {
-			m_IndexEntries.resize(m_IndexEntryCount);
-			archiveFileReader.Read(m_IndexEntries.data(), m_IndexTableLength);
+			volumeReader.Read(m_IndexEntries.data(), m_IndexTableLength);
 		}
 
 		if (m_HeaderLength < m_StringTableLength + m_IndexTableLength + 24) {
@@ -369,30 +957,65 @@ namespace OP2Utility::Archive
 		CountValidEntries();
 	}
 
-	void VolFile::ReadStringTable()
+	void VolFile::ReadStringTable(Stream::BidirectionalReader& volumeReader)
 	{
 		uint32_t actualStringTableLength;
-		archiveFileReader.Read(actualStringTableLength);
+		volumeReader.Read(actualStringTableLength);
 
 		std::string charBuffer;
 		charBuffer.resize(actualStringTableLength);
-		archiveFileReader.Read(charBuffer);
+		volumeReader.Read(charBuffer);
 
-		m_StringTable.push_back("");
-		for (std::size_t i = 0; i < charBuffer.size(); ++i)
-		{
-			if (charBuffer[i] == '\0') {
-				m_StringTable.push_back("");
-				continue;
-			}
+		// Names are null terminated. Any text after the last null is not a name.
+		m_StringTable.clear();
+		std::size_t nameStart = 0;
+		for (std::size_t nameEnd; (nameEnd = charBuffer.find('\0', nameStart)) != std::string::npos; nameStart = nameEnd + 1) {
+			m_StringTable.emplace_back(charBuffer, nameStart, nameEnd - nameStart);
+		}
 
-			m_StringTable[m_StringTable.size() - 1].push_back(charBuffer[i]);
+		// Seek to the end of padding at end of StringTable
+		volumeReader.SeekForward(m_StringTableLength - actualStringTableLength - 4);
+	}
+
+	void VolFile::WriteIndex(Stream::Writer& writer)
+	{
+		writer.Write(TagVOL_);
+		writer.Write(m_HeaderLength);
+		writer.Write(m_StringTableLength);
+		writer.Write(m_IndexTableLength);
+		writer.Write<uint32_t>(m_IndexEntries);
+
+		writer.Write(static_cast<uint32_t>(m_StringTable.size()));
+		for (const auto& name : m_StringTable) {
+			writer.Write<uint32_t>(name);
 		}
+	}
 
-		m_StringTable.erase(m_StringTable.begin() + m_StringTable.size() - 1);
+	void VolFile::ReadIndex(Stream::Reader& reader)
+	{
+		Tag tag;
+		reader.Read(tag);
+		if (tag != TagVOL_) {
+			throw std::runtime_error("Cached index of " + m_ArchiveFilename + " is not for a volume");
+		}
 
-		// Seek to the end of padding at end of StringTable
-		archiveFileReader.SeekForward(m_StringTableLength - actualStringTableLength - 4);
+		reader.Read(m_HeaderLength);
+		reader.Read(m_StringTableLength);
+		reader.Read(m_IndexTableLength);
+		reader.Read<uint32_t>(m_IndexEntries);
+		m_IndexEntryCount = static_cast<uint32_t>(m_IndexEntries.size());
+
+		uint32_t nameCount;
+		reader.Read(nameCount);
+		m_StringTable.resize(nameCount);
+		for (auto& name : m_StringTable) {
+			reader.Read<uint32_t>(name);
+		}
+
+		CountValidEntries();
+		if (m_Count > m_StringTable.size()) {
+			throw std::runtime_error("Cached index of " + m_ArchiveFilename + " has fewer names than packed files");
+		}
 	}
 
 	void VolFile::CountValidEntries()
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "HuffLZ.h"
+#include "HuffLZEncoder.h"
 #include "ArchiveFile.h"
+#include "DecompressedEntryCache.h"
 #include "CompressionType.h"
+#include "PackSource.h"
 #include "../Tag.h"
 #include "../Stream/FileWriter.h"
-#include "../Stream/FileReader.h"
 #include <cstddef>
 #include <string>
 #include <vector>
@@ -17,7 +19,8 @@ namespace OP2Utility::Archive
 	class VolFile : public ArchiveFile
 	{
 	public:
-		VolFile(const std::string& filename);
+		// With an indexCache, the index is restored from the cache if current, or else parsed and stored in the cache
+		VolFile(const std::string& filename, ArchiveBackend backend = ArchiveBackend::FileStream, ArchiveIndexCache* indexCache = nullptr);
 		~VolFile() override;
 
 		// Internal file status
@@ -30,13 +33,59 @@ namespace OP2Utility::Archive
 		void ExtractFile(std::size_t index, const std::string& pathOut) override;
 
 		// Opens a stream containing a packed file
+		// LZH compressed files are decompressed as the stream is read, and Length reports the decompressed size
 		std::unique_ptr<Stream::BidirectionalReader> OpenStream(std::size_t index) override;
+		// Opens a stream of a packed file's data block, which may be compressed
+		std::unique_ptr<Stream::BidirectionalReader> OpenStoredStream(std::size_t index) override;
+		bool IsCompressed(std::size_t index) override;
+		bool CanDecompress(std::size_t index) override;
+		std::unique_ptr<Stream::BidirectionalReader> OpenDecompressedStream(std::size_t index, std::unique_ptr<Stream::BidirectionalReader> dataBlock) override;
+		// LZH streams opened afterwards snapshot their decoder every checkpointInterval bytes of output,
+		// so seeking resumes from the nearest snapshot instead of the beginning. 0 (default) disables this.
+		void SetStreamCheckpointInterval(uint64_t checkpointInterval);
+
+		// Reads a whole packed file. LZH compressed files are decompressed straight into buffer.
+		using ArchiveFile::ReadFile;
+		void ReadFile(std::size_t index, void* buffer, std::size_t bufferSize) override;
+
+		// Views are available for uncompressed files of memory mapped archives
+		FileView GetFileView(std::size_t index) override;
 
 		// Create a new archive with the files specified in filesToPack
-		static void CreateArchive(const std::string& volumeFilename, std::vector<std::string> filesToPack);
+		// With LZH compressionType, each file is compressed at compressionLevel, but only stored compressed if that makes it smaller
+		// Files are opened one at a time, only while being packed
+		// LZH compression runs on threadCount threads (0 for one per hardware thread), while files are written in order.
+		// Only a few compressed files per thread are held in memory awaiting their turn to be written.
+		// With deduplicate, files with identical contents share one data block. The index format is unchanged.
+		static void CreateArchive(const std::string& volumeFilename, std::vector<std::string> filesToPack,
+			CompressionType compressionType = CompressionType::Uncompressed, HuffLZEncoder::CompressionLevel compressionLevel = HuffLZEncoder::CompressionLevel::Fast,
+			std::size_t threadCount = 1, bool deduplicate = false);
+		// Create a new archive from sources, such as in-memory buffers, named by PackSource::name
+		static void CreateArchiveFromSources(const std::string& volumeFilename, std::vector<PackSource> sources,
+			CompressionType compressionType = CompressionType::Uncompressed, HuffLZEncoder::CompressionLevel compressionLevel = HuffLZEncoder::CompressionLevel::Fast,
+			std::size_t threadCount = 1, bool deduplicate = false);
+
+		// Changes an existing volume in place, without rewriting unchanged files
+		// Files in filesToPack are added, replacing any packed file of the same name, and packed files in namesToRemove are removed.
+		// New data blocks reuse space left by removed or replaced files, or are appended. Unused space may remain until CompactArchive.
+		// The volume may be left unreadable if the update is interrupted.
+		static void UpdateArchive(const std::string& volumeFilename, std::vector<std::string> filesToPack, const std::vector<std::string>& namesToRemove = {}, CompressionType compressionType = CompressionType::Uncompressed,
+			HuffLZEncoder::CompressionLevel compressionLevel = HuffLZEncoder::CompressionLevel::Fast);
+		static void UpdateArchiveFromSources(const std::string& volumeFilename, std::vector<PackSource> sources, const std::vector<std::string>& namesToRemove = {}, CompressionType compressionType = CompressionType::Uncompressed,
+			HuffLZEncoder::CompressionLevel compressionLevel = HuffLZEncoder::CompressionLevel::Fast);
+
+		// Rewrites a volume with its data blocks packed together, removing unused space
+		// Data blocks shared by several packed files remain shared
+		static void CompactArchive(const std::string& volumeFilename);
+
+	protected:
+		uint64_t GetPackedDataOffset(std::size_t index) override;
+		std::unique_ptr<Stream::BidirectionalReader> OpenPackedStream(std::size_t index, const uint8_t* packedData, std::size_t availableLength) override;
+		void WriteIndex(Stream::Writer& writer) override;
+		void ReadIndex(Stream::Reader& reader) override;
 
 	private:
-		int GetFileOffset(std::size_t index);
+		uint64_t GetFileOffset(std::size_t index);
 		int GetFilenameOffset(std::size_t index);
 
 		void ExtractFileUncompressed(std::size_t index, const std::string& filename);
@@ -77,9 +126,11 @@ namespace OP2Utility::Archive
 		struct CreateVolumeInfo
 		{
 			std::vector<IndexEntry> indexEntries;
-			std::vector<std::unique_ptr<Stream::BidirectionalReader>> fileStreamReaders;
-			std::vector<std::string> filesToPack;
+			std::vector<PackSource> sources;
 			std::vector<std::string> names;
+			std::vector<std::size_t> dataBlockSources; // Index of the file whose data block each file uses, if deduplicating
+			CompressionType compressionType;
+			HuffLZEncoder::CompressionLevel compressionLevel;
 			uint32_t stringTableLength;
 			uint32_t indexTableLength;
 			uint32_t paddedStringTableLength;
@@ -87,28 +138,73 @@ namespace OP2Utility::Archive
 
 			std::size_t fileCount() const
 			{
-				return filesToPack.size();
+				return names.size();
+			}
+
+			bool SharesDataBlock(std::size_t index) const
+			{
+				return !dataBlockSources.empty() && dataBlockSources[index] != index;
 			}
 		};
 
-		uint32_t ReadTag(Tag tagName);
-		void ReadVolHeader();
-		void ReadStringTable();
+		struct UpdateEntry
+		{
+			std::string name;
+			IndexEntry indexEntry;
+			std::size_t index; // Index in the volume being updated, if the existing data block is kept
+			uint32_t blockLength; // Length of the existing data block, excluding its section header
+			PackSource source; // File to pack, or without an openReader if the existing data block is kept
+			bool relocate; // Existing data block overlaps the new header, so is moved
+			std::vector<uint8_t> relocatedData;
+		};
+
+		struct FreeRange
+		{
+			uint64_t offset;
+			uint64_t length;
+		};
+
+		uint32_t ReadTag(Stream::BidirectionalReader& volumeReader, Tag tagName);
+		void ReadVolHeader(Stream::BidirectionalReader& volumeReader);
+		void ReadStringTable(Stream::BidirectionalReader& volumeReader);
 		void CountValidEntries();
 		SectionHeader GetSectionHeader(std::size_t index);
-
-		static void WriteVolume(const std::string& filename, CreateVolumeInfo& volInfo);
+		void VerifySectionHeader(const SectionHeader& sectionHeader, std::size_t index);
+		std::unique_ptr<Stream::BidirectionalReader> OpenDataBlock(std::size_t index);
+		void DecompressInto(std::size_t index, char* buffer);
+		DecompressedEntryCache::Contents GetCachedContents(std::size_t index);
+
+		std::vector<UpdateEntry> GetUpdateEntries();
+		static void RemoveUpdateEntries(std::vector<UpdateEntry>& entries, const std::vector<std::string>& namesToRemove, const std::string& volumeFilename);
+		static void AddUpdateEntries(std::vector<UpdateEntry>& entries, std::vector<PackSource> sources);
+		static uint64_t FindFreeRanges(std::vector<UpdateEntry>& entries, uint64_t headerLength, std::vector<FreeRange>& freeRanges);
+		static uint32_t AllocateBlock(std::vector<FreeRange>& freeRanges, uint64_t& volumeEnd, uint64_t blockSpan);
+		static void WriteUpdatedBlock(Stream::BidirectionalWriter& volWriter, UpdateEntry& entry, IndexEntry& indexEntry,
+			std::vector<FreeRange>& freeRanges, uint64_t& volumeEnd, CompressionType compressionType, HuffLZEncoder::CompressionLevel compressionLevel);
+
+		static void WriteVolume(const std::string& filename, CreateVolumeInfo& volInfo, std::size_t threadCount);
 		static void WriteFiles(Stream::Writer& volWriter, CreateVolumeInfo &volInfo);
+		static void WriteCompressedFiles(Stream::Writer& volWriter, CreateVolumeInfo &volInfo, std::size_t threadCount);
+		static void SetDataBlockOffset(IndexEntry& indexEntry, uint64_t dataBlockOffset, const std::string& name);
+		static void ShareDataBlock(CreateVolumeInfo &volInfo, std::size_t index);
+		static uint32_t WriteUncompressedBlock(Stream::Writer& volWriter, IndexEntry& indexEntry, Stream::BidirectionalReader& fileReader);
+		static std::vector<uint8_t> CompressBlock(IndexEntry& indexEntry, Stream::BidirectionalReader& fileReader, HuffLZEncoder::CompressionLevel compressionLevel);
+		static void WriteBlock(Stream::Writer& volWriter, const std::vector<uint8_t>& blockData);
+		static void WriteBlockPadding(Stream::Writer& volWriter, uint32_t blockLength);
+		static uint64_t GetBlockSpan(uint64_t blockLength);
 		static void WriteHeader(Stream::Writer& volWriter, const CreateVolumeInfo &volInfo);
+		static uint64_t GetHeaderLength(const CreateVolumeInfo &volInfo);
 		static void PrepareHeader(CreateVolumeInfo &volInfo, const std::string& volumeFilename);
-		static void OpenAllInputFiles(CreateVolumeInfo &volInfo, const std::string& volumeFilename);
+		static void PrepareTables(CreateVolumeInfo &volInfo, const std::string& volumeFilename);
+		static void SortPackSources(std::vector<PackSource>& sources);
+		static void VerifyVolumeNotPacked(const std::string& volumeFilename, const std::vector<std::string>& filesToPack);
 
-		Stream::FileReader archiveFileReader;
 		uint32_t m_IndexEntryCount;
 		std::vector<std::string> m_StringTable;
 		uint32_t m_HeaderLength;
 		uint32_t m_StringTableLength;
 		uint32_t m_IndexTableLength;
 		std::vector<IndexEntry> m_IndexEntries;
+		uint64_t m_StreamCheckpointInterval;
 	};
 }
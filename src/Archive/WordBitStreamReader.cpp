@@ -0,0 +1,128 @@
+#include "WordBitStreamReader.h"
+#include "../Stream/Reader.h"
+#include <stdexcept>
+#include <string>
+#include <limits>
+#include <algorithm>
+
+namespace OP2Utility::Archive
+{
+	WordBitStreamReader::WordBitStreamReader(const void* buffer, std::size_t bufferSize) :
+		m_BitBuffer(0),
+		m_BitCount(0),
+		m_LoadedBitCount(0),
+		m_StreamBitSize(bufferSize << 3),
+		m_Next(static_cast<const unsigned char*>(buffer)),
+		m_End(static_cast<const unsigned char*>(buffer) + bufferSize),
+		m_StreamReader(nullptr),
+		m_StreamBytesRemaining(0)
+	{
+		// Check bufferSize does not exceed the max addressable bit index
+		if (bufferSize > std::numeric_limits<decltype(m_StreamBitSize)>::max() / 8) {
+			throw std::runtime_error("WordBitStreamReader cannot support a buffer size of " + std::to_string(bufferSize));
+		}
+	}
+
+	WordBitStreamReader::WordBitStreamReader(Stream::Reader& streamReader, std::size_t streamLength, std::size_t chunkSize) :
+		m_BitBuffer(0),
+		m_BitCount(0),
+		m_LoadedBitCount(0),
+		m_StreamBitSize(streamLength << 3),
+		m_Next(nullptr),
+		m_End(nullptr),
+		m_StreamReader(&streamReader),
+		m_StreamBytesRemaining(streamLength),
+		m_Chunk(std::max<std::size_t>(chunkSize, 1))
+	{
+		if (streamLength > std::numeric_limits<decltype(m_StreamBitSize)>::max() / 8) {
+			throw std::runtime_error("WordBitStreamReader cannot support a stream length of " + std::to_string(streamLength));
+		}
+	}
+
+	WordBitStreamReader::WordBitStreamReader(const WordBitStreamReader& wordBitStreamReader) :
+		m_BitBuffer(wordBitStreamReader.m_BitBuffer),
+		m_BitCount(wordBitStreamReader.m_BitCount),
+		m_LoadedBitCount(wordBitStreamReader.m_LoadedBitCount),
+		m_StreamBitSize(wordBitStreamReader.m_StreamBitSize),
+		m_Next(wordBitStreamReader.m_Next),
+		m_End(wordBitStreamReader.m_End),
+		m_StreamReader(wordBitStreamReader.m_StreamReader),
+		m_StreamBytesRemaining(wordBitStreamReader.m_StreamBytesRemaining),
+		m_Chunk(wordBitStreamReader.m_Chunk)
+	{
+		// A stream backed reader must point into its own copy of the chunk
+		if (m_StreamReader && m_Next) {
+			m_Next = m_Chunk.data() + (wordBitStreamReader.m_Next - wordBitStreamReader.m_Chunk.data());
+			m_End = m_Chunk.data() + (wordBitStreamReader.m_End - wordBitStreamReader.m_Chunk.data());
+		}
+	}
+
+
+	int WordBitStreamReader::ReadNext8Bits()
+	{
+		const int value = PeekBits(8);
+		ConsumeBits(8);
+		return value;
+	}
+
+	bool WordBitStreamReader::EndOfStream() const
+	{
+		return GetBitReadPos() >= m_StreamBitSize;
+	}
+
+	std::size_t WordBitStreamReader::GetBitReadPos() const
+	{
+		return m_LoadedBitCount - m_BitCount;
+	}
+
+
+	// Tops up the accumulator to at least 57 bits, or with all remaining bits of the stream
+	void WordBitStreamReader::Refill()
+	{
+		// Load 8 bytes at once when available. Only the whole bytes that fit are counted.
+		// The following partial byte lands below m_BitCount, where it is rewritten with
+		// the same bits when that byte is counted by the next refill.
+		if (m_End - m_Next >= 8)
+		{
+			uint64_t value = 0;
+			for (int i = 0; i < 8; ++i) {
+				value = (value << 8) | m_Next[i];
+			}
+
+			const unsigned int byteCount = (63 - m_BitCount) >> 3;
+			m_BitBuffer |= value >> m_BitCount;
+			m_Next += byteCount;
+			m_BitCount += byteCount * 8;
+			m_LoadedBitCount += byteCount * 8;
+			return;
+		}
+
+		// Near the end of a buffer or chunk, load a byte at a time
+		while (m_BitCount <= 56)
+		{
+			if (m_Next == m_End && !LoadChunk()) {
+				return;
+			}
+
+			m_BitBuffer |= static_cast<uint64_t>(*m_Next++) << (56 - m_BitCount);
+			m_BitCount += 8;
+			m_LoadedBitCount += 8;
+		}
+	}
+
+	// Reads the next chunk from the source stream. Returns false at the end of the stream.
+	bool WordBitStreamReader::LoadChunk()
+	{
+		if (!m_StreamReader || m_StreamBytesRemaining == 0) {
+			return false;
+		}
+
+		const std::size_t chunkLength = std::min(m_Chunk.size(), m_StreamBytesRemaining);
+		m_StreamReader->Read(m_Chunk.data(), chunkLength);
+		m_StreamBytesRemaining -= chunkLength;
+
+		m_Next = m_Chunk.data();
+		m_End = m_Chunk.data() + chunkLength;
+		return true;
+	}
+}
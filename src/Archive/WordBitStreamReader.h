@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OP2Utility::Stream
+{
+	class Reader;
+}
+
+namespace OP2Utility::Archive
+{
+	// Bit stream reader holding up to 64 bits of input in an accumulator.
+	// The accumulator is refilled several bytes at a time, so the end of the input
+	// is only checked when refilling. Bits are read MSB first, the same as BitStreamReader,
+	// which this can replace in HuffLZ.
+	class WordBitStreamReader
+	{
+	public:
+		static const std::size_t DefaultChunkSize = 0x4000;
+		static const unsigned int MaxPeekBitCount = 32;
+
+		WordBitStreamReader(const void* buffer, std::size_t bufferSize); // Construct stream around given buffer
+
+		// Construct stream around streamLength bytes pulled from streamReader, chunkSize bytes at a time
+		// Only a single chunk is held in memory. The streamReader must outlive the WordBitStreamReader.
+		// Note: Copies share the streamReader, so only one copy should be read from
+		WordBitStreamReader(Stream::Reader& streamReader, std::size_t streamLength, std::size_t chunkSize = DefaultChunkSize);
+		WordBitStreamReader(const WordBitStreamReader& wordBitStreamReader);
+		WordBitStreamReader& operator=(const WordBitStreamReader& wordBitStreamReader) = delete;
+
+		bool ReadNextBit();			// Get bit at Read index and advance index
+		int  ReadNext8Bits();		// Get next 8 bits at Read index and advance index
+		// Get next bitCount bits (up to 32) at Read index without advancing, first bit in the MSB
+		// Bits past the end of the stream read as 0
+		unsigned int PeekBits(unsigned int bitCount);
+		void ConsumeBits(unsigned int bitCount); // Advance Read index by bitCount bits, up to 32 (stops at the end of the stream)
+		bool EndOfStream() const;	// Returns true if the last bit has been read
+		std::size_t GetBitReadPos() const; // Returns the position (in bits) of the read pointer
+	private:
+		void Refill();
+		bool LoadChunk();
+
+		uint64_t m_BitBuffer;		// Upcoming bits, next bit in the MSB
+		unsigned int m_BitCount;	// Number of valid bits in m_BitBuffer
+		std::size_t m_LoadedBitCount; // Number of bits from the stream added to m_BitBuffer so far
+		std::size_t m_StreamBitSize;// Size of the stream in bits
+
+		const unsigned char* m_Next;// Next byte to add to m_BitBuffer
+		const unsigned char* m_End;	// End of the current buffer or chunk
+
+		Stream::Reader* m_StreamReader; // Source of chunks, or nullptr if reading from a fixed buffer
+		std::size_t m_StreamBytesRemaining; // Bytes not yet read from m_StreamReader
+		std::vector<unsigned char> m_Chunk;
+	};
+
+
+	// Reading bits is on the decompression hot path, so the common cases are inline
+
+	inline unsigned int WordBitStreamReader::PeekBits(unsigned int bitCount)
+	{
+		if (m_BitCount < bitCount) {
+			Refill();
+		}
+
+		// Note: The shift must stay below 64 bits
+		return static_cast<unsigned int>((m_BitBuffer >> 1) >> (63 - bitCount));
+	}
+
+	inline void WordBitStreamReader::ConsumeBits(unsigned int bitCount)
+	{
+		if (m_BitCount < bitCount) {
+			Refill();
+			// Bits past the end of the stream are not consumed
+			if (m_BitCount < bitCount) {
+				bitCount = m_BitCount;
+			}
+		}
+
+		m_BitBuffer <<= bitCount;
+		m_BitCount -= bitCount;
+	}
+
+	inline bool WordBitStreamReader::ReadNextBit()
+	{
+		if (m_BitCount == 0) {
+			Refill();
+			if (m_BitCount == 0) {
+				return false;
+			}
+		}
+
+		const bool bNextBit = (m_BitBuffer >> 63) != 0;
+		m_BitBuffer <<= 1;
+		--m_BitCount;
+		return bNextBit;
+	}
+}
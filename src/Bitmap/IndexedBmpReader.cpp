@@ -73,6 +73,13 @@ namespace OP2Utility
 		BitmapFile::VerifyPixelSizeMatchesImageDimensionsWithPitch(bitmapFile.imageHeader.bitCount, bitmapFile.imageHeader.width, bitmapFile.imageHeader.height, pixelContainerSize);
 
 		bitmapFile.pixels.clear();
+
+		// Memory backed readers are copied from in place, without first zero filling the pixels
+		if (const auto* pixels = static_cast<const uint8_t*>(seekableReader.TryGetContiguous(pixelContainerSize))) {
+			bitmapFile.pixels.assign(pixels, pixels + pixelContainerSize);
+			return;
+		}
+
 		bitmapFile.pixels.resize(pixelContainerSize);
 		seekableReader.Read(bitmapFile.pixels);
 	}
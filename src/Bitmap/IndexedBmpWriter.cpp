@@ -17,6 +17,7 @@ namespace OP2Utility
 
 		Stream::FileWriter fileWriter(filename);
 		WriteIndexed(fileWriter);
+		fileWriter.Flush();
 	}
 
 	void BitmapFile::WriteIndexed(Stream::Writer& writer) const
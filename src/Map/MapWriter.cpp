@@ -12,6 +12,7 @@ namespace OP2Utility
 	{
 		Stream::FileWriter mapStream(filename);
 		this->Write(mapStream);
+		mapStream.Flush();
 	}
 
 	void Map::Write(Stream::Writer& mapStream) const
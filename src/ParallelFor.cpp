@@ -0,0 +1,149 @@
+#include "ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OP2Utility
+{
+	std::size_t HardwareThreadCount()
+	{
+		return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+	void ParallelFor(std::size_t count, std::size_t threadCount, const std::function<void(std::size_t)>& function)
+	{
+		if (threadCount == 0) {
+			threadCount = HardwareThreadCount();
+		}
+		threadCount = std::min(threadCount, count);
+
+		std::atomic<std::size_t> nextIndex(0);
+		std::atomic<bool> failed(false);
+		std::exception_ptr firstException;
+		std::mutex exceptionMutex;
+
+		// Each thread claims the next unstarted index until none remain
+		auto worker = [&]() {
+			for (std::size_t index = nextIndex++; index < count && !failed; index = nextIndex++)
+			{
+				try {
+					function(index);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> lock(exceptionMutex);
+					if (!firstException) {
+						firstException = std::current_exception();
+					}
+					failed = true;
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (std::size_t i = 1; i < threadCount; ++i) {
+			threads.emplace_back(worker);
+		}
+		worker();
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		if (firstException) {
+			std::rethrow_exception(firstException);
+		}
+	}
+
+	void ParallelOrderedFor(std::size_t count, std::size_t threadCount, std::size_t maxPending,
+		const std::function<void(std::size_t)>& produce, const std::function<void(std::size_t)>& consume)
+	{
+		if (threadCount == 0) {
+			threadCount = HardwareThreadCount();
+		}
+		threadCount = std::min(threadCount, count);
+		maxPending = std::max<std::size_t>(maxPending, 1);
+
+		std::mutex mutex;
+		std::condition_variable stateChanged;
+		std::size_t nextIndex = 0; // Next index to produce
+		std::size_t consumedCount = 0; // Indexes below this have been consumed
+		std::vector<bool> produced(count);
+		std::exception_ptr firstException;
+
+		// Must be called with the mutex held
+		auto recordException = [&]() {
+			if (!firstException) {
+				firstException = std::current_exception();
+			}
+			stateChanged.notify_all();
+		};
+
+		// Each thread claims the next index, once there is room for another pending result
+		auto worker = [&]() {
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true)
+			{
+				stateChanged.wait(lock, [&]() {
+					return firstException || nextIndex >= count || nextIndex - consumedCount < maxPending;
+				});
+				if (firstException || nextIndex >= count) {
+					return;
+				}
+
+				const auto index = nextIndex++;
+				lock.unlock();
+				try {
+					produce(index);
+					lock.lock();
+					produced[index] = true;
+					stateChanged.notify_all();
+				}
+				catch (...) {
+					lock.lock();
+					recordException();
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (std::size_t i = 0; i < threadCount; ++i) {
+			threads.emplace_back(worker);
+		}
+
+		for (std::size_t index = 0; index < count; ++index)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				stateChanged.wait(lock, [&]() { return firstException || produced[index]; });
+				if (firstException) {
+					break;
+				}
+			}
+
+			try {
+				consume(index);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				recordException();
+				break;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			consumedCount = index + 1;
+			stateChanged.notify_all();
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		if (firstException) {
+			std::rethrow_exception(firstException);
+		}
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace OP2Utility
+{
+	// Returns the number of threads the hardware can run concurrently (at least 1)
+	std::size_t HardwareThreadCount();
+
+	// Calls function once for each index in [0, count), spread over up to threadCount threads.
+	// The calling thread also runs calls. A threadCount of 0 uses HardwareThreadCount().
+	// If a call throws, indexes not yet started are skipped, and the first exception
+	// is rethrown after all threads have finished.
+	void ParallelFor(std::size_t count, std::size_t threadCount, const std::function<void(std::size_t)>& function);
+
+	// Calls produce for each index in [0, count) on up to threadCount worker threads, and calls consume
+	// on the calling thread for each index in increasing order, once produce has finished for it.
+	// At most maxPending indexes are being produced or waiting to be consumed at a time, which bounds
+	// the memory held by produced results. A threadCount of 0 uses HardwareThreadCount().
+	// If a call throws, remaining calls are skipped, and the first exception
+	// is rethrown after all threads have finished.
+	void ParallelOrderedFor(std::size_t count, std::size_t threadCount, std::size_t maxPending,
+		const std::function<void(std::size_t)>& produce, const std::function<void(std::size_t)>& consume);
+}
@@ -1,6 +1,8 @@
 #include "ResourceManager.h"
 #include "Archive/VolFile.h"
 #include "Archive/ClmFile.h"
+#include "Archive/DecompressedEntryCache.h"
+#include "Archive/ArchiveIndexCache.h"
 #include "Stream/BidirectionalReader.h"
 #include "XFile.h"
 
@@ -8,23 +10,37 @@ namespace OP2Utility
 {
 	using namespace Archive;
 
-	ResourceManager::ResourceManager(const std::string& archiveDirectory) :
+	ResourceManager::ResourceManager(const std::string& archiveDirectory, ArchiveBackend archiveBackend, const std::string& indexCacheFilename) :
 		resourceRootDir(archiveDirectory)
 	{
 		if (!XFile::IsDirectory(archiveDirectory)) {
 			throw std::runtime_error("Resource manager must be passed an archive directory.");
 		}
 
+		ArchiveIndexCache indexCache;
+		if (!indexCacheFilename.empty()) {
+			indexCache = ArchiveIndexCache::Load(indexCacheFilename);
+		}
+		auto indexCachePointer = indexCacheFilename.empty() ? nullptr : &indexCache;
+
 		const auto volFilenames = GetFilesFromDirectory(".vol");
 
 		for (const auto& volFilename : volFilenames) {
-			ArchiveFiles.push_back(std::make_unique<VolFile>(XFile::Append(archiveDirectory, volFilename)));
+			ArchiveFiles.push_back(std::make_unique<VolFile>(XFile::Append(archiveDirectory, volFilename), archiveBackend, indexCachePointer));
 		}
 
 		const auto clmFilenames = GetFilesFromDirectory(".clm");
 
 		for (const auto& clmFilename : clmFilenames) {
-			ArchiveFiles.push_back(std::make_unique<ClmFile>(XFile::Append(archiveDirectory, clmFilename)));
+			ArchiveFiles.push_back(std::make_unique<ClmFile>(XFile::Append(archiveDirectory, clmFilename), archiveBackend, indexCachePointer));
+		}
+
+		if (indexCache.IsModified()) {
+			// The cache is optional; if it can not be written, archives are parsed again next time
+			try {
+				indexCache.Save(indexCacheFilename);
+			}
+			catch (const std::exception&) {}
 		}
 	}
 
@@ -50,8 +66,8 @@ namespace OP2Utility
 		for (const auto& archiveFile : ArchiveFiles)
 		{
 
-			if (archiveFile->Contains(filename)) {
-				auto index = archiveFile->GetIndex(filename);
+			std::size_t index;
+			if (archiveFile->FindIndex(filename, index)) {
 				return archiveFile->OpenStream(index);
 			}
 		}
@@ -109,14 +125,10 @@ namespace OP2Utility
 	{
 		for (std::size_t i = 0; i < ArchiveFiles.size(); ++i)
 		{
-			for (std::size_t j = 0; j < ArchiveFiles[i]->GetCount(); ++j)
+			if (ArchiveFiles[i]->FindIndex(filename, internalIndexOut))
 			{
-				if (XFile::PathsAreEqual(ArchiveFiles[i]->GetName(j), filename))
-				{
-					archiveIndexOut = i;
-					internalIndexOut = j;
-					return true;
-				}
+				archiveIndexOut = i;
+				return true;
 			}
 		}
 
@@ -160,6 +172,36 @@ namespace OP2Utility
 		return archiveFilenames;
 	}
 
+	void ResourceManager::SetDecompressedEntryCache(std::shared_ptr<DecompressedEntryCache> cache)
+	{
+		for (auto& archiveFile : ArchiveFiles) {
+			archiveFile->SetDecompressedEntryCache(cache);
+		}
+	}
+
+	std::vector<ArchiveManifest::VerificationResult> ResourceManager::VerifyArchives(std::size_t threadCount)
+	{
+		std::vector<ArchiveManifest> manifests;
+		std::vector<ArchiveFile*> archives;
+		for (const auto& archiveFile : ArchiveFiles) {
+			const auto manifestFilename = ArchiveManifest::GetManifestFilename(archiveFile->GetArchiveFilename());
+			try {
+				manifests.push_back(ArchiveManifest::Load(manifestFilename));
+			}
+			catch (const std::exception& e) {
+				throw std::runtime_error("Unable to load manifest " + manifestFilename + ". Internal Error: " + e.what());
+			}
+			archives.push_back(archiveFile.get());
+		}
+
+		std::vector<const ArchiveManifest*> manifestPointers;
+		for (const auto& manifest : manifests) {
+			manifestPointers.push_back(&manifest);
+		}
+
+		return ArchiveManifest::Verify(archives, manifestPointers, threadCount);
+	}
+
 	std::vector<std::string> ResourceManager::GetFilesFromDirectory(const std::string& fileExtension)
 	{
 		return XFile::DirFilesWithExtension(resourceRootDir, fileExtension);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Archive/ArchiveFile.h"
+#include "Archive/ArchiveManifest.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -17,7 +18,11 @@ namespace OP2Utility
 	class ResourceManager
 	{
 	public:
-		ResourceManager(const std::string& archiveDirectory);
+		// Archives are opened with archiveBackend. Memory mapping speeds up opening many small resources.
+		// With an indexCacheFilename, archive indexes are restored from that ArchiveIndexCache file instead of parsed,
+		// for archives unchanged since they were cached. The file is created or updated as needed; failures to write it are ignored.
+		ResourceManager(const std::string& archiveDirectory, Archive::ArchiveBackend archiveBackend = Archive::ArchiveBackend::FileStream,
+			const std::string& indexCacheFilename = std::string());
 
 		std::unique_ptr<Stream::BidirectionalReader> GetResourceStream(const std::string& filename, bool accessArchives = true);
 
@@ -30,6 +35,14 @@ namespace OP2Utility
 		// Returns a list of all loaded archives
 		std::vector<std::string> GetArchiveFilenames();
 
+		// Caches decompressed archive contents across all loaded archives. Pass nullptr to stop caching.
+		void SetDecompressedEntryCache(std::shared_ptr<Archive::DecompressedEntryCache> cache);
+
+		// Checks every loaded archive against the manifest saved beside it (see ArchiveManifest::GetManifestFilename).
+		// Packed files of all archives are verified together on threadCount threads (0 for one per hardware thread).
+		// Throws if an archive's manifest can not be loaded.
+		std::vector<Archive::ArchiveManifest::VerificationResult> VerifyArchives(std::size_t threadCount = 0);
+
 	private:
 		const std::string resourceRootDir;
 		std::vector<std::unique_ptr<Archive::ArchiveFile>> ArchiveFiles;
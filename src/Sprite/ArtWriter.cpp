@@ -10,6 +10,7 @@ namespace OP2Utility
 	{
 		Stream::FileWriter artWriter(filename);
 		Write(artWriter);
+		artWriter.Flush();
 	}
 
 	void ArtFile::Write(Stream::Writer& writer) const
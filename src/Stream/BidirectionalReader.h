@@ -10,8 +10,7 @@ namespace OP2Utility::Stream
 		~BidirectionalReader() override;
 
 		void Peek(void* buffer, std::size_t size) {
-			ReadImplementation(buffer, size);
-			SeekBackward(size);
+			PeekImplementation(buffer, size);
 		}
 
 		// Trivially copyable data types
@@ -30,5 +29,13 @@ namespace OP2Utility::Stream
 		void SeekBeginning() {
 			Seek(0);
 		}
+
+	protected:
+		// Reads, then seeks back. Override where the data can be examined without moving.
+		// Note: This is named separately from Peek to prevent name hiding in derived classes
+		virtual void PeekImplementation(void* buffer, std::size_t size) {
+			ReadImplementation(buffer, size);
+			SeekBackward(size);
+		}
 	};
 }
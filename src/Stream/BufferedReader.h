@@ -0,0 +1,208 @@
+#pragma once
+
+#include "BidirectionalReader.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace OP2Utility::Stream
+{
+	// Wraps a stream, batching small reads into reads of up to bufferSize bytes from the wrapped stream.
+	// Reads of at least bufferSize bytes, or of the rest of the stream, go straight to the wrapped stream.
+	// Peeks, and seeks within the buffered bytes, do not touch the wrapped stream.
+	// Positions are those of the wrapped stream, which is owned and should not be used directly.
+	template<class WrappedStreamType>
+	class BufferedReader : public BidirectionalReader
+	{
+	public:
+		static constexpr std::size_t DefaultBufferSize = 0x4000;
+
+		BufferedReader(WrappedStreamType wrappedStream, std::size_t bufferSize = DefaultBufferSize) :
+			wrappedStream(std::move(wrappedStream)),
+			bufferSize(std::max<std::size_t>(bufferSize, 1)),
+			bufferPosition(this->wrappedStream.Position()),
+			bufferOffset(0),
+			bufferLength(0)
+		{ }
+
+		// Generates a new reader at the same position, with its own (empty) buffer
+		BufferedReader(const BufferedReader& bufferedReader) :
+			wrappedStream(bufferedReader.wrappedStream),
+			bufferSize(bufferedReader.bufferSize),
+			bufferPosition(bufferedReader.bufferPosition + bufferedReader.bufferOffset),
+			bufferOffset(0),
+			bufferLength(0)
+		{
+			wrappedStream.Seek(bufferPosition);
+		}
+
+
+		std::size_t ReadPartial(void* buffer, std::size_t size) noexcept override {
+			try {
+				return ReadBuffered(buffer, size);
+			}
+			catch (const std::exception&) {
+				return 0;
+			}
+		}
+
+		// Borrows from the wrapped stream, once the buffered bytes are used up
+		const void* TryGetContiguous(std::size_t size) noexcept override {
+			if (bufferOffset != bufferLength) {
+				return nullptr;
+			}
+
+			const auto* data = wrappedStream.TryGetContiguous(size);
+			if (data) {
+				DiscardBuffer(bufferPosition + bufferLength + size);
+			}
+
+			return data;
+		}
+
+
+		uint64_t Length() override {
+			return wrappedStream.Length();
+		}
+
+		uint64_t Position() override {
+			return bufferPosition + bufferOffset;
+		}
+
+
+		void SeekForward(uint64_t offset) override {
+			if (offset > Length() - Position()) {
+				throw std::runtime_error("Seek forward by offset of " + std::to_string(offset) + " is beyond the bounds of the buffered stream.");
+			}
+
+			const auto bytesBuffered = bufferLength - bufferOffset;
+			if (offset <= bytesBuffered) {
+				bufferOffset += static_cast<std::size_t>(offset);
+				return;
+			}
+
+			wrappedStream.SeekForward(offset - bytesBuffered);
+			DiscardBuffer(bufferPosition + bufferOffset + offset);
+		}
+
+		void SeekBackward(uint64_t offset) override {
+			if (offset > Position()) {
+				throw std::runtime_error("Seek backward by offset of " + std::to_string(offset) + " is beyond the bounds of the buffered stream.");
+			}
+
+			if (offset <= bufferOffset) {
+				bufferOffset -= static_cast<std::size_t>(offset);
+				return;
+			}
+
+			Seek(Position() - offset);
+		}
+
+		void Seek(uint64_t position) override {
+			if (position >= bufferPosition && position - bufferPosition <= bufferLength) {
+				bufferOffset = static_cast<std::size_t>(position - bufferPosition);
+				return;
+			}
+
+			if (position > Length()) {
+				throw std::runtime_error("Seek to absolute offset of " + std::to_string(position) + " is beyond the bounds of the buffered stream.");
+			}
+
+			wrappedStream.Seek(position);
+			DiscardBuffer(position);
+		}
+
+	protected:
+		void ReadImplementation(void* buffer, std::size_t size) override {
+			if (size > Length() - Position() || ReadBuffered(buffer, size) < size) {
+				throw std::runtime_error("Stream Read request extends beyond the end of the buffered stream.");
+			}
+		}
+
+		// Peeks from the buffer, reading more of the wrapped stream only if needed
+		void PeekImplementation(void* buffer, std::size_t size) override {
+			if (size > bufferSize) {
+				BidirectionalReader::PeekImplementation(buffer, size);
+				return;
+			}
+
+			while (bufferLength - bufferOffset < size) {
+				if (FillBuffer() == 0) {
+					throw std::runtime_error("Stream Peek request extends beyond the end of the buffered stream.");
+				}
+			}
+
+			std::memcpy(buffer, readBuffer.data() + bufferOffset, size);
+		}
+
+	private:
+		// Reads up to size bytes, returning the number read, which is less than size only at the end of the stream
+		std::size_t ReadBuffered(void* buffer, std::size_t size) {
+			auto* destination = static_cast<uint8_t*>(buffer);
+			std::size_t bytesCopied = CopyFromBuffer(destination, size);
+
+			while (bytesCopied < size) {
+				// The buffer is empty here, so the wrapped stream is at the read position
+				const auto bytesLeft = size - bytesCopied;
+				if (bytesLeft >= bufferSize || bytesLeft >= Length() - Position()) {
+					const auto bytesRead = wrappedStream.ReadPartial(destination + bytesCopied, bytesLeft);
+					DiscardBuffer(bufferPosition + bufferLength + bytesRead);
+					return bytesCopied + bytesRead;
+				}
+
+				if (FillBuffer() == 0) {
+					break;
+				}
+				bytesCopied += CopyFromBuffer(destination + bytesCopied, bytesLeft);
+			}
+
+			return bytesCopied;
+		}
+
+		std::size_t CopyFromBuffer(uint8_t* destination, std::size_t size) {
+			const auto copySize = std::min(size, bufferLength - bufferOffset);
+			std::memcpy(destination, readBuffer.data() + bufferOffset, copySize);
+			bufferOffset += copySize;
+			return copySize;
+		}
+
+		// Moves unread bytes to the front of the buffer, and fills the rest from the wrapped stream
+		// Returns the number of bytes read from the wrapped stream
+		std::size_t FillBuffer() {
+			std::copy(readBuffer.begin() + bufferOffset, readBuffer.begin() + bufferLength, readBuffer.begin());
+			bufferPosition += bufferOffset;
+			bufferLength -= bufferOffset;
+			bufferOffset = 0;
+
+			// Never buffer past the end of the wrapped stream, so short streams only allocate what they hold
+			const auto fillSize = static_cast<std::size_t>(std::min<uint64_t>(bufferSize - bufferLength, Length() - (bufferPosition + bufferLength)));
+			if (readBuffer.size() < bufferLength + fillSize) {
+				readBuffer.resize(bufferLength + fillSize);
+			}
+
+			const auto bytesRead = wrappedStream.ReadPartial(readBuffer.data() + bufferLength, fillSize);
+			bufferLength += bytesRead;
+			return bytesRead;
+		}
+
+		// Empties the buffer, once the wrapped stream has moved to position
+		void DiscardBuffer(uint64_t position) {
+			bufferPosition = position;
+			bufferOffset = 0;
+			bufferLength = 0;
+		}
+
+
+		WrappedStreamType wrappedStream;
+		const std::size_t bufferSize;
+		std::vector<uint8_t> readBuffer; // Allocated on first use
+		uint64_t bufferPosition; // Position of the start of readBuffer within the wrapped stream
+		std::size_t bufferOffset; // Read position within readBuffer
+		std::size_t bufferLength; // Bytes of readBuffer holding data. The wrapped stream is positioned just after them.
+	};
+}
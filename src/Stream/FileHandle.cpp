@@ -0,0 +1,123 @@
+#include "FileHandle.h"
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace OP2Utility::Stream
+{
+#ifdef _WIN32
+	FileHandle::FileHandle(const std::string& filename) :
+		filename(filename),
+		size(0),
+		handle(INVALID_HANDLE_VALUE)
+	{
+		handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("Could not open file: " + filename);
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(handle, &fileSize)) {
+			CloseHandle(handle);
+			throw std::runtime_error("Could not determine the size of file: " + filename);
+		}
+		size = static_cast<uint64_t>(fileSize.QuadPart);
+	}
+
+	FileHandle::~FileHandle()
+	{
+		CloseHandle(handle);
+	}
+
+	std::size_t FileHandle::ReadAt(uint64_t position, void* buffer, std::size_t size) const
+	{
+		std::size_t totalBytesRead = 0;
+		while (totalBytesRead < size)
+		{
+			// The offset is passed with each read, so no shared file position is used
+			OVERLAPPED overlapped{};
+			const uint64_t readPosition = position + totalBytesRead;
+			overlapped.Offset = static_cast<DWORD>(readPosition);
+			overlapped.OffsetHigh = static_cast<DWORD>(readPosition >> 32);
+
+			const DWORD readSize = static_cast<DWORD>(std::min<std::size_t>(size - totalBytesRead, std::numeric_limits<DWORD>::max()));
+			DWORD bytesRead = 0;
+			if (!::ReadFile(handle, static_cast<char*>(buffer) + totalBytesRead, readSize, &bytesRead, &overlapped)) {
+				if (GetLastError() == ERROR_HANDLE_EOF) {
+					break;
+				}
+				throw std::runtime_error("Error reading from file " + filename);
+			}
+			if (bytesRead == 0) {
+				break;
+			}
+			totalBytesRead += bytesRead;
+		}
+
+		return totalBytesRead;
+	}
+#else
+	FileHandle::FileHandle(const std::string& filename) :
+		filename(filename),
+		size(0),
+		fileDescriptor(open(filename.c_str(), O_RDONLY))
+	{
+		if (fileDescriptor < 0) {
+			throw std::runtime_error("Could not open file: " + filename);
+		}
+
+		struct stat fileStatus;
+		if (fstat(fileDescriptor, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode)) {
+			close(fileDescriptor);
+			throw std::runtime_error("Could not open file: " + filename);
+		}
+		size = static_cast<uint64_t>(fileStatus.st_size);
+	}
+
+	FileHandle::~FileHandle()
+	{
+		close(fileDescriptor);
+	}
+
+	std::size_t FileHandle::ReadAt(uint64_t position, void* buffer, std::size_t size) const
+	{
+		std::size_t totalBytesRead = 0;
+		while (totalBytesRead < size)
+		{
+			// pread does not use or change the file position
+			const std::size_t readSize = std::min<std::size_t>(size - totalBytesRead, std::numeric_limits<ssize_t>::max());
+			const ssize_t bytesRead = pread(fileDescriptor, static_cast<char*>(buffer) + totalBytesRead, readSize, static_cast<off_t>(position + totalBytesRead));
+			if (bytesRead < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::runtime_error("Error reading from file " + filename);
+			}
+			if (bytesRead == 0) {
+				break;
+			}
+			totalBytesRead += static_cast<std::size_t>(bytesRead);
+		}
+
+		return totalBytesRead;
+	}
+#endif
+
+	void FileHandle::ReadExactAt(uint64_t position, void* buffer, std::size_t size) const
+	{
+		if (ReadAt(position, buffer, size) != size) {
+			throw std::runtime_error("Read of " + std::to_string(size) + " bytes at position " + std::to_string(position) +
+				" extends past the end of file " + filename);
+		}
+	}
+}
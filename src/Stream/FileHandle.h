@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace OP2Utility::Stream
+{
+	// Read-only file handle supporting positional reads.
+	// Reads do not use or change a shared file position, so a single handle
+	// may be read from by many threads concurrently.
+	class FileHandle
+	{
+	public:
+		FileHandle(const std::string& filename);
+		~FileHandle();
+
+		FileHandle(const FileHandle&) = delete;
+		FileHandle& operator=(const FileHandle&) = delete;
+
+		// Reads up to size bytes starting at position. Returns the number of bytes read,
+		// which is less than size only at the end of the file.
+		std::size_t ReadAt(uint64_t position, void* buffer, std::size_t size) const;
+
+		// Reads exactly size bytes starting at position, or throws
+		void ReadExactAt(uint64_t position, void* buffer, std::size_t size) const;
+
+		// File size at the time it was opened
+		uint64_t Size() const { return size; }
+
+		const std::string& GetFilename() const {
+			return filename;
+		}
+
+	private:
+		const std::string filename;
+		uint64_t size;
+#ifdef _WIN32
+		void* handle;
+#else
+		int fileDescriptor;
+#endif
+	};
+}
@@ -0,0 +1,115 @@
+#include "FileHandleReader.h"
+#include <stdexcept>
+#include <limits>
+#include <utility>
+
+namespace OP2Utility::Stream
+{
+	FileHandleReader::FileHandleReader(std::shared_ptr<const FileHandle> fileHandle) :
+		FileHandleReader(fileHandle, 0, fileHandle ? fileHandle->Size() : 0)
+	{ }
+
+	FileHandleReader::FileHandleReader(std::shared_ptr<const FileHandle> fileHandle, uint64_t startingOffset, uint64_t length) :
+		fileHandle(std::move(fileHandle)),
+		startingOffset(startingOffset),
+		length(length),
+		position(0)
+	{
+		if (!this->fileHandle) {
+			throw std::runtime_error("FileHandleReader requires a file handle");
+		}
+
+		if (length > std::numeric_limits<uint64_t>::max() - startingOffset ||
+			startingOffset + length > this->fileHandle->Size())
+		{
+			throw std::runtime_error("The stream slice would run past the end of the source stream." + IdentifySource());
+		}
+	}
+
+	std::size_t FileHandleReader::ReadPartial(void* buffer, std::size_t size) noexcept
+	{
+		const auto bytesLeft = length - position;
+		// Note: if !(size < bytesLeft) then bytesLeft fits within a size_t
+		const std::size_t readSize = (size < bytesLeft) ? size : static_cast<std::size_t>(bytesLeft);
+
+		try {
+			const auto bytesRead = fileHandle->ReadAt(startingOffset + position, buffer, readSize);
+			position += bytesRead;
+			return bytesRead;
+		}
+		catch (const std::exception&) {
+			return 0;
+		}
+	}
+
+	void FileHandleReader::ReadImplementation(void* buffer, std::size_t size)
+	{
+		if (size > length - position) {
+			throw std::runtime_error("Stream Read request extends beyond the bounds of the stream slice." + IdentifySource());
+		}
+
+		fileHandle->ReadExactAt(startingOffset + position, buffer, size);
+		position += size;
+	}
+
+	uint64_t FileHandleReader::Length()
+	{
+		return length;
+	}
+
+	uint64_t FileHandleReader::Position()
+	{
+		return position;
+	}
+
+	void FileHandleReader::Seek(uint64_t position)
+	{
+		if (position > length) {
+			throw std::runtime_error("Seek to absolute offset of " + std::to_string(position) + " is beyond the bounds of the stream slice." + IdentifySource());
+		}
+
+		this->position = position;
+	}
+
+	void FileHandleReader::SeekForward(uint64_t offset)
+	{
+		if (offset > length - position) {
+			throw std::runtime_error("Seek forward by offset of " + std::to_string(offset) + " is beyond the bounds of the stream slice." + IdentifySource());
+		}
+
+		position += offset;
+	}
+
+	void FileHandleReader::SeekBackward(uint64_t offset)
+	{
+		if (offset > position) {
+			throw std::runtime_error("Seek backward by offset of " + std::to_string(offset) + " is beyond the bounds of the stream slice." + IdentifySource());
+		}
+
+		position -= offset;
+	}
+
+	FileHandleReader FileHandleReader::Slice(uint64_t sliceLength)
+	{
+		auto slice = Slice(position, sliceLength);
+
+		// Wait until slice is successfully created before seeking forward.
+		SeekForward(sliceLength);
+
+		return slice;
+	}
+
+	FileHandleReader FileHandleReader::Slice(uint64_t sliceStartPosition, uint64_t sliceLength) const
+	{
+		if (sliceStartPosition > length || sliceLength > length - sliceStartPosition) {
+			throw std::runtime_error("Requested stream slice exceeds the bounds of current stream slice." + IdentifySource());
+		}
+
+		return FileHandleReader(fileHandle, startingOffset + sliceStartPosition, sliceLength);
+	}
+
+	std::string FileHandleReader::IdentifySource() const
+	{
+		return " Source stream: " + (fileHandle ? fileHandle->GetFilename() : std::string());
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "BidirectionalReader.h"
+#include "FileHandle.h"
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace OP2Utility::Stream
+{
+	// Reads a range of a shared FileHandle, keeping its own position.
+	// Data is read with positional reads, so any number of readers may share
+	// one FileHandle across threads. Copies and slices share the FileHandle.
+	class FileHandleReader : public BidirectionalReader
+	{
+	public:
+		// Reads the whole file
+		FileHandleReader(std::shared_ptr<const FileHandle> fileHandle);
+		// Reads length bytes of the file starting at startingOffset
+		FileHandleReader(std::shared_ptr<const FileHandle> fileHandle, uint64_t startingOffset, uint64_t length);
+
+		std::size_t ReadPartial(void* buffer, std::size_t size) noexcept override;
+
+		// BidirectionalReader methods
+		uint64_t Length() override;
+		uint64_t Position() override;
+
+		void Seek(uint64_t position) override;
+		void SeekForward(uint64_t offset) override;
+		void SeekBackward(uint64_t offset) override;
+
+		// Create a slice of the stream for independent processing. Starts at current position of stream.
+		// Seeks this stream forward the slice's length if creation is successful.
+		FileHandleReader Slice(uint64_t sliceLength);
+
+		// Create a slice of the stream for independent processing.
+		FileHandleReader Slice(uint64_t sliceStartPosition, uint64_t sliceLength) const;
+
+		const std::string& GetFilename() const {
+			return fileHandle->GetFilename();
+		}
+
+	protected:
+		void ReadImplementation(void* buffer, std::size_t size) override;
+
+	private:
+		std::string IdentifySource() const;
+
+		std::shared_ptr<const FileHandle> fileHandle;
+		uint64_t startingOffset;
+		uint64_t length;
+		uint64_t position;
+	};
+}
@@ -1,83 +1,125 @@
 #include "FileReader.h"
+#include "FileHandle.h"
 #include "SliceReader.h"
 #include <stdexcept>
+#include <algorithm>
+#include <cstring>
 
 namespace OP2Utility::Stream
 {
-	// Defers calls to C++ standard library methods
-	FileReader::FileReader(std::string filename) :
+	FileReader::FileReader(std::string filename, std::size_t bufferSize) :
 		filename(filename),
-		file(filename, std::ios::in | std::ios::binary)
-	{
-		Initialize();
-	}
+		fileHandle(std::make_shared<const FileHandle>(filename)),
+		length(fileHandle->Size()),
+		position(0),
+		bufferSize(std::max<std::size_t>(bufferSize, 1)),
+		bufferPosition(0),
+		bufferLength(0)
+	{ }
 
 	FileReader::FileReader(const FileReader& fileStreamReader) :
+		FileReader(fileStreamReader, fileStreamReader.length)
+	{ }
+
+	FileReader::FileReader(const FileReader& fileStreamReader, uint64_t length) :
 		filename(fileStreamReader.filename),
-		file(fileStreamReader.filename, std::ios::in | std::ios::binary)
-	{
-		Initialize();
-	}
+		fileHandle(fileStreamReader.fileHandle),
+		length(std::min(length, fileStreamReader.length)),
+		position(0),
+		bufferSize(fileStreamReader.bufferSize),
+		bufferPosition(0),
+		bufferLength(0)
+	{ }
 
-	void FileReader::Initialize()
-	{
-		if (!file.is_open()) {
-			throw std::runtime_error("Could not open file: " + filename);
+	FileReader::~FileReader() { }
+
+	void FileReader::ReadImplementation(void* buffer, std::size_t size) {
+		if (size > length - position || ReadBuffered(buffer, size) < size) {
+			throw std::runtime_error("Error reading from file " + filename);
 		}
 	}
 
-	FileReader::~FileReader() {
-		file.close();
-	}
+	std::size_t FileReader::ReadPartial(void* buffer, std::size_t size) noexcept {
+		const auto bytesLeft = length - position;
+		// Note: if !(size < bytesLeft) then bytesLeft fits within a size_t
+		const std::size_t readSize = (size < bytesLeft) ? size : static_cast<std::size_t>(bytesLeft);
 
-	void FileReader::ReadImplementation(void* buffer, std::size_t size) {
-		file.read(static_cast<char*>(buffer), size);
-		// Check stream flags for errors
-		if (!file) {
-			throw std::runtime_error("Error reading from file");
+		try {
+			return ReadBuffered(buffer, readSize);
+		}
+		catch (const std::exception&) {
+			return 0;
 		}
 	}
 
-	std::size_t FileReader::ReadPartial(void* buffer, std::size_t size) noexcept {
-		file.read(static_cast<char*>(buffer), size);
-		// Note: number of unformatted bytes read, up to size, must fit within a size_t
-		return static_cast<std::size_t>(file.gcount());
+	std::size_t FileReader::ReadBuffered(void* buffer, std::size_t size)
+	{
+		auto* destination = static_cast<uint8_t*>(buffer);
+		std::size_t bytesCopied = 0;
+
+		while (bytesCopied < size)
+		{
+			if (position >= bufferPosition && position - bufferPosition < bufferLength) {
+				const auto bufferOffset = static_cast<std::size_t>(position - bufferPosition);
+				const auto copySize = std::min(size - bytesCopied, bufferLength - bufferOffset);
+				std::memcpy(destination + bytesCopied, readBuffer.data() + bufferOffset, copySize);
+				bytesCopied += copySize;
+				position += copySize;
+				continue;
+			}
+
+			const auto bytesLeft = size - bytesCopied;
+			if (bytesLeft >= bufferSize) {
+				const auto bytesRead = fileHandle->ReadAt(position, destination + bytesCopied, bytesLeft);
+				bytesCopied += bytesRead;
+				position += bytesRead;
+				break;
+			}
+
+			// Never read past length, so a slice only reads and buffers its own bytes
+			readBuffer.resize(static_cast<std::size_t>(std::min<uint64_t>(bufferSize, length - position)));
+			bufferPosition = position;
+			bufferLength = fileHandle->ReadAt(position, readBuffer.data(), readBuffer.size());
+			if (bufferLength == 0) {
+				break;
+			}
+		}
+
+		return bytesCopied;
 	}
 
 	uint64_t FileReader::Length() {
-		auto currentPosition = file.tellg();  // Record current position
-		file.seekg(0, std::ios_base::end);    // Seek to end of file
-		auto streamSize = file.tellg();       // Record current position (length of file)
-		file.seekg(currentPosition);          // Restore position
-		return streamSize;
+		return length;
 	}
 
 	uint64_t FileReader::Position() {
-		return file.tellg();  // Return the current get pointer
+		return position;
 	}
 
 	void FileReader::Seek(uint64_t position) {
-		file.seekg(position);
+		if (position > length) {
+			throw std::runtime_error("Seek to absolute offset of " + std::to_string(position) + " is beyond the bounds of file " + filename);
+		}
+
+		this->position = position;
 	}
 
-	void FileReader::SeekForward(uint64_t offset) 
+	void FileReader::SeekForward(uint64_t offset)
 	{
-		uint64_t newPosition = Position() + offset;
-
-		if (newPosition < Position()) {
+		if (offset > length - position) {
 			throw std::runtime_error("Change in offset puts read position beyond possible bounds of file " + filename);
 		}
 
-		file.seekg(newPosition);
+		position += offset;
 	}
 
 	void FileReader::SeekBackward(uint64_t offset)
 	{
-		if (offset > Position()) {
+		if (offset > position) {
 			throw std::runtime_error("Change in offset puts read position before beginning bounds of file " + filename);
 		}
-		
-		file.seekg(Position() - offset);
+
+		position -= offset;
 	}
 
 	FileSliceReader FileReader::Slice(uint64_t sliceLength)
@@ -91,6 +133,7 @@ namespace OP2Utility::Stream
 	}
 
 	FileSliceReader FileReader::Slice(uint64_t sliceStartPosition, uint64_t sliceLength) const {
-		return FileSliceReader(filename, sliceStartPosition, sliceLength);
+		// The slice's reader ends with the slice. An overflowing end is rejected by the slice.
+		return FileSliceReader(FileReader(*this, sliceStartPosition + sliceLength), sliceStartPosition, sliceLength);
 	}
 }
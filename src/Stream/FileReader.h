@@ -2,19 +2,26 @@
 
 #include "BidirectionalReader.h"
 #include <string>
-#include <fstream>
+#include <vector>
+#include <memory>
 #include <cstddef>
 #include <cstdint>
 
 namespace OP2Utility::Stream
 {
+	class FileHandle;
 	class FileReader;
 	template <class WrappedStreamType> class SliceReader;
 	using FileSliceReader = SliceReader<FileReader>;
 
+	// Reads a file with positional reads, keeping its own position, and the length found when opened.
+	// Small reads are served from an internal buffer of bufferSize bytes, refilled one large read at a time.
+	// Reads of at least bufferSize bytes go straight to the caller's buffer.
+	// Seeks only move the position, so seeking within the buffered range does not read the file again.
 	class FileReader : public BidirectionalReader {
 	public:
-		FileReader(std::string filename);
+		FileReader(std::string filename, std::size_t bufferSize = DefaultBufferSize);
+		// Shares the open file, with an independent position and buffer. Does not reopen the file.
 		FileReader(const FileReader& fileStreamReader);
 		~FileReader() override;
 
@@ -39,13 +46,26 @@ namespace OP2Utility::Stream
 			return filename;
 		}
 
+		static constexpr std::size_t DefaultBufferSize = 0x4000;
+
 	protected:
 		void ReadImplementation(void* buffer, std::size_t size) override;
 
 	private:
-		void Initialize();
+		// Shares the open file, reading no further than length
+		FileReader(const FileReader& fileStreamReader, uint64_t length);
+
+		// Reads up to size bytes, returning the number read, which is less than size only at the end of the file
+		std::size_t ReadBuffered(void* buffer, std::size_t size);
 
 		const std::string filename;
-		std::ifstream file;
+		std::shared_ptr<const FileHandle> fileHandle;
+		uint64_t length;
+		uint64_t position;
+
+		const std::size_t bufferSize;
+		std::vector<uint8_t> readBuffer; // Allocated on first use
+		uint64_t bufferPosition; // File position of the start of readBuffer
+		std::size_t bufferLength; // Bytes of readBuffer holding file data
 	};
 }
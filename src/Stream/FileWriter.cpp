@@ -1,6 +1,9 @@
 #include "FileWriter.h"
 #include "../XFile.h"
 #include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <string>
 
 
 namespace OP2Utility::Stream
@@ -27,6 +30,10 @@ namespace OP2Utility::Stream
 		if ((openMode & OpenMode::Truncate) != 0) {
 			iosOpenMode |= std::ios_base::trunc;
 		}
+		else if (XFile::PathExists(filename)) {
+			// Output only mode truncates, so existing contents are kept by also opening for input
+			iosOpenMode |= std::ios_base::in;
+		}
 		if ((openMode & OpenMode::Append) != 0) {
 			iosOpenMode |= std::ios_base::ate;
 		}
@@ -34,8 +41,11 @@ namespace OP2Utility::Stream
 	}
 
 
-	FileWriter::FileWriter(const std::string& filename, OpenMode openMode) :
-		filename(filename)
+	FileWriter::FileWriter(const std::string& filename, OpenMode openMode, std::size_t bufferSize) :
+		filename(filename),
+		position(0),
+		bufferSize(std::max<std::size_t>(bufferSize, 1)),
+		bufferLength(0)
 	{
 		if (filename.empty()) {
 			throw std::runtime_error("Empty filename provided.");
@@ -61,25 +71,81 @@ namespace OP2Utility::Stream
 		if (!file.is_open()) {
 			throw std::runtime_error("File could not be opened. Filename: " + filename);
 		}
+
+		// Append mode opens at the end of the file
+		position = file.tellp();
 	}
 
 	FileWriter::FileWriter(FileWriter&& fileWriter) noexcept :
 		filename(fileWriter.filename),
-		file(std::move(fileWriter.file))
+		file(std::move(fileWriter.file)),
+		position(fileWriter.position),
+		bufferSize(fileWriter.bufferSize),
+		writeBuffer(std::move(fileWriter.writeBuffer)),
+		bufferLength(fileWriter.bufferLength)
 	{
+		fileWriter.bufferLength = 0;
 	}
 
 	FileWriter::~FileWriter() {
+		try {
+			WriteBuffer();
+		}
+		catch (const std::exception&) {
+			// Destructors must not throw
+		}
+
 		file.close();
 	}
 
+	void FileWriter::Flush()
+	{
+		WriteBuffer();
+
+		if (!file.flush()) {
+			throw std::runtime_error("Error flushing file " + filename);
+		}
+	}
+
 	void FileWriter::WriteImplementation(const void* buffer, std::size_t size)
 	{
-		file.write(static_cast<const char*>(buffer), size);
+		if (size > bufferSize - bufferLength) {
+			WriteBuffer();
+		}
+
+		if (size >= bufferSize) {
+			WriteToFile(buffer, size);
+		}
+		else {
+			if (writeBuffer.empty()) {
+				writeBuffer.resize(bufferSize);
+			}
+			std::memcpy(writeBuffer.data() + bufferLength, buffer, size);
+			bufferLength += size;
+		}
+
+		position += size;
+	}
+
+	void FileWriter::WriteBuffer()
+	{
+		if (bufferLength > 0) {
+			WriteToFile(writeBuffer.data(), bufferLength);
+			bufferLength = 0;
+		}
+	}
+
+	void FileWriter::WriteToFile(const void* buffer, std::size_t size)
+	{
+		if (!file.write(static_cast<const char*>(buffer), size)) {
+			throw std::runtime_error("Error writing to file " + filename);
+		}
 	}
 
 	uint64_t FileWriter::Length()
 	{
+		WriteBuffer();
+
 		auto currentPosition = file.tellp();  // Record current position
 		file.seekp(0, std::ios_base::end);    // Seek to end of file
 		auto length = file.tellp();   // Record current position (length of file)
@@ -89,12 +155,17 @@ namespace OP2Utility::Stream
 
 	uint64_t FileWriter::Position()
 	{
-		return file.tellp();  // Return the current put pointer
+		return position;
 	}
 
 	void FileWriter::Seek(uint64_t position)
 	{
-		file.seekp(position);
+		WriteBuffer();
+
+		if (!file.seekp(position)) {
+			throw std::runtime_error("Seek to absolute offset of " + std::to_string(position) + " failed for file " + filename);
+		}
+		this->position = position;
 	}
 
 	void FileWriter::SeekForward(uint64_t offset)
@@ -105,7 +176,7 @@ namespace OP2Utility::Stream
 			throw std::runtime_error("Change in offset puts write position beyond possible bounds of file " + filename);
 		}
 
-		file.seekp(newPosition);
+		Seek(newPosition);
 	}
 
 	void FileWriter::SeekBackward(uint64_t offset)
@@ -114,6 +185,6 @@ namespace OP2Utility::Stream
 			throw std::runtime_error("Change in offset puts write position before beginning bounds of file.");
 		}
 
-		file.seekp(Position() - offset);
+		Seek(Position() - offset);
 	}
 }
@@ -3,11 +3,15 @@
 #include "BidirectionalWriter.h"
 #include <string>
 #include <fstream>
+#include <vector>
 #include <cstddef>
 #include <cstdint>
 
 namespace OP2Utility::Stream
 {
+	// Small writes are combined in an internal buffer of bufferSize bytes, written to the file when full.
+	// Writes of at least bufferSize bytes go straight to the file.
+	// Buffered data is written before seeking, when Flush is called, and on destruction.
 	class FileWriter : public BidirectionalWriter
 	{
 	public:
@@ -26,10 +30,14 @@ namespace OP2Utility::Stream
 		//   CanOpenExisting
 		//   CanOpenNew
 		// If both flags are specified, no race condition can occur
-		FileWriter(const std::string& filename, OpenMode openMode = OpenMode::Default);
+		FileWriter(const std::string& filename, OpenMode openMode = OpenMode::Default, std::size_t bufferSize = DefaultBufferSize);
 		FileWriter(FileWriter&& fileWriter) noexcept;
+		// Errors writing buffered data are ignored. Call Flush first to detect them.
 		~FileWriter() override;
 
+		// Writes buffered data, and passes it on to the operating system
+		void Flush();
+
 		// SeekableWriter methods
 		uint64_t Length() override;
 		uint64_t Position() override;
@@ -42,13 +50,24 @@ namespace OP2Utility::Stream
 			return filename;
 		}
 
+		static constexpr std::size_t DefaultBufferSize = 0x4000;
+
 	protected:
 		void WriteImplementation(const void* buffer, std::size_t size) override;
 
 		static std::ios_base::openmode TranslateFlags(const std::string& filename, OpenMode openMode);
 
 	private:
+		// Writes buffered data to the file stream
+		void WriteBuffer();
+		void WriteToFile(const void* buffer, std::size_t size);
+
 		const std::string filename;
 		std::ofstream file;
+		uint64_t position;
+
+		const std::size_t bufferSize;
+		std::vector<uint8_t> writeBuffer; // Allocated on first use
+		std::size_t bufferLength; // Bytes of writeBuffer to be written, ending at position
 	};
 }
@@ -0,0 +1,106 @@
+#include "MemoryMappedFile.h"
+#include <stdexcept>
+#include <limits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace OP2Utility::Stream
+{
+#ifdef _WIN32
+	MemoryMappedFile::MemoryMappedFile(const std::string& filename) :
+		filename(filename),
+		data(nullptr),
+		size(0),
+		fileHandle(INVALID_HANDLE_VALUE),
+		mappingHandle(nullptr)
+	{
+		fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("Could not open file: " + filename);
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || static_cast<uint64_t>(fileSize.QuadPart) > std::numeric_limits<std::size_t>::max()) {
+			Unmap();
+			throw std::runtime_error("Could not determine a mappable size for file: " + filename);
+		}
+		size = static_cast<std::size_t>(fileSize.QuadPart);
+
+		// Empty files can not be mapped
+		if (size == 0) {
+			return;
+		}
+
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		data = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data) {
+			Unmap();
+			throw std::runtime_error("Could not memory map file: " + filename);
+		}
+	}
+
+	void MemoryMappedFile::Unmap()
+	{
+		if (data) {
+			UnmapViewOfFile(data);
+		}
+		if (mappingHandle) {
+			CloseHandle(mappingHandle);
+		}
+		if (fileHandle != INVALID_HANDLE_VALUE) {
+			CloseHandle(fileHandle);
+		}
+	}
+#else
+	MemoryMappedFile::MemoryMappedFile(const std::string& filename) :
+		filename(filename),
+		data(nullptr),
+		size(0)
+	{
+		const int fileDescriptor = open(filename.c_str(), O_RDONLY);
+		if (fileDescriptor < 0) {
+			throw std::runtime_error("Could not open file: " + filename);
+		}
+
+		struct stat fileStatus;
+		if (fstat(fileDescriptor, &fileStatus) != 0 || static_cast<uint64_t>(fileStatus.st_size) > std::numeric_limits<std::size_t>::max()) {
+			close(fileDescriptor);
+			throw std::runtime_error("Could not determine a mappable size for file: " + filename);
+		}
+		size = static_cast<std::size_t>(fileStatus.st_size);
+
+		// Empty files can not be mapped
+		if (size > 0) {
+			void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+			if (mapping == MAP_FAILED) {
+				close(fileDescriptor);
+				throw std::runtime_error("Could not memory map file: " + filename);
+			}
+			data = mapping;
+		}
+
+		// The mapping remains valid after the file is closed
+		close(fileDescriptor);
+	}
+
+	void MemoryMappedFile::Unmap()
+	{
+		if (data) {
+			munmap(const_cast<void*>(data), size);
+		}
+	}
+#endif
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		Unmap();
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace OP2Utility::Stream
+{
+	// Read-only memory mapping of an entire file.
+	// The file contents can be accessed directly in memory for the lifetime of the object.
+	class MemoryMappedFile
+	{
+	public:
+		MemoryMappedFile(const std::string& filename);
+		~MemoryMappedFile();
+
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+		// Returns nullptr for an empty file
+		const void* Data() const { return data; }
+		std::size_t Size() const { return size; }
+
+		const std::string& GetFilename() const {
+			return filename;
+		}
+
+	private:
+		void Unmap();
+
+		const std::string filename;
+		const void* data;
+		std::size_t size;
+#ifdef _WIN32
+		void* fileHandle;
+		void* mappingHandle;
+#endif
+	};
+}
@@ -23,11 +23,22 @@ namespace OP2Utility::Stream
 		std::size_t bytesTransferred = (size < bytesLeft) ? size : bytesLeft;
 
 		std::memcpy(buffer, streamBuffer + position, bytesTransferred);
-		position += size;
+		position += bytesTransferred;
 
 		return bytesTransferred;
 	}
 
+	const void* MemoryReader::TryGetContiguous(std::size_t size) noexcept {
+		if (size > streamSize - position) {
+			return nullptr;
+		}
+
+		const char* data = streamBuffer + position;
+		position += size;
+
+		return data;
+	}
+
 	uint64_t MemoryReader::Length() {
 		return streamSize;
 	}
@@ -11,6 +11,7 @@ namespace OP2Utility::Stream
 		MemoryReader(const void* const buffer, std::size_t size);
 
 		std::size_t ReadPartial(void* buffer, std::size_t size) noexcept override;
+		const void* TryGetContiguous(std::size_t size) noexcept override;
 
 		// BidirectionalReader methods
 		uint64_t Length() override;
@@ -5,6 +5,22 @@ namespace OP2Utility::Stream
 {
 	Reader::~Reader() = default;
 
+	const void* Reader::TryGetContiguous(std::size_t) noexcept
+	{
+		return nullptr;
+	}
+
+	const uint8_t* Reader::Borrow(std::size_t size, std::vector<uint8_t>& copyBuffer)
+	{
+		if (const auto* data = TryGetContiguous(size)) {
+			return static_cast<const uint8_t*>(data);
+		}
+
+		copyBuffer.resize(size);
+		Read(copyBuffer.data(), size);
+		return copyBuffer.data();
+	}
+
 
 	std::string Reader::ReadNullTerminatedString(std::size_t maxCount)
 	{
@@ -22,6 +22,11 @@ namespace OP2Utility::Stream
 		// This method is similar to Read, except it does not raise an exception if the buffer can not be filled
 		virtual std::size_t ReadPartial(void* buffer, std::size_t size) noexcept = 0;
 
+		// Returns a pointer to the next size bytes in the reader's backing memory, and moves past them
+		// Returns nullptr without moving if the reader is not backed by memory, or fewer than size bytes remain
+		// The bytes stay valid for as long as the backing memory
+		virtual const void* TryGetContiguous(std::size_t size) noexcept;
+
 		constexpr Reader() = default;
 		constexpr Reader(const Reader& other) = default;
 
@@ -34,6 +39,10 @@ namespace OP2Utility::Stream
 			ReadImplementation(buffer, size);
 		}
 
+		// Returns a pointer to the next size bytes, and moves past them
+		// Points into the reader's backing memory when possible, otherwise the bytes are read into copyBuffer
+		const uint8_t* Borrow(std::size_t size, std::vector<uint8_t>& copyBuffer);
+
 		// Inline templated convenience methods to easily read more complex types
 		// ====
 
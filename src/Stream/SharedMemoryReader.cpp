@@ -0,0 +1,10 @@
+#include "SharedMemoryReader.h"
+#include <utility>
+
+namespace OP2Utility::Stream
+{
+	SharedMemoryReader::SharedMemoryReader(std::shared_ptr<const void> owner, const void* const buffer, std::size_t size) :
+		MemoryReader(buffer, size),
+		owner(std::move(owner))
+	{ }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "MemoryReader.h"
+#include <memory>
+#include <cstddef>
+
+namespace OP2Utility::Stream
+{
+	// MemoryReader which shares ownership of the memory it reads, such as a MemoryMappedFile.
+	// The memory stays valid for the life of the reader, even if the original owner is destroyed.
+	class SharedMemoryReader : public MemoryReader {
+	public:
+		SharedMemoryReader(std::shared_ptr<const void> owner, const void* const buffer, std::size_t size);
+
+	private:
+		std::shared_ptr<const void> owner;
+	};
+}
@@ -52,6 +52,14 @@ namespace OP2Utility::Stream
 			return wrappedStream.ReadPartial(buffer, readSize);
 		}
 
+		const void* TryGetContiguous(std::size_t size) noexcept override {
+			if (size > sliceLength - Position()) {
+				return nullptr;
+			}
+
+			return wrappedStream.TryGetContiguous(size);
+		}
+
 
 		uint64_t Length() override {
 			return sliceLength;
@@ -86,6 +86,13 @@ namespace OP2Utility::Stream
 			std::size_t numBytesRead;
 
 			do {
+				// Memory backed readers are written from in place, until less than a chunk remains
+				if (const auto* data = streamReader.TryGetContiguous(BufferSize)) {
+					Write(data, BufferSize);
+					numBytesRead = BufferSize;
+					continue;
+				}
+
 				// Read the input stream
 				numBytesRead = streamReader.ReadPartial(buffer.data(), BufferSize);
 				Write(buffer.data(), numBytesRead);
@@ -265,4 +265,19 @@ namespace OP2Utility::XFile
 	{
 		fs::rename(oldPath, newPath);
 	}
+
+	uint64_t GetFileSize(const std::string& path)
+	{
+		return fs::file_size(path);
+	}
+
+	int64_t GetLastWriteTime(const std::string& path)
+	{
+		return static_cast<int64_t>(fs::last_write_time(path).time_since_epoch().count());
+	}
+
+	void ResizeFile(const std::string& path, uint64_t size)
+	{
+		fs::resize_file(path, size);
+	}
 }
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <regex>
+#include <cstdint>
 
 // Cross platform file system access.
 namespace OP2Utility::XFile
@@ -78,4 +79,12 @@ namespace OP2Utility::XFile
 	void DeletePath(const std::string& pathStr);
 
 	void RenameFile(const std::string& oldPath, const std::string& newPath);
+
+	uint64_t GetFileSize(const std::string& path);
+
+	// Time the file was last modified, in ticks of the file system clock. Only meaningful for comparisons.
+	int64_t GetLastWriteTime(const std::string& path);
+
+	// Truncates or zero extends an existing file to the given size
+	void ResizeFile(const std::string& path, uint64_t size);
 }
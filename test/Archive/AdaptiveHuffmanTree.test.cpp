@@ -44,3 +44,52 @@ TEST_F(AdaptiveHuffmanTreeOutpost2, EncodeDecode) {
 		ASSERT_EQ(i, tree.GetNodeData(node));
 	}
 }
+
+// Encoding must follow codes as they move around the tree
+TEST_F(AdaptiveHuffmanTreeOutpost2, EncodeDecodeAfterUpdates) {
+	for (unsigned int i = 0; i < 1000; ++i) {
+		tree.UpdateCodeCount((i * i) % 37);
+	}
+
+	auto codeCount = tree.TerminalNodeCount();
+	for (unsigned int i = 0; i < codeCount; ++i) {
+		unsigned int codeLength;
+		auto bitString = tree.GetEncodedBitString(i, codeLength);
+		auto node = tree.GetRootNodeIndex();
+		for (; codeLength > 0; --codeLength) {
+			ASSERT_FALSE(tree.IsLeaf(node));
+			node = tree.GetChildNode(node, bitString & 1);
+			bitString >>= 1;
+		}
+		ASSERT_TRUE(tree.IsLeaf(node));
+		ASSERT_EQ(i, tree.GetNodeData(node));
+	}
+}
+
+// The prefix table must agree with a bit at a time walk of the tree as it is restructured
+TEST_F(AdaptiveHuffmanTreeOutpost2, PrefixTableMatchesTreeWalk) {
+	const unsigned int prefixBitCount = 8;
+	tree.SetPrefixTableBitCount(prefixBitCount);
+	EXPECT_EQ(prefixBitCount, tree.PrefixTableBitCount());
+
+	for (unsigned int update = 0; update < 2000; update += 50) {
+		for (unsigned int i = update; i < update + 50; ++i) {
+			tree.UpdateCodeCount((i * i) % 61);
+		}
+
+		for (unsigned int prefix = 0; prefix < (1u << prefixBitCount); ++prefix) {
+			auto node = tree.GetRootNodeIndex();
+			unsigned int bitCount = 0;
+			while (bitCount < prefixBitCount && !tree.IsLeaf(node)) {
+				node = tree.GetChildNode(node, (prefix >> (prefixBitCount - 1 - bitCount)) & 1);
+				++bitCount;
+			}
+
+			const auto entry = tree.LookupPrefix(prefix);
+			ASSERT_EQ(node, entry.nodeIndex);
+			ASSERT_EQ(bitCount, entry.bitCount);
+		}
+	}
+
+	EXPECT_THROW(tree.SetPrefixTableBitCount(17), std::runtime_error);
+}
@@ -1,9 +1,17 @@
 #include "Archive/VolFile.h"
 #include "Archive/ClmFile.h"
+#include "Archive/DecompressedEntryCache.h"
 #include "XFile.h"
+#include "Stream/FileWriter.h"
+#include "Stream/FileReader.h"
+#include "../PseudoRandom.h"
+#include "WaveSource.h"
 #include <gtest/gtest.h>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <memory>
+#include <thread>
 
 using namespace OP2Utility;
 
@@ -27,8 +35,658 @@ TEST(VolFile, EmptyArchive)
 		EXPECT_THROW(archiveFile.GetCompressionCode(0), std::runtime_error);
 	}
 
+	{
+		Archive::VolFile archiveFile(archiveFilename, Archive::ArchiveBackend::MemoryMapped);
+
+		SCOPED_TRACE("Empty memory mapped Volume File");
+		TestEmptyArchive(archiveFile, archiveFilename);
+	}
+
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(VolFile, CreateCompressedArchive)
+{
+	const std::string archiveFilename("CompressedArchive.vol");
+	const std::string compressibleFilename("Compressible.txt");
+	const std::string incompressibleFilename("Incompressible.txt");
+
+	const std::string compressibleData(5000, 'A');
+	const std::string incompressibleData("AB");
+	{
+		Stream::FileWriter compressibleWriter(compressibleFilename);
+		compressibleWriter.Write(compressibleData.data(), compressibleData.size());
+		Stream::FileWriter incompressibleWriter(incompressibleFilename);
+		incompressibleWriter.Write(incompressibleData.data(), incompressibleData.size());
+	}
+
+	Archive::VolFile::CreateArchive(archiveFilename, { compressibleFilename, incompressibleFilename }, Archive::CompressionType::LZH);
+
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		ASSERT_EQ(2u, archiveFile.GetCount());
+
+		// Files are only stored compressed when that makes them smaller
+		auto compressibleIndex = archiveFile.GetIndex(compressibleFilename);
+		auto incompressibleIndex = archiveFile.GetIndex(incompressibleFilename);
+		EXPECT_EQ(Archive::CompressionType::LZH, archiveFile.GetCompressionCode(compressibleIndex));
+		EXPECT_EQ(Archive::CompressionType::Uncompressed, archiveFile.GetCompressionCode(incompressibleIndex));
+		EXPECT_EQ(compressibleData.size(), archiveFile.GetSize(compressibleIndex));
+
+		std::string contents(compressibleData.size(), '\0');
+		archiveFile.OpenStream(compressibleIndex)->Read(contents);
+		EXPECT_EQ(compressibleData, contents);
+
+		contents.resize(incompressibleData.size());
+		archiveFile.OpenStream(incompressibleIndex)->Read(contents);
+		EXPECT_EQ(incompressibleData, contents);
+
+		// Whole file reads, decompressing straight into the output
+		EXPECT_EQ(std::vector<uint8_t>(compressibleData.begin(), compressibleData.end()), archiveFile.ReadFile(compressibleFilename));
+		EXPECT_EQ(std::vector<uint8_t>(incompressibleData.begin(), incompressibleData.end()), archiveFile.ReadFile(incompressibleIndex));
+
+		std::vector<uint8_t> smallBuffer(compressibleData.size() - 1);
+		EXPECT_THROW(archiveFile.ReadFile(compressibleIndex, smallBuffer.data(), smallBuffer.size()), std::runtime_error);
+	}
+
+	XFile::DeletePath(archiveFilename);
+	XFile::DeletePath(compressibleFilename);
+	XFile::DeletePath(incompressibleFilename);
+}
+
+TEST(VolFile, CreateArchiveRejectsUnsupportedCompression)
+{
+	EXPECT_THROW(Archive::VolFile::CreateArchive("Unsupported.vol", {}, Archive::CompressionType::RLE), std::runtime_error);
+}
+
+TEST(VolFile, CreateArchiveAtCompressionLevel)
+{
+	const std::string archiveFilename("CompressionLevel.vol");
+
+	// Words from a small vocabulary, where higher levels find cheaper matches
+	const char* words[] = { "Eden ", "Plymouth ", "colony ", "structure ", "Eden colony ", "tube ", "12", "\r\n" };
+	std::vector<uint8_t> data;
+	PseudoRandom random(5);
+	while (data.size() < 30000) {
+		const std::string word = words[random.Next() % (sizeof(words) / sizeof(words[0]))];
+		data.insert(data.end(), word.begin(), word.end());
+	}
+	const std::vector<Archive::PackSource> sources{ Archive::PackSource::FromBuffer("Words.txt", data) };
+
+	auto archiveLength = [&]() {
+		return Stream::FileReader(archiveFilename).Length();
+	};
+	using CompressionLevel = Archive::HuffLZEncoder::CompressionLevel;
+
+	Archive::VolFile::CreateArchiveFromSources(archiveFilename, sources, Archive::CompressionType::LZH, CompressionLevel::Fast);
+	const auto fastLength = archiveLength();
+
+	Archive::VolFile::CreateArchiveFromSources(archiveFilename, sources, Archive::CompressionType::LZH, CompressionLevel::Optimal);
+	EXPECT_LT(archiveLength(), fastLength);
+	EXPECT_EQ(data, Archive::VolFile(archiveFilename).ReadFile("Words.txt"));
+
+	// Updated files are compressed at the level given for the update
+	Archive::VolFile::CreateArchiveFromSources(archiveFilename, {});
+	Archive::VolFile::UpdateArchiveFromSources(archiveFilename, sources, {}, Archive::CompressionType::LZH, CompressionLevel::Optimal);
+	EXPECT_LT(archiveLength(), fastLength);
+	EXPECT_EQ(data, Archive::VolFile(archiveFilename).ReadFile("Words.txt"));
+
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(VolFile, NameLookup)
+{
+	const std::string archiveFilename("LookupArchive.vol");
+
+	std::vector<std::string> filenames;
+	for (std::size_t i = 0; i < 50; ++i) {
+		filenames.push_back("Lookup" + std::to_string(i) + ".txt");
+		Stream::FileWriter writer(filenames.back());
+		writer.Write(filenames.back().data(), filenames.back().size());
+	}
+
+	Archive::VolFile::CreateArchive(archiveFilename, filenames);
+
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		for (std::size_t i = 0; i < archiveFile.GetCount(); ++i) {
+			EXPECT_EQ(i, archiveFile.GetIndex(archiveFile.GetName(i)));
+		}
+
+		// Lookups are case insensitive, and allow an explicit current directory
+		const auto index = archiveFile.GetIndex("Lookup7.txt");
+		EXPECT_EQ("Lookup7.txt", archiveFile.GetName(index));
+		EXPECT_EQ(index, archiveFile.GetIndex("LOOKUP7.TXT"));
+		EXPECT_EQ(index, archiveFile.GetIndex("./lookup7.txt"));
+		EXPECT_TRUE(archiveFile.Contains("lookup49.TXT"));
+		std::size_t foundIndex;
+		EXPECT_TRUE(archiveFile.FindIndex("lookup7.TXT", foundIndex));
+		EXPECT_EQ(index, foundIndex);
+
+		EXPECT_FALSE(archiveFile.Contains("Lookup50.txt"));
+		EXPECT_FALSE(archiveFile.Contains("Lookup7"));
+		EXPECT_FALSE(archiveFile.Contains("Directory/Lookup7.txt"));
+		EXPECT_FALSE(archiveFile.FindIndex("Lookup50.txt", foundIndex));
+		EXPECT_THROW(archiveFile.GetIndex("Lookup50.txt"), std::runtime_error);
+	}
+
+	XFile::DeletePath(archiveFilename);
+	for (const auto& filename : filenames) {
+		XFile::DeletePath(filename);
+	}
+}
+
+namespace {
+	void WriteTestFile(const std::string& filename, const std::string& contents)
+	{
+		Stream::FileWriter writer(filename);
+		writer.Write(contents.data(), contents.size());
+	}
+
+	std::string ReadPackedFile(Archive::VolFile& archiveFile, const std::string& name)
+	{
+		const auto contents = archiveFile.ReadFile(name);
+		return std::string(contents.begin(), contents.end());
+	}
+}
+
+TEST(VolFile, UpdateArchive)
+{
+	const std::string archiveFilename("UpdateArchive.vol");
+	const std::string contentsA(3000, 'a');
+	const std::string contentsB(2000, 'b');
+	const std::string contentsC(1000, 'c');
+	WriteTestFile("UpdateA.txt", contentsA);
+	WriteTestFile("UpdateB.txt", contentsB);
+	WriteTestFile("UpdateC.txt", contentsC);
+	Archive::VolFile::CreateArchive(archiveFilename, { "UpdateA.txt", "UpdateB.txt", "UpdateC.txt" });
+
+	// Replace a file with a smaller one, add a file with a long name, which grows the header, and remove a file
+	const std::string newContentsB("new b");
+	const std::string contentsD(500, 'd');
+	const std::string longFilename("UpdateWithALongerFilenameThanTheOthers.txt");
+	WriteTestFile("UpdateB.txt", newContentsB);
+	WriteTestFile(longFilename, contentsD);
+	Archive::VolFile::UpdateArchive(archiveFilename, { longFilename, "UpdateB.txt" }, { "updatec.txt" });
+
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		ASSERT_EQ(3u, archiveFile.GetCount());
+
+		// Names remain sorted
+		EXPECT_EQ("UpdateA.txt", archiveFile.GetName(0));
+		EXPECT_EQ("UpdateB.txt", archiveFile.GetName(1));
+		EXPECT_EQ(longFilename, archiveFile.GetName(2));
+
+		EXPECT_EQ(contentsA, ReadPackedFile(archiveFile, "UpdateA.txt"));
+		EXPECT_EQ(newContentsB, ReadPackedFile(archiveFile, "UpdateB.txt"));
+		EXPECT_EQ(contentsD, ReadPackedFile(archiveFile, longFilename));
+		EXPECT_FALSE(archiveFile.Contains("UpdateC.txt"));
+	}
+
+	// Compressed updates, and removing a missing file
+	Archive::VolFile::UpdateArchive(archiveFilename, { "UpdateC.txt" }, {}, Archive::CompressionType::LZH);
+	EXPECT_THROW(Archive::VolFile::UpdateArchive(archiveFilename, {}, { "Missing.txt" }), std::runtime_error);
+
+	const auto updatedLength = Stream::FileReader(archiveFilename).Length();
+	Archive::VolFile::CompactArchive(archiveFilename);
+	EXPECT_GT(updatedLength, Stream::FileReader(archiveFilename).Length());
+
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		ASSERT_EQ(4u, archiveFile.GetCount());
+		EXPECT_EQ(Archive::CompressionType::LZH, archiveFile.GetCompressionCode(archiveFile.GetIndex("UpdateC.txt")));
+
+		EXPECT_EQ(contentsA, ReadPackedFile(archiveFile, "UpdateA.txt"));
+		EXPECT_EQ(newContentsB, ReadPackedFile(archiveFile, "UpdateB.txt"));
+		EXPECT_EQ(contentsC, ReadPackedFile(archiveFile, "UpdateC.txt"));
+		EXPECT_EQ(contentsD, ReadPackedFile(archiveFile, longFilename));
+	}
+
+	XFile::DeletePath(archiveFilename);
+	for (const auto& filename : { "UpdateA.txt", "UpdateB.txt", "UpdateC.txt" }) {
+		XFile::DeletePath(filename);
+	}
+	XFile::DeletePath(longFilename);
+}
+
+TEST(VolFile, CreateArchiveFromSources)
+{
+	const std::string archiveFilename("SourcesArchive.vol");
+
+	// Sources are opened once each, as they are packed
+	std::size_t openCount = 0;
+	std::vector<Archive::PackSource> sources;
+	for (std::size_t i = 0; i < 20; ++i) {
+		auto bufferSource = Archive::PackSource::FromBuffer("Source" + std::to_string(i) + ".txt", std::vector<uint8_t>(100 + i, static_cast<uint8_t>(i)));
+		sources.push_back(Archive::PackSource{ bufferSource.name, bufferSource.size, [bufferSource, &openCount]() {
+			++openCount;
+			return bufferSource.Open();
+		} });
+	}
+
+	for (auto compressionType : { Archive::CompressionType::Uncompressed, Archive::CompressionType::LZH }) {
+		openCount = 0;
+		Archive::VolFile::CreateArchiveFromSources(archiveFilename, sources, compressionType);
+		EXPECT_EQ(sources.size(), openCount);
+
+		Archive::VolFile archiveFile(archiveFilename);
+		ASSERT_EQ(sources.size(), archiveFile.GetCount());
+		for (std::size_t i = 0; i < sources.size(); ++i) {
+			EXPECT_EQ(std::vector<uint8_t>(100 + i, static_cast<uint8_t>(i)), archiveFile.ReadFile("Source" + std::to_string(i) + ".txt"));
+		}
+	}
+
+	// Names must not be duplicated
+	sources.push_back(Archive::PackSource::FromBuffer("Source0.txt", {}));
+	EXPECT_THROW(Archive::VolFile::CreateArchiveFromSources(archiveFilename, sources), std::runtime_error);
+
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(VolFile, CreateArchiveCompressesInParallel)
+{
+	const std::string serialFilename("SerialArchive.vol");
+	const std::string parallelFilename("ParallelArchive.vol");
+
+	// Mix of compressible, incompressible and empty files
+	std::vector<Archive::PackSource> sources;
+	PseudoRandom random(1);
+	for (std::size_t i = 0; i < 30; ++i) {
+		std::vector<uint8_t> contents((i % 7) * 300);
+		for (std::size_t j = 0; j < contents.size(); ++j) {
+			contents[j] = (i % 2 == 0) ? static_cast<uint8_t>(j / 16) : static_cast<uint8_t>(random.Next());
+		}
+		sources.push_back(Archive::PackSource::FromBuffer("Parallel" + std::to_string(i) + ".txt", std::move(contents)));
+	}
+
+	auto readWholeFile = [](const std::string& filename) {
+		Stream::FileReader fileReader(filename);
+		std::vector<uint8_t> contents(static_cast<std::size_t>(fileReader.Length()));
+		fileReader.Read(contents);
+		return contents;
+	};
+
+	Archive::VolFile::CreateArchiveFromSources(serialFilename, sources, Archive::CompressionType::LZH);
+	const auto serialContents = readWholeFile(serialFilename);
+
+	// Output does not depend on the number of threads
+	for (std::size_t threadCount : { 0, 2, 5 }) {
+		Archive::VolFile::CreateArchiveFromSources(parallelFilename, sources, Archive::CompressionType::LZH, Archive::HuffLZEncoder::CompressionLevel::Fast, threadCount);
+		EXPECT_EQ(serialContents, readWholeFile(parallelFilename));
+	}
+
+	// Failure to read a source is reported with its name
+	sources[10].size += 1;
+	try {
+		Archive::VolFile::CreateArchiveFromSources(parallelFilename, sources, Archive::CompressionType::LZH, Archive::HuffLZEncoder::CompressionLevel::Fast, 4);
+		FAIL();
+	}
+	catch (const std::runtime_error& e) {
+		EXPECT_NE(std::string::npos, std::string(e.what()).find("Parallel10.txt"));
+	}
+
+	XFile::DeletePath(serialFilename);
+	XFile::DeletePath(parallelFilename);
+}
+
+#ifdef __linux__
+TEST(VolFile, ExtractReportsWriteErrors)
+{
+	const std::string archiveFilename("WriteErrorArchive.vol");
+	Archive::VolFile::CreateArchiveFromSources(archiveFilename, { Archive::PackSource::FromBuffer("full", { 1, 2, 3 }) });
+
+	{
+		// Writes to /dev/full fail as if the disk were full, once the buffered contents are written out
+		Archive::VolFile archiveFile(archiveFilename);
+		const auto results = archiveFile.ExtractAllFiles("/dev", 2);
+		ASSERT_EQ(1u, results.size());
+		EXPECT_FALSE(results[0].succeeded);
+		EXPECT_THROW(archiveFile.ExtractFile(0, "/dev/full"), std::runtime_error);
+	}
+
 	XFile::DeletePath(archiveFilename);
 }
+#endif
+
+TEST(VolFile, ExtractFilesInStoredOrder)
+{
+	const std::string archiveFilename("BatchArchive.vol");
+
+	std::vector<Archive::PackSource> sources;
+	for (std::size_t i = 0; i < 20; ++i) {
+		// Mix of compressible and incompressible files, including one larger than the read buffer used below
+		std::vector<uint8_t> contents(i == 7 ? 3000 : 50 + i * 10);
+		for (std::size_t j = 0; j < contents.size(); ++j) {
+			contents[j] = static_cast<uint8_t>((i % 2 == 0) ? j / 8 : j * 37 + i);
+		}
+		sources.push_back(Archive::PackSource::FromBuffer("Batch" + std::to_string(i) + ".txt", std::move(contents)));
+	}
+
+	for (auto compressionType : { Archive::CompressionType::Uncompressed, Archive::CompressionType::LZH }) {
+		Archive::VolFile::CreateArchiveFromSources(archiveFilename, sources, compressionType);
+
+		for (auto backend : { Archive::ArchiveBackend::FileStream, Archive::ArchiveBackend::MemoryMapped }) {
+			Archive::VolFile archiveFile(archiveFilename, backend);
+
+			// Requested out of order, and with a repeat
+			const std::vector<std::string> names{ "Batch12.txt", "Batch3.txt", "Batch7.txt", "Batch0.txt", "Batch3.txt", "Batch19.txt" };
+			std::vector<std::size_t> extractedIndexes;
+			archiveFile.ExtractFiles(names, [&](std::size_t index, Stream::BidirectionalReader& contents) {
+				std::vector<uint8_t> buffer(static_cast<std::size_t>(contents.Length()));
+				contents.Read(buffer);
+				EXPECT_EQ(archiveFile.ReadFile(index), buffer);
+				extractedIndexes.push_back(index);
+			}, 1024);
+
+			// Packed files are passed to the sink in the order they are stored
+			ASSERT_EQ(names.size(), extractedIndexes.size());
+			EXPECT_TRUE(std::is_sorted(extractedIndexes.begin(), extractedIndexes.end()));
+		}
+	}
+
+	Archive::VolFile archiveFile(archiveFilename);
+	archiveFile.ExtractFiles(std::vector<std::size_t>{ 5, 1 }, "./");
+	for (std::size_t index : { 1, 5 }) {
+		const auto name = archiveFile.GetName(index);
+		Stream::FileReader extractedReader(name);
+		std::vector<uint8_t> extracted(static_cast<std::size_t>(extractedReader.Length()));
+		extractedReader.Read(extracted);
+		EXPECT_EQ(archiveFile.ReadFile(index), extracted);
+		XFile::DeletePath(name);
+	}
+
+	EXPECT_THROW(archiveFile.ExtractFiles(std::vector<std::size_t>{ 0, 20 }, "./"), std::runtime_error);
+
+	// Sink failures are reported with the packed file name
+	try {
+		archiveFile.ExtractFiles(std::vector<std::string>{ "Batch4.txt" }, [](std::size_t, Stream::BidirectionalReader&) {
+			throw std::runtime_error("Sink failure");
+		});
+		FAIL();
+	}
+	catch (const std::runtime_error& e) {
+		EXPECT_NE(std::string::npos, std::string(e.what()).find("Batch4.txt"));
+	}
+
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(VolFile, CreateArchiveDeduplicates)
+{
+	const std::string archiveFilename("DeduplicatedArchive.vol");
+	const std::string duplicatedArchiveFilename("DuplicatedArchive.vol");
+
+	const std::vector<uint8_t> tileset(4000, 7);
+	const std::vector<uint8_t> sound{ 1, 2, 3, 4, 5 };
+	std::vector<Archive::PackSource> sources{
+		Archive::PackSource::FromBuffer("Tileset1.bmp", tileset),
+		Archive::PackSource::FromBuffer("Sound1.wav", sound),
+		Archive::PackSource::FromBuffer("Tileset2.bmp", tileset),
+		Archive::PackSource::FromBuffer("Unique.txt", { 1, 2, 3, 4, 6 }),
+		Archive::PackSource::FromBuffer("Sound2.wav", sound),
+		Archive::PackSource::FromBuffer("Tileset3.bmp", tileset),
+	};
+
+	auto verifyContents = [&](const std::vector<Archive::PackSource>& expectedSources) {
+		Archive::VolFile archiveFile(archiveFilename);
+		ASSERT_EQ(expectedSources.size(), archiveFile.GetCount());
+		for (const auto& source : expectedSources) {
+			std::vector<uint8_t> expected(static_cast<std::size_t>(source.size));
+			source.Open()->Read(expected);
+			EXPECT_EQ(expected, archiveFile.ReadFile(source.name));
+		}
+	};
+
+	for (auto compressionType : { Archive::CompressionType::Uncompressed, Archive::CompressionType::LZH }) {
+		for (std::size_t threadCount : { 1, 3 }) {
+			Archive::VolFile::CreateArchiveFromSources(duplicatedArchiveFilename, sources, compressionType, Archive::HuffLZEncoder::CompressionLevel::Fast, threadCount);
+			Archive::VolFile::CreateArchiveFromSources(archiveFilename, sources, compressionType, Archive::HuffLZEncoder::CompressionLevel::Fast, threadCount, true);
+			verifyContents(sources);
+
+			const auto savedLength = XFile::GetFileSize(duplicatedArchiveFilename) - XFile::GetFileSize(archiveFilename);
+			if (compressionType == Archive::CompressionType::Uncompressed) {
+				// Two tileset blocks and a sound block, each with a section header and padding
+				EXPECT_EQ(2 * 4008u + 16u, savedLength);
+			}
+			else {
+				EXPECT_LT(0u, savedLength);
+			}
+		}
+	}
+
+	// Compacting keeps shared data blocks shared
+	const auto deduplicatedLength = XFile::GetFileSize(archiveFilename);
+	Archive::VolFile::CompactArchive(archiveFilename);
+	EXPECT_EQ(deduplicatedLength, XFile::GetFileSize(archiveFilename));
+	verifyContents(sources);
+
+	// A shared data block is kept while any packed file still uses it
+	Archive::VolFile::UpdateArchiveFromSources(archiveFilename, {}, { "Tileset1.bmp", "Sound2.wav" });
+	sources.erase(sources.begin() + 4);
+	sources.erase(sources.begin());
+	verifyContents(sources);
+
+	XFile::DeletePath(archiveFilename);
+	XFile::DeletePath(duplicatedArchiveFilename);
+}
+
+TEST(VolFile, DecompressedEntryCache)
+{
+	const std::string archiveFilename("CachedArchive.vol");
+	const std::string compressibleFilename("CachedCompressible.txt");
+	const std::string incompressibleFilename("CachedIncompressible.txt");
+
+	const std::string compressibleData(5000, 'C');
+	const std::string incompressibleData("EF");
+	{
+		Stream::FileWriter compressibleWriter(compressibleFilename);
+		compressibleWriter.Write(compressibleData.data(), compressibleData.size());
+		Stream::FileWriter incompressibleWriter(incompressibleFilename);
+		incompressibleWriter.Write(incompressibleData.data(), incompressibleData.size());
+	}
+
+	Archive::VolFile::CreateArchive(archiveFilename, { compressibleFilename, incompressibleFilename }, Archive::CompressionType::LZH);
+
+	auto cache = std::make_shared<Archive::DecompressedEntryCache>(1 << 20);
+	std::unique_ptr<Stream::BidirectionalReader> stream;
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		archiveFile.SetDecompressedEntryCache(cache);
+		const auto compressibleIndex = archiveFile.GetIndex(compressibleFilename);
+
+		for (int i = 0; i < 3; ++i) {
+			std::string contents(compressibleData.size(), '\0');
+			archiveFile.OpenStream(compressibleIndex)->Read(contents);
+			EXPECT_EQ(compressibleData, contents);
+		}
+		EXPECT_EQ(std::vector<uint8_t>(compressibleData.begin(), compressibleData.end()), archiveFile.ReadFile(compressibleIndex));
+
+		// Only compressed files are cached
+		std::string contents(incompressibleData.size(), '\0');
+		archiveFile.OpenStream(archiveFile.GetIndex(incompressibleFilename))->Read(contents);
+		EXPECT_EQ(incompressibleData, contents);
+
+		auto statistics = cache->GetStatistics();
+		EXPECT_EQ(1u, statistics.misses);
+		EXPECT_EQ(3u, statistics.hits);
+		EXPECT_EQ(1u, statistics.entryCount);
+		EXPECT_EQ(compressibleData.size(), statistics.bytesUsed);
+
+		stream = archiveFile.OpenStream(compressibleIndex);
+	}
+
+	// Closing an archive removes its entries, while open streams keep their contents
+	EXPECT_EQ(0u, cache->GetStatistics().entryCount);
+	std::string contents(compressibleData.size(), '\0');
+	stream->Read(contents);
+	EXPECT_EQ(compressibleData, contents);
+
+	XFile::DeletePath(archiveFilename);
+	XFile::DeletePath(compressibleFilename);
+	XFile::DeletePath(incompressibleFilename);
+}
+
+TEST(VolFile, ExtractAllFilesInParallel)
+{
+	const std::string archiveFilename("ParallelArchive.vol");
+	const std::string extractDirectory("./ParallelExtract");
+
+	// A mix of compressed and uncompressed files of varying sizes
+	std::vector<std::string> filenames;
+	std::vector<std::string> contents;
+	for (std::size_t i = 0; i < 12; ++i) {
+		filenames.push_back("Parallel" + std::to_string(i) + ".txt");
+		contents.push_back(i % 3 == 0 ? std::string("AB") : std::string(1000 * i, static_cast<char>('a' + i)));
+		Stream::FileWriter writer(filenames.back());
+		writer.Write(contents.back().data(), contents.back().size());
+	}
+
+	Archive::VolFile::CreateArchive(archiveFilename, filenames, Archive::CompressionType::LZH);
+	XFile::NewDirectory(extractDirectory);
+
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		auto results = archiveFile.ExtractAllFiles(extractDirectory, 4);
+
+		ASSERT_EQ(filenames.size(), results.size());
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			EXPECT_EQ(i, results[i].index);
+			EXPECT_TRUE(results[i].succeeded) << results[i].errorMessage;
+
+			auto name = archiveFile.GetName(i);
+			auto contentsIndex = std::find(filenames.begin(), filenames.end(), name) - filenames.begin();
+			std::string extracted(contents[contentsIndex].size(), '\0');
+			Stream::FileReader(results[i].pathOut).Read(extracted);
+			EXPECT_EQ(contents[contentsIndex], extracted);
+		}
+
+		// Failures are reported per file, rather than thrown
+		std::vector<Archive::ArchiveFile::ExtractionResult> failedResults;
+		EXPECT_NO_THROW(failedResults = archiveFile.ExtractAllFiles("./MissingDirectory/Missing", 4));
+		ASSERT_EQ(filenames.size(), failedResults.size());
+		for (const auto& result : failedResults) {
+			EXPECT_FALSE(result.succeeded);
+			EXPECT_FALSE(result.errorMessage.empty());
+		}
+	}
+
+	XFile::DeletePath(extractDirectory);
+	XFile::DeletePath(archiveFilename);
+	for (const auto& filename : filenames) {
+		XFile::DeletePath(filename);
+	}
+}
+
+TEST(VolFile, ConcurrentStreamsShareOneArchive)
+{
+	const std::string archiveFilename("ConcurrentArchive.vol");
+
+	std::vector<std::string> filenames;
+	std::vector<std::string> contents;
+	for (std::size_t i = 0; i < 8; ++i) {
+		filenames.push_back("Concurrent" + std::to_string(i) + ".txt");
+		contents.push_back(i % 2 == 0 ? std::string("XY") : std::string(700 * i, static_cast<char>('a' + i)));
+		Stream::FileWriter writer(filenames.back());
+		writer.Write(contents.back().data(), contents.back().size());
+	}
+
+	Archive::VolFile::CreateArchive(archiveFilename, filenames, Archive::CompressionType::LZH);
+
+	{
+		// Many threads open streams from the same archive object, with no external locking
+		Archive::VolFile archiveFile(archiveFilename);
+		std::vector<std::thread> threads;
+		std::vector<std::size_t> mismatches(4, 0);
+		for (std::size_t t = 0; t < mismatches.size(); ++t) {
+			threads.emplace_back([&, t]() {
+				for (std::size_t pass = 0; pass < 20; ++pass) {
+					for (std::size_t i = 0; i < filenames.size(); ++i) {
+						const auto index = archiveFile.GetIndex(filenames[(i + t) % filenames.size()]);
+						const auto& expected = contents[(i + t) % filenames.size()];
+
+						std::string streamed(archiveFile.GetSize(index), '\0');
+						archiveFile.OpenStream(index)->Read(streamed);
+						auto readFile = archiveFile.ReadFile(index);
+
+						mismatches[t] += (streamed != expected) || (std::string(readFile.begin(), readFile.end()) != expected);
+					}
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		for (auto mismatchCount : mismatches) {
+			EXPECT_EQ(0u, mismatchCount);
+		}
+	}
+
+	XFile::DeletePath(archiveFilename);
+	for (const auto& filename : filenames) {
+		XFile::DeletePath(filename);
+	}
+}
+
+TEST(VolFile, MemoryMappedArchive)
+{
+	const std::string archiveFilename("MappedArchive.vol");
+	const std::string compressibleFilename("MappedCompressible.txt");
+	const std::string incompressibleFilename("MappedIncompressible.txt");
+
+	const std::string compressibleData(5000, 'B');
+	const std::string incompressibleData("CD");
+	{
+		Stream::FileWriter compressibleWriter(compressibleFilename);
+		compressibleWriter.Write(compressibleData.data(), compressibleData.size());
+		Stream::FileWriter incompressibleWriter(incompressibleFilename);
+		incompressibleWriter.Write(incompressibleData.data(), incompressibleData.size());
+	}
+
+	Archive::VolFile::CreateArchive(archiveFilename, { compressibleFilename, incompressibleFilename }, Archive::CompressionType::LZH);
+
+	std::unique_ptr<Stream::BidirectionalReader> stream;
+	{
+		Archive::VolFile archiveFile(archiveFilename, Archive::ArchiveBackend::MemoryMapped);
+		EXPECT_TRUE(archiveFile.IsMemoryMapped());
+		ASSERT_EQ(2u, archiveFile.GetCount());
+		EXPECT_EQ(XFile::GetFilename(compressibleFilename), archiveFile.GetName(0));
+
+		auto compressibleIndex = archiveFile.GetIndex(compressibleFilename);
+		auto incompressibleIndex = archiveFile.GetIndex(incompressibleFilename);
+
+		// Uncompressed files can be viewed in place
+		auto view = archiveFile.GetFileView(incompressibleIndex);
+		EXPECT_EQ(incompressibleData, std::string(static_cast<const char*>(view.data), view.size));
+		EXPECT_THROW(archiveFile.GetFileView(compressibleIndex), std::runtime_error);
+
+		EXPECT_EQ(std::vector<uint8_t>(compressibleData.begin(), compressibleData.end()), archiveFile.ReadFile(compressibleIndex));
+
+		std::string contents(compressibleData.size(), '\0');
+		archiveFile.OpenStream(compressibleIndex)->Read(contents);
+		EXPECT_EQ(compressibleData, contents);
+
+		stream = archiveFile.OpenStream(incompressibleIndex);
+	}
+
+	// Streams keep the mapping alive after the archive is closed
+	std::string contents(incompressibleData.size(), '\0');
+	stream->Read(contents);
+	EXPECT_EQ(incompressibleData, contents);
+	stream.reset();
+
+	// Views are only available from memory mapped archives
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		EXPECT_FALSE(archiveFile.IsMemoryMapped());
+		EXPECT_THROW(archiveFile.GetFileView(archiveFile.GetIndex(incompressibleFilename)), std::runtime_error);
+	}
+
+	XFile::DeletePath(archiveFilename);
+	XFile::DeletePath(compressibleFilename);
+	XFile::DeletePath(incompressibleFilename);
+}
 
 TEST(ClmFile, EmptyArchive) 
 {
@@ -45,7 +703,74 @@ TEST(ClmFile, EmptyArchive)
 		TestEmptyArchive(archiveFile, archiveFilename);
 	}
 
+	{
+		Archive::ClmFile archiveFile(archiveFilename, Archive::ArchiveBackend::MemoryMapped);
+
+		SCOPED_TRACE("Empty memory mapped CLM File");
+		TestEmptyArchive(archiveFile, archiveFilename);
+	}
+
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(ClmFile, ExtractFilesInStoredOrder)
+{
+	const std::string archiveFilename("BatchArchive.clm");
+
+	std::vector<Archive::PackSource> sources;
+	for (std::size_t i = 0; i < 4; ++i) {
+		sources.push_back(MakeWaveSource("Batch" + std::to_string(i) + ".wav", std::vector<uint8_t>(100 + i * 2, static_cast<uint8_t>(i))));
+	}
+	Archive::ClmFile::CreateArchiveFromSources(archiveFilename, sources);
+
+	Archive::ClmFile archiveFile(archiveFilename);
+	std::vector<std::size_t> extractedIndexes;
+	archiveFile.ExtractFiles(std::vector<std::size_t>{ 3, 0, 2 }, [&](std::size_t index, Stream::BidirectionalReader& contents) {
+		std::vector<uint8_t> buffer(static_cast<std::size_t>(contents.Length()));
+		contents.Read(buffer);
+		EXPECT_EQ(std::vector<uint8_t>(100 + index * 2, static_cast<uint8_t>(index)), buffer);
+		extractedIndexes.push_back(index);
+	});
+	EXPECT_EQ(std::vector<std::size_t>({ 0, 2, 3 }), extractedIndexes);
+
+	// Extracted files match ExtractFile, including the wave header
+	archiveFile.ExtractFiles(std::vector<std::string>{ "Batch1" }, "./");
+	archiveFile.ExtractFile(1, "Batch1Single.wav");
+	auto readWholeFile = [](const std::string& filename) {
+		Stream::FileReader fileReader(filename);
+		std::vector<uint8_t> contents(static_cast<std::size_t>(fileReader.Length()));
+		fileReader.Read(contents);
+		return contents;
+	};
+	EXPECT_EQ(readWholeFile("Batch1Single.wav"), readWholeFile("Batch1"));
+
+	XFile::DeletePath("Batch1");
+	XFile::DeletePath("Batch1Single.wav");
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(ClmFile, CreateArchiveDeduplicates)
+{
+	const std::string archiveFilename("DeduplicatedArchive.clm");
+	const std::string duplicatedArchiveFilename("DuplicatedArchive.clm");
+
+	const std::vector<Archive::PackSource> sources{
+		MakeWaveSource("Beep1.wav", std::vector<uint8_t>(1000, 1)),
+		MakeWaveSource("Beep2.wav", std::vector<uint8_t>(1000, 1)),
+		MakeWaveSource("Click.wav", std::vector<uint8_t>(1000, 2)),
+	};
+
+	Archive::ClmFile::CreateArchiveFromSources(duplicatedArchiveFilename, sources);
+	Archive::ClmFile::CreateArchiveFromSources(archiveFilename, sources, true);
+	EXPECT_EQ(1000u, XFile::GetFileSize(duplicatedArchiveFilename) - XFile::GetFileSize(archiveFilename));
+
+	Archive::ClmFile archiveFile(archiveFilename);
+	EXPECT_EQ(std::vector<uint8_t>(1000, 1), archiveFile.ReadFile("Beep1"));
+	EXPECT_EQ(std::vector<uint8_t>(1000, 1), archiveFile.ReadFile("Beep2"));
+	EXPECT_EQ(std::vector<uint8_t>(1000, 2), archiveFile.ReadFile("Click"));
+
 	XFile::DeletePath(archiveFilename);
+	XFile::DeletePath(duplicatedArchiveFilename);
 }
 
 // Deletes any files extracted during the test
@@ -0,0 +1,174 @@
+#include "Archive/ArchiveIndexCache.h"
+#include "Archive/VolFile.h"
+#include "Archive/ClmFile.h"
+#include "XFile.h"
+#include "Stream/FileWriter.h"
+#include "WaveSource.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace OP2Utility;
+
+namespace {
+	void CreateWaveArchive(const std::string& archiveFilename)
+	{
+		std::vector<Archive::PackSource> sources;
+		for (uint8_t i = 0; i < 2; ++i) {
+			sources.push_back(MakeWaveSource("Track" + std::to_string(i) + ".wav", std::vector<uint8_t>(100 + i, i)));
+		}
+		Archive::ClmFile::CreateArchiveFromSources(archiveFilename, sources);
+	}
+}
+
+TEST(ArchiveIndexCache, RestoresVolAndClmIndexes)
+{
+	const std::string volFilename("IndexCache.vol");
+	const std::string clmFilename("IndexCache.clm");
+	const std::string cacheFilename("IndexCache.cache");
+	Archive::VolFile::CreateArchiveFromSources(volFilename, {
+		Archive::PackSource::FromBuffer("b.txt", std::vector<uint8_t>(500, 'b')),
+		Archive::PackSource::FromBuffer("a.txt", { 'a' }),
+	}, Archive::CompressionType::LZH);
+	CreateWaveArchive(clmFilename);
+
+	{
+		Archive::ArchiveIndexCache cache;
+		Archive::VolFile volFile(volFilename, Archive::ArchiveBackend::FileStream, &cache);
+		Archive::ClmFile clmFile(clmFilename, Archive::ArchiveBackend::FileStream, &cache);
+		EXPECT_EQ(2u, cache.GetCount());
+		EXPECT_TRUE(cache.IsModified());
+		EXPECT_NE(nullptr, cache.Find(volFilename));
+		cache.Save(cacheFilename);
+	}
+
+	auto cache = Archive::ArchiveIndexCache::Load(cacheFilename);
+	EXPECT_EQ(2u, cache.GetCount());
+	EXPECT_FALSE(cache.IsModified());
+
+	for (auto backend : { Archive::ArchiveBackend::FileStream, Archive::ArchiveBackend::MemoryMapped }) {
+		Archive::VolFile volFile(volFilename, backend, &cache);
+		ASSERT_EQ(2u, volFile.GetCount());
+		EXPECT_EQ("a.txt", volFile.GetName(0));
+		EXPECT_EQ(1u, volFile.GetSize(0));
+		EXPECT_EQ(500u, volFile.GetSize(1));
+		EXPECT_EQ(Archive::CompressionType::LZH, volFile.GetCompressionCode(1));
+		EXPECT_EQ(std::vector<uint8_t>(500, 'b'), volFile.ReadFile("b.txt"));
+		EXPECT_EQ(0u, volFile.GetIndex("./A.TXT"));
+		EXPECT_FALSE(volFile.Contains("c.txt"));
+
+		Archive::ClmFile clmFile(clmFilename, backend, &cache);
+		ASSERT_EQ(2u, clmFile.GetCount());
+		EXPECT_EQ("Track1", clmFile.GetName(1));
+		EXPECT_EQ(std::vector<uint8_t>(101, 1), clmFile.ReadFile(1));
+	}
+	EXPECT_FALSE(cache.IsModified());
+
+	XFile::DeletePath(cacheFilename);
+	XFile::DeletePath(volFilename);
+	XFile::DeletePath(clmFilename);
+}
+
+TEST(ArchiveIndexCache, UsesCachedIndexWithoutParsing)
+{
+	const std::string cachedFilename("IndexCacheSource.vol");
+	const std::string otherFilename("IndexCacheOther.vol");
+	Archive::VolFile::CreateArchiveFromSources(cachedFilename, { Archive::PackSource::FromBuffer("Cached.txt", { 1 }) });
+	Archive::VolFile::CreateArchiveFromSources(otherFilename, { Archive::PackSource::FromBuffer("Parsed.txt", { 2 }) });
+
+	// Store the first volume's index under the second volume's path
+	Archive::ArchiveIndexCache sourceCache;
+	Archive::VolFile(cachedFilename, Archive::ArchiveBackend::FileStream, &sourceCache);
+	Archive::ArchiveIndexCache cache;
+	cache.Store(otherFilename, *sourceCache.Find(cachedFilename));
+
+	{
+		Archive::VolFile volFile(otherFilename, Archive::ArchiveBackend::FileStream, &cache);
+		EXPECT_EQ("Cached.txt", volFile.GetName(0));
+	}
+
+	// A cached volume index is not used for a CLM file, which is parsed instead
+	const std::string clmFilename("IndexCacheOther.clm");
+	CreateWaveArchive(clmFilename);
+	cache.Store(clmFilename, *sourceCache.Find(cachedFilename));
+	{
+		Archive::ClmFile clmFile(clmFilename, Archive::ArchiveBackend::FileStream, &cache);
+		EXPECT_EQ("Track0", clmFile.GetName(0));
+	}
+
+	XFile::DeletePath(cachedFilename);
+	XFile::DeletePath(otherFilename);
+	XFile::DeletePath(clmFilename);
+}
+
+TEST(ArchiveIndexCache, ChangedArchiveIsParsed)
+{
+	const std::string volFilename("IndexCacheChanged.vol");
+	Archive::VolFile::CreateArchiveFromSources(volFilename, { Archive::PackSource::FromBuffer("Old.txt", { 1 }) });
+
+	Archive::ArchiveIndexCache cache;
+	Archive::VolFile(volFilename, Archive::ArchiveBackend::FileStream, &cache);
+	ASSERT_NE(nullptr, cache.Find(volFilename));
+
+	Archive::VolFile::CreateArchiveFromSources(volFilename, {
+		Archive::PackSource::FromBuffer("New1.txt", { 1 }),
+		Archive::PackSource::FromBuffer("New2.txt", { 2 }),
+	});
+	EXPECT_EQ(nullptr, cache.Find(volFilename));
+
+	{
+		Archive::VolFile volFile(volFilename, Archive::ArchiveBackend::FileStream, &cache);
+		EXPECT_EQ(2u, volFile.GetCount());
+	}
+	EXPECT_NE(nullptr, cache.Find(volFilename));
+	EXPECT_EQ(nullptr, cache.Find("NotCached.vol"));
+
+	XFile::DeletePath(volFilename);
+}
+
+TEST(ArchiveIndexCache, SaveDropsDeletedArchives)
+{
+	const std::string volFilename("IndexCacheDeleted.vol");
+	const std::string cacheFilename("IndexCacheDeleted.cache");
+	Archive::VolFile::CreateArchiveFromSources(volFilename, { Archive::PackSource::FromBuffer("a.txt", { 1 }) });
+
+	Archive::ArchiveIndexCache cache;
+	Archive::VolFile(volFilename, Archive::ArchiveBackend::FileStream, &cache);
+	cache.Save(cacheFilename);
+	EXPECT_FALSE(cache.IsModified());
+
+	XFile::DeletePath(volFilename);
+	EXPECT_TRUE(cache.IsModified());
+	cache.Save(cacheFilename);
+	EXPECT_EQ(0u, cache.GetCount());
+	EXPECT_EQ(0u, Archive::ArchiveIndexCache::Load(cacheFilename).GetCount());
+
+	XFile::DeletePath(cacheFilename);
+}
+
+TEST(ArchiveIndexCache, LoadIgnoresMissingAndInvalidFiles)
+{
+	const std::string cacheFilename("Invalid.cache");
+	EXPECT_EQ(0u, Archive::ArchiveIndexCache::Load(cacheFilename).GetCount());
+
+	{
+		Stream::FileWriter writer(cacheFilename);
+		writer.Write("not an index cache", 18);
+	}
+	EXPECT_EQ(0u, Archive::ArchiveIndexCache::Load(cacheFilename).GetCount());
+
+	// Damaged entries are detected by checksum
+	Archive::ArchiveIndexCache cache;
+	cache.Store(cacheFilename, { 1, 2, 3 });
+	cache.Save(cacheFilename);
+	EXPECT_EQ(1u, Archive::ArchiveIndexCache::Load(cacheFilename).GetCount());
+	{
+		Stream::FileWriter writer(cacheFilename, Stream::FileWriter::OpenMode::CanOpenExisting);
+		writer.Seek(writer.Length() - 1);
+		writer.Write(uint8_t(0xFF));
+	}
+	EXPECT_EQ(0u, Archive::ArchiveIndexCache::Load(cacheFilename).GetCount());
+
+	XFile::DeletePath(cacheFilename);
+}
@@ -0,0 +1,261 @@
+#include "Archive/ArchiveManifest.h"
+#include "Archive/VolFile.h"
+#include "Archive/ClmFile.h"
+#include "Archive/DecompressedEntryCache.h"
+#include "XFile.h"
+#include "Stream/FileWriter.h"
+#include "Stream/FileReader.h"
+#include "../PseudoRandom.h"
+#include "WaveSource.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+using namespace OP2Utility;
+
+namespace {
+	std::vector<Archive::PackSource> MakeManifestSources()
+	{
+		const auto noise = MakePseudoRandomData(3000, 7);
+		const std::string text("Unique text to find in the volume");
+		return {
+			Archive::PackSource::FromBuffer("Noise.bin", noise),
+			Archive::PackSource::FromBuffer("Repeated.txt", std::vector<uint8_t>(5000, 'r')),
+			Archive::PackSource::FromBuffer("Text.txt", std::vector<uint8_t>(text.begin(), text.end())),
+		};
+	}
+
+	void ExpectAllSucceeded(const std::vector<Archive::ArchiveManifest::VerificationResult>& results)
+	{
+		for (const auto& result : results) {
+			EXPECT_TRUE(result.succeeded) << result.name << ": " << result.errorMessage;
+		}
+	}
+}
+
+TEST(ArchiveManifest, Crc32)
+{
+	EXPECT_EQ(0u, Archive::ArchiveManifest::Crc32("", 0));
+	EXPECT_EQ(0xCBF43926u, Archive::ArchiveManifest::Crc32("123456789", 9));
+
+	// Data may be checksummed in pieces
+	const auto firstPart = Archive::ArchiveManifest::Crc32("1234", 4);
+	EXPECT_EQ(0xCBF43926u, Archive::ArchiveManifest::Crc32("56789", 5, firstPart));
+}
+
+TEST(ArchiveManifest, CreateSaveLoadVerify)
+{
+	const std::string archiveFilename("ManifestArchive.vol");
+	const auto manifestFilename = Archive::ArchiveManifest::GetManifestFilename(archiveFilename);
+	Archive::VolFile::CreateArchiveFromSources(archiveFilename, MakeManifestSources(), Archive::CompressionType::LZH);
+
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		const auto manifest = Archive::ArchiveManifest::Create(archiveFile, 2);
+		ASSERT_EQ(3u, manifest.entries.size());
+
+		// Compressed files record both their stored and decompressed checksums
+		const auto& repeated = manifest.entries[archiveFile.GetIndex("Repeated.txt")];
+		EXPECT_EQ("Repeated.txt", repeated.name);
+		EXPECT_EQ(5000u, repeated.size);
+		EXPECT_LT(repeated.storedSize, repeated.size);
+		EXPECT_EQ(Archive::ArchiveManifest::Crc32(std::vector<uint8_t>(5000, 'r').data(), 5000), repeated.crc32);
+
+		manifest.Save(manifestFilename);
+	}
+
+	const auto manifest = Archive::ArchiveManifest::Load(manifestFilename);
+	ASSERT_EQ(3u, manifest.entries.size());
+
+	for (auto backend : { Archive::ArchiveBackend::FileStream, Archive::ArchiveBackend::MemoryMapped }) {
+		Archive::VolFile archiveFile(archiveFilename, backend);
+		EXPECT_EQ(Archive::ArchiveManifest::Create(archiveFile).entries[1].storedCrc32, manifest.entries[1].storedCrc32);
+
+		// Verification decompresses directly, without filling the decompressed entry cache
+		auto cache = std::make_shared<Archive::DecompressedEntryCache>(1 << 20);
+		archiveFile.SetDecompressedEntryCache(cache);
+		const auto results = manifest.Verify(archiveFile, 4);
+		ASSERT_EQ(3u, results.size());
+		ExpectAllSucceeded(results);
+		EXPECT_EQ(archiveFilename, results[0].archiveFilename);
+		EXPECT_EQ(0u, cache->GetStatistics().entryCount);
+	}
+
+	XFile::DeletePath(manifestFilename);
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(ArchiveManifest, VerifyDetectsCorruption)
+{
+	const std::string archiveFilename("CorruptedArchive.vol");
+	Archive::VolFile::CreateArchiveFromSources(archiveFilename, MakeManifestSources());
+
+	Archive::ArchiveManifest manifest;
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		manifest = Archive::ArchiveManifest::Create(archiveFile);
+	}
+
+	// Change one byte of Text.txt's stored data
+	{
+		std::vector<char> volume;
+		{
+			Stream::FileReader volumeReader(archiveFilename);
+			volume.resize(static_cast<std::size_t>(volumeReader.Length()));
+			volumeReader.Read(volume);
+		}
+
+		const std::string text("Unique text");
+		auto found = std::search(volume.begin(), volume.end(), text.begin(), text.end());
+		ASSERT_NE(volume.end(), found);
+		*found = 'X';
+
+		Stream::FileWriter(archiveFilename).Write(volume);
+	}
+
+	Archive::VolFile archiveFile(archiveFilename);
+	const auto results = manifest.Verify(archiveFile);
+	ASSERT_EQ(3u, results.size());
+	for (const auto& result : results) {
+		EXPECT_EQ(result.name != "Text.txt", result.succeeded) << result.name;
+	}
+	EXPECT_EQ("Stored data checksum does not match manifest", results[archiveFile.GetIndex("Text.txt")].errorMessage);
+
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(ArchiveManifest, VerifyReportsMissingAndUnlistedFiles)
+{
+	const std::string archiveFilename("UnlistedArchive.vol");
+	Archive::VolFile::CreateArchiveFromSources(archiveFilename, MakeManifestSources());
+
+	Archive::VolFile archiveFile(archiveFilename);
+	auto manifest = Archive::ArchiveManifest::Create(archiveFile);
+	manifest.entries[0].name = "Missing.txt";
+
+	const auto results = manifest.Verify(archiveFile);
+	ASSERT_EQ(4u, results.size());
+	EXPECT_EQ("Missing.txt", results[0].name);
+	EXPECT_FALSE(results[0].succeeded);
+	EXPECT_EQ("Not found in archive", results[0].errorMessage);
+	EXPECT_TRUE(results[1].succeeded);
+	EXPECT_TRUE(results[2].succeeded);
+	EXPECT_EQ(archiveFile.GetName(0), results[3].name);
+	EXPECT_FALSE(results[3].succeeded);
+	EXPECT_EQ("Not listed in manifest", results[3].errorMessage);
+
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(ArchiveManifest, UnsupportedCompressionOnlyChecksumsStoredData)
+{
+	const std::string archiveFilename("UnsupportedCompression.vol");
+	const auto manifestFilename = Archive::ArchiveManifest::GetManifestFilename(archiveFilename);
+	Archive::VolFile::CreateArchiveFromSources(archiveFilename, MakeManifestSources());
+
+	// Mark Repeated.txt as RLE compressed, which can not be decompressed
+	{
+		std::vector<char> volume;
+		{
+			Stream::FileReader volumeReader(archiveFilename);
+			volume.resize(static_cast<std::size_t>(volumeReader.Length()));
+			volumeReader.Read(volume);
+		}
+
+		const std::string indexTag("voli");
+		auto indexTable = std::search(volume.begin(), volume.end(), indexTag.begin(), indexTag.end());
+		ASSERT_NE(volume.end(), indexTable);
+		const auto compressionType = static_cast<uint16_t>(Archive::CompressionType::RLE);
+		std::memcpy(&*(indexTable + 8 + 14 * 1 + 12), &compressionType, sizeof(compressionType));
+
+		Stream::FileWriter(archiveFilename).Write(volume);
+	}
+
+	{
+		Archive::VolFile archiveFile(archiveFilename);
+		ASSERT_EQ(Archive::CompressionType::RLE, archiveFile.GetCompressionCode(1));
+
+		const auto manifest = Archive::ArchiveManifest::Create(archiveFile);
+		ASSERT_EQ(3u, manifest.entries.size());
+		EXPECT_FALSE(manifest.entries[1].contentsChecksummed);
+		EXPECT_EQ(0u, manifest.entries[1].size);
+		EXPECT_EQ(5000u, manifest.entries[1].storedSize);
+		EXPECT_EQ(Archive::ArchiveManifest::Crc32(std::vector<uint8_t>(5000, 'r').data(), 5000), manifest.entries[1].storedCrc32);
+		EXPECT_TRUE(manifest.entries[0].contentsChecksummed);
+		manifest.Save(manifestFilename);
+	}
+
+	const auto manifest = Archive::ArchiveManifest::Load(manifestFilename);
+	EXPECT_FALSE(manifest.entries[1].contentsChecksummed);
+	EXPECT_TRUE(manifest.entries[2].contentsChecksummed);
+
+	Archive::VolFile archiveFile(archiveFilename);
+	ExpectAllSucceeded(manifest.Verify(archiveFile));
+
+	// A manifest listing contents the archive can not decompress fails verification
+	auto contentsManifest = manifest;
+	contentsManifest.entries[1].contentsChecksummed = true;
+	const auto results = contentsManifest.Verify(archiveFile);
+	EXPECT_FALSE(results[1].succeeded);
+	EXPECT_TRUE(results[0].succeeded);
+
+	XFile::DeletePath(manifestFilename);
+	XFile::DeletePath(archiveFilename);
+}
+
+TEST(ArchiveManifest, VerifyManyArchives)
+{
+	const std::string volFilename("ManifestMany.vol");
+	const std::string clmFilename("ManifestMany.clm");
+	Archive::VolFile::CreateArchiveFromSources(volFilename, MakeManifestSources(), Archive::CompressionType::LZH);
+
+	std::vector<Archive::PackSource> waveSources;
+	for (uint8_t i = 0; i < 2; ++i) {
+		waveSources.push_back(MakeWaveSource("Track" + std::to_string(i) + ".wav", std::vector<uint8_t>(200, i)));
+	}
+	Archive::ClmFile::CreateArchiveFromSources(clmFilename, waveSources);
+
+	Archive::VolFile volFile(volFilename);
+	Archive::ClmFile clmFile(clmFilename);
+	const auto volManifest = Archive::ArchiveManifest::Create(volFile);
+	const auto clmManifest = Archive::ArchiveManifest::Create(clmFile);
+
+	// CLM audio data is stored as is
+	ASSERT_EQ(2u, clmManifest.entries.size());
+	EXPECT_EQ(200u, clmManifest.entries[0].size);
+	EXPECT_EQ(clmManifest.entries[0].size, clmManifest.entries[0].storedSize);
+	EXPECT_EQ(clmManifest.entries[0].crc32, clmManifest.entries[0].storedCrc32);
+
+	const auto results = Archive::ArchiveManifest::Verify({ &volFile, &clmFile }, { &volManifest, &clmManifest }, 3);
+	ASSERT_EQ(5u, results.size());
+	ExpectAllSucceeded(results);
+	EXPECT_EQ(volFilename, results[2].archiveFilename);
+	EXPECT_EQ(clmFilename, results[3].archiveFilename);
+
+	// Manifests are paired with archives by position
+	const auto swappedResults = Archive::ArchiveManifest::Verify({ &clmFile }, { &volManifest });
+	EXPECT_TRUE(std::none_of(swappedResults.begin(), swappedResults.end(), [](const auto& result) { return result.succeeded; }));
+
+	EXPECT_THROW(Archive::ArchiveManifest::Verify({ &volFile, &clmFile }, { &volManifest }), std::runtime_error);
+
+	XFile::DeletePath(volFilename);
+	XFile::DeletePath(clmFilename);
+}
+
+TEST(ArchiveManifest, LoadRejectsInvalidFile)
+{
+	const std::string filename("Invalid.manifest");
+	{
+		Stream::FileWriter writer(filename);
+		writer.Write("not a manifest", 14);
+	}
+
+	EXPECT_THROW(Archive::ArchiveManifest::Load(filename), std::runtime_error);
+	XFile::DeletePath(filename);
+
+	EXPECT_THROW(Archive::ArchiveManifest::Load(filename), std::runtime_error);
+}
@@ -0,0 +1,63 @@
+#include "Archive/BitStreamReader.h"
+#include "Stream/MemoryReader.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdint>
+
+using namespace OP2Utility;
+
+namespace {
+	std::array<uint8_t, 7> data{ 0xA5, 0x3C, 0xFF, 0x00, 0x81, 0x7E, 0x96 };
+
+	// Reads bitCount bits a bit at a time, first bit in the MSB
+	unsigned int ReadBits(Archive::BitStreamReader& bitStreamReader, unsigned int bitCount)
+	{
+		unsigned int value = 0;
+		for (unsigned int i = 0; i < bitCount; ++i) {
+			value = (value << 1) | bitStreamReader.ReadNextBit();
+		}
+		return value;
+	}
+
+	// Mixes peeks and consumes of varying sizes with single bit reads
+	void ExpectPeekMatchesReadNextBit(Archive::BitStreamReader& bitStreamReader)
+	{
+		Archive::BitStreamReader reference(data.data(), data.size());
+
+		for (unsigned int step = 1; !reference.EndOfStream(); step = step % 16 + 3) {
+			// Bits past the end of the stream are read as 0
+			auto expected = Archive::BitStreamReader(reference);
+			ASSERT_EQ(ReadBits(expected, step), bitStreamReader.PeekBits(step));
+
+			bitStreamReader.ConsumeBits(step / 2);
+			ReadBits(reference, step / 2);
+			ASSERT_EQ(reference.GetBitReadPos(), bitStreamReader.GetBitReadPos());
+
+			// Bit reads pick up where consumed bits leave off
+			ASSERT_EQ(reference.ReadNextBit(), bitStreamReader.ReadNextBit());
+		}
+
+		bitStreamReader.ConsumeBits(16);
+		EXPECT_TRUE(bitStreamReader.EndOfStream());
+		EXPECT_EQ(data.size() * 8, bitStreamReader.GetBitReadPos());
+	}
+}
+
+TEST(BitStreamReader, PeekBitsFromBuffer)
+{
+	Archive::BitStreamReader bitStreamReader(data.data(), data.size());
+	EXPECT_EQ(0xA53Cu, bitStreamReader.PeekBits(16));
+	EXPECT_EQ(0x5u, bitStreamReader.PeekBits(3));
+	EXPECT_THROW(bitStreamReader.PeekBits(17), std::runtime_error);
+
+	ExpectPeekMatchesReadNextBit(bitStreamReader);
+}
+
+TEST(BitStreamReader, PeekBitsAcrossChunks)
+{
+	// Peeks span chunk boundaries when reading from a stream a few bytes at a time
+	Stream::MemoryReader memoryReader(data.data(), data.size());
+	Archive::BitStreamReader bitStreamReader(memoryReader, data.size(), 1);
+
+	ExpectPeekMatchesReadNextBit(bitStreamReader);
+}
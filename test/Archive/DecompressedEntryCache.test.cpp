@@ -0,0 +1,138 @@
+#include "Archive/DecompressedEntryCache.h"
+#include "Archive/VolFile.h"
+#include "XFile.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+using namespace OP2Utility;
+using Archive::DecompressedEntryCache;
+
+namespace {
+	// Entries are keyed by archive, so tests need distinct open archives
+	class DecompressedEntryCacheTest : public ::testing::Test
+	{
+	protected:
+		static void SetUpTestSuite()
+		{
+			Archive::VolFile::CreateArchive(archiveFilename, {});
+		}
+
+		static void TearDownTestSuite()
+		{
+			XFile::DeletePath(archiveFilename);
+		}
+
+		const Archive::ArchiveFile& Archive(std::size_t id)
+		{
+			return id == 0 ? archive0 : archive1;
+		}
+
+		static const std::string archiveFilename;
+		Archive::VolFile archive0{ archiveFilename };
+		Archive::VolFile archive1{ archiveFilename };
+	};
+
+	const std::string DecompressedEntryCacheTest::archiveFilename("CacheTest.vol");
+
+	DecompressedEntryCache::Contents MakeContents(std::size_t size, uint8_t value = 0)
+	{
+		return std::make_shared<const std::vector<uint8_t>>(size, value);
+	}
+}
+
+TEST_F(DecompressedEntryCacheTest, FindCountsHitsAndMisses)
+{
+	DecompressedEntryCache cache(100);
+
+	EXPECT_EQ(nullptr, cache.Find(Archive(0), 0));
+	auto contents = MakeContents(10, 7);
+	cache.Insert(Archive(0), 0, contents);
+	EXPECT_EQ(contents, cache.Find(Archive(0), 0));
+
+	// Keys are distinguished by both archive and index
+	EXPECT_EQ(nullptr, cache.Find(Archive(0), 1));
+	EXPECT_EQ(nullptr, cache.Find(Archive(1), 0));
+
+	const auto statistics = cache.GetStatistics();
+	EXPECT_EQ(1u, statistics.hits);
+	EXPECT_EQ(3u, statistics.misses);
+	EXPECT_EQ(0u, statistics.evictions);
+	EXPECT_EQ(1u, statistics.entryCount);
+	EXPECT_EQ(10u, statistics.bytesUsed);
+}
+
+TEST_F(DecompressedEntryCacheTest, GetOrLoadLoadsOnce)
+{
+	DecompressedEntryCache cache(100);
+
+	int loadCount = 0;
+	auto load = [&loadCount]() {
+		++loadCount;
+		return std::vector<uint8_t>{ 1, 2, 3 };
+	};
+
+	auto contents1 = cache.GetOrLoad(Archive(0), 5, load);
+	auto contents2 = cache.GetOrLoad(Archive(0), 5, load);
+	EXPECT_EQ(1, loadCount);
+	EXPECT_EQ(contents1, contents2);
+	EXPECT_EQ((std::vector<uint8_t>{ 1, 2, 3 }), *contents2);
+}
+
+TEST_F(DecompressedEntryCacheTest, EvictsLeastRecentlyUsed)
+{
+	DecompressedEntryCache cache(30);
+
+	cache.Insert(Archive(0), 0, MakeContents(10));
+	cache.Insert(Archive(0), 1, MakeContents(10));
+	cache.Insert(Archive(0), 2, MakeContents(10));
+
+	// Use entry 0, making entry 1 the least recently used
+	EXPECT_NE(nullptr, cache.Find(Archive(0), 0));
+	cache.Insert(Archive(0), 3, MakeContents(10));
+
+	EXPECT_EQ(nullptr, cache.Find(Archive(0), 1));
+	EXPECT_NE(nullptr, cache.Find(Archive(0), 0));
+	EXPECT_NE(nullptr, cache.Find(Archive(0), 2));
+	EXPECT_NE(nullptr, cache.Find(Archive(0), 3));
+	EXPECT_EQ(1u, cache.GetStatistics().evictions);
+	EXPECT_EQ(30u, cache.GetStatistics().bytesUsed);
+
+	// Shrinking the budget evicts down to the new size
+	cache.SetByteBudget(15);
+	EXPECT_EQ(15u, cache.GetByteBudget());
+	EXPECT_EQ(1u, cache.GetStatistics().entryCount);
+	EXPECT_NE(nullptr, cache.Find(Archive(0), 3));
+}
+
+TEST_F(DecompressedEntryCacheTest, SkipsContentsLargerThanBudget)
+{
+	DecompressedEntryCache cache(10);
+
+	cache.Insert(Archive(0), 0, MakeContents(5));
+	cache.Insert(Archive(0), 1, MakeContents(11));
+
+	EXPECT_EQ(nullptr, cache.Find(Archive(0), 1));
+	EXPECT_NE(nullptr, cache.Find(Archive(0), 0));
+	EXPECT_EQ(0u, cache.GetStatistics().evictions);
+}
+
+TEST_F(DecompressedEntryCacheTest, RemoveArchive)
+{
+	DecompressedEntryCache cache(100);
+
+	cache.Insert(Archive(0), 0, MakeContents(10));
+	cache.Insert(Archive(1), 0, MakeContents(10));
+	cache.Insert(Archive(0), 1, MakeContents(10));
+
+	cache.Remove(Archive(0));
+	EXPECT_EQ(1u, cache.GetStatistics().entryCount);
+	EXPECT_EQ(10u, cache.GetStatistics().bytesUsed);
+	EXPECT_NE(nullptr, cache.Find(Archive(1), 0));
+
+	cache.Clear();
+	EXPECT_EQ(0u, cache.GetStatistics().entryCount);
+	EXPECT_EQ(0u, cache.GetStatistics().bytesUsed);
+}
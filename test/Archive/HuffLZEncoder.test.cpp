@@ -0,0 +1,170 @@
+#include "Archive/HuffLZEncoder.h"
+#include "Archive/HuffLZ.h"
+#include "../PseudoRandom.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace OP2Utility;
+
+using CompressionLevel = Archive::HuffLZEncoder::CompressionLevel;
+
+// Compresses at each level and then decompresses data, checking the result matches the original
+void ExpectRoundTrip(const std::vector<uint8_t>& data)
+{
+	for (auto level : { CompressionLevel::Fast, CompressionLevel::Lazy, CompressionLevel::Optimal }) {
+		std::vector<uint8_t> compressed;
+		ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed, SIZE_MAX, level));
+
+		Archive::HuffLZ decompressor(Archive::BitStreamReader(compressed.data(), compressed.size()));
+		std::vector<uint8_t> decompressed(data.size());
+		auto bytesCopied = decompressor.GetData(reinterpret_cast<char*>(decompressed.data()), decompressed.size());
+
+		EXPECT_EQ(data.size(), bytesCopied);
+		EXPECT_EQ(data, decompressed);
+	}
+}
+
+TEST(HuffLZEncoder, EmptyData)
+{
+	std::vector<uint8_t> compressed;
+	EXPECT_TRUE(Archive::HuffLZEncoder::Compress(nullptr, 0, compressed));
+	EXPECT_EQ(0u, compressed.size());
+}
+
+TEST(HuffLZEncoder, RoundTripText)
+{
+	const std::string text = "Outpost 2: Divided Destiny. Outpost 2: Divided Destiny. Eden and Plymouth. Eden and Plymouth.";
+	ExpectRoundTrip(std::vector<uint8_t>(text.begin(), text.end()));
+}
+
+TEST(HuffLZEncoder, RoundTripRuns)
+{
+	// Overlapping matches, and matches against the initial window of spaces
+	std::vector<uint8_t> data(10000, 'A');
+	data.insert(data.begin(), 100, ' ');
+	ExpectRoundTrip(data);
+}
+
+TEST(HuffLZEncoder, RoundTripLargerThanWindow)
+{
+	// Repeats at distances near the window size exercise all repeat offset encodings
+	auto block = MakePseudoRandomData(4090, 1);
+	std::vector<uint8_t> data;
+	for (int i = 0; i < 4; ++i) {
+		data.insert(data.end(), block.begin(), block.end());
+		data.push_back(static_cast<uint8_t>(i));
+	}
+	ExpectRoundTrip(data);
+	ExpectRoundTrip(MakePseudoRandomData(20000, 2, 0x0F));
+}
+
+TEST(HuffLZEncoder, RoundTripIncompressible)
+{
+	ExpectRoundTrip(MakePseudoRandomData(5000, 3));
+}
+
+TEST(HuffLZEncoder, CompressesRedundantData)
+{
+	std::vector<uint8_t> data(20000, 0);
+	std::vector<uint8_t> compressed;
+	ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed));
+	EXPECT_LT(compressed.size(), data.size() / 10);
+}
+
+TEST(HuffLZEncoder, HigherLevelsCompressSmaller)
+{
+	// Words from a small vocabulary, where the longest match is often not the best choice
+	const char* words[] = { "Eden ", "Plymouth ", "colony ", "structure ", "Eden colony ", "tube ", "12", "\r\n" };
+	std::vector<uint8_t> data;
+	PseudoRandom random(5);
+	while (data.size() < 30000) {
+		const std::string word = words[random.Next() % (sizeof(words) / sizeof(words[0]))];
+		data.insert(data.end(), word.begin(), word.end());
+	}
+	ExpectRoundTrip(data);
+
+	std::vector<uint8_t> fast;
+	std::vector<uint8_t> lazy;
+	std::vector<uint8_t> optimal;
+	ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), fast, SIZE_MAX, CompressionLevel::Fast));
+	ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), lazy, SIZE_MAX, CompressionLevel::Lazy));
+	ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), optimal, SIZE_MAX, CompressionLevel::Optimal));
+	// Lazy matching only helps where a longer match starts one byte later
+	EXPECT_LE(lazy.size(), fast.size());
+	EXPECT_LT(optimal.size(), lazy.size());
+}
+
+TEST(HuffLZEncoder, AbandonsWhenLargerThanLimit)
+{
+	auto data = MakePseudoRandomData(5000, 4);
+	for (auto level : { CompressionLevel::Fast, CompressionLevel::Lazy, CompressionLevel::Optimal }) {
+		std::vector<uint8_t> compressed;
+		EXPECT_FALSE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed, data.size() - 1, level));
+	}
+}
+
+// Table driven decoding must produce the same output as decoding a bit at a time
+TEST(HuffLZEncoder, PrefixTableDecodeMatchesBitwiseDecode)
+{
+	auto data = MakePseudoRandomData(50000, 7, 0x1F);
+	std::vector<uint8_t> compressed;
+	ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed));
+
+	for (unsigned int prefixTableBitCount : {0u, 1u, 8u, 12u, 16u}) {
+		Archive::HuffLZ decompressor(Archive::BitStreamReader(compressed.data(), compressed.size()), prefixTableBitCount);
+		std::vector<uint8_t> decompressed(data.size());
+		decompressor.GetData(reinterpret_cast<char*>(decompressed.data()), decompressed.size());
+		EXPECT_EQ(data, decompressed) << "Prefix table bit count: " << prefixTableBitCount;
+	}
+
+	EXPECT_THROW(Archive::HuffLZ(Archive::BitStreamReader(compressed.data(), compressed.size()), 17), std::runtime_error);
+}
+
+TEST(HuffLZEncoder, WordBitStreamReaderDecodeMatches)
+{
+	auto data = MakePseudoRandomData(50000, 11, 0x3F);
+	std::vector<uint8_t> compressed;
+	ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed));
+
+	Archive::WordHuffLZ decompressor(Archive::WordBitStreamReader(compressed.data(), compressed.size()));
+	std::vector<uint8_t> decompressed(data.size());
+	EXPECT_EQ(data.size(), decompressor.GetData(reinterpret_cast<char*>(decompressed.data()), decompressed.size()));
+	EXPECT_EQ(data, decompressed);
+}
+
+// Decoding straight into the output must match decoding through the circular buffer
+TEST(HuffLZEncoder, DecompressIntoMatchesGetData)
+{
+	// Leading spaces are matched against the initial window, before the start of the output
+	auto data = MakePseudoRandomData(20000, 13, 0x07);
+	data.insert(data.begin(), 70, ' ');
+	data.insert(data.begin() + 5000, 3000, 'Z');
+	std::vector<uint8_t> compressed;
+	ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed));
+
+	std::vector<uint8_t> decompressed(data.size());
+	Archive::HuffLZ decompressor(Archive::BitStreamReader(compressed.data(), compressed.size()));
+	EXPECT_EQ(data.size(), decompressor.DecompressInto(reinterpret_cast<char*>(decompressed.data()), decompressed.size()));
+	EXPECT_EQ(data, decompressed);
+
+	std::vector<uint8_t> wordDecompressed(data.size());
+	Archive::WordHuffLZ wordDecompressor(Archive::WordBitStreamReader(compressed.data(), compressed.size()));
+	EXPECT_EQ(data.size(), wordDecompressor.DecompressInto(reinterpret_cast<char*>(wordDecompressed.data()), wordDecompressed.size()));
+	EXPECT_EQ(data, wordDecompressed);
+}
+
+TEST(HuffLZEncoder, DecompressIntoStopsAtBufferEnd)
+{
+	const std::vector<uint8_t> data(1000, 'A');
+	std::vector<uint8_t> compressed;
+	ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed));
+
+	// Stops partway through a repeated block
+	std::vector<char> buffer(501, 'X');
+	Archive::WordHuffLZ decompressor(Archive::WordBitStreamReader(compressed.data(), compressed.size()));
+	EXPECT_EQ(500u, decompressor.DecompressInto(buffer.data(), 500));
+	EXPECT_EQ(std::string(500, 'A'), std::string(buffer.data(), 500));
+	EXPECT_EQ('X', buffer[500]);
+}
@@ -0,0 +1,149 @@
+#include "../Stream/BidirectionalReader.test.h"
+#include "Archive/HuffLZReader.h"
+#include "Archive/HuffLZEncoder.h"
+#include "Stream/MemoryReader.h"
+#include "../PseudoRandom.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+using namespace OP2Utility;
+
+// Any bit sequence is a valid LZH stream, so arbitrary bytes can stand in for compressed data
+static std::array<unsigned char, 64> compressedData{
+	0x5A, 0x13, 0xC7, 0x88, 0x2E, 0xF1, 0x04, 0x9B, 0x66, 0xD2, 0x3F, 0x70, 0xA9, 0x1C, 0xE5, 0x47,
+	0xB8, 0x0D, 0x92, 0x6E, 0x31, 0xFA, 0x57, 0xC3, 0x8C, 0x25, 0x79, 0xE0, 0x4B, 0x16, 0xAD, 0xD8,
+	0x63, 0x9E, 0x02, 0xBF, 0x74, 0x29, 0xF6, 0x8A, 0x1B, 0xC4, 0x50, 0xE7, 0x3A, 0x95, 0x0F, 0x6C,
+	0xD1, 0x48, 0xAB, 0x37, 0x82, 0xFD, 0x14, 0x69, 0xBE, 0x53, 0x07, 0xCA, 0x7F, 0x20, 0x9D, 0xE2,
+};
+
+// Decompress the entire buffer using the in-memory decompressor, as a reference result
+std::vector<char> DecompressAll()
+{
+	Archive::HuffLZ decompressor(Archive::BitStreamReader(compressedData.data(), compressedData.size()));
+
+	std::vector<char> decompressed;
+	std::array<char, 256> buffer;
+	std::size_t bytesCopied;
+	while ((bytesCopied = decompressor.GetData(buffer.data(), buffer.size())) > 0) {
+		decompressed.insert(decompressed.end(), buffer.data(), buffer.data() + bytesCopied);
+	}
+	return decompressed;
+}
+
+std::unique_ptr<Stream::BidirectionalReader> CompressedStream()
+{
+	return std::make_unique<Stream::MemoryReader>(compressedData.data(), compressedData.size());
+}
+
+template <>
+Archive::HuffLZReader CreateBidirectionalReader<Archive::HuffLZReader>() {
+	return Archive::HuffLZReader(CompressedStream(), DecompressAll().size());
+}
+
+INSTANTIATE_TYPED_TEST_SUITE_P(HuffLZReader, SimpleBidirectionalReader, Archive::HuffLZReader);
+
+
+TEST(HuffLZReader, MatchesInMemoryDecompression)
+{
+	const auto expected = DecompressAll();
+	ASSERT_LT(0u, expected.size());
+
+	Archive::HuffLZReader reader(CompressedStream(), expected.size());
+	EXPECT_EQ(expected.size(), reader.Length());
+
+	std::vector<char> actual(expected.size());
+	reader.Read(actual);
+	EXPECT_EQ(expected, actual);
+	EXPECT_EQ(expected.size(), reader.Position());
+}
+
+TEST(HuffLZReader, SmallChunkedReadsMatch)
+{
+	const auto expected = DecompressAll();
+	Archive::HuffLZReader reader(CompressedStream(), expected.size());
+
+	std::vector<char> actual;
+	char c;
+	while (reader.ReadPartial(&c, 1) == 1) {
+		actual.push_back(c);
+	}
+	EXPECT_EQ(expected, actual);
+}
+
+TEST(HuffLZReader, LengthLimitsRead)
+{
+	const auto expected = DecompressAll();
+	ASSERT_LT(2u, expected.size());
+
+	// Decompressed length from the archive index may be shorter than what the bit stream decodes to
+	Archive::HuffLZReader reader(CompressedStream(), 2);
+
+	std::array<char, 3> buffer;
+	EXPECT_THROW(reader.Read(buffer), std::runtime_error);
+	EXPECT_EQ(0u, reader.Position());
+	EXPECT_EQ(2u, reader.ReadPartial(buffer.data(), buffer.size()));
+	EXPECT_EQ(expected[1], buffer[1]);
+}
+
+TEST(HuffLZReader, ReadPastEndOfCompressedDataThrows)
+{
+	const auto expected = DecompressAll();
+	Archive::HuffLZReader reader(CompressedStream(), expected.size() + 4096);
+
+	std::vector<char> buffer(expected.size() + 4096);
+	EXPECT_THROW(reader.Read(buffer), std::runtime_error);
+}
+
+TEST(HuffLZReader, SeekBackwardRestartsDecompression)
+{
+	const auto expected = DecompressAll();
+	ASSERT_LT(10u, expected.size());
+	Archive::HuffLZReader reader(CompressedStream(), expected.size());
+
+	char c;
+	reader.Seek(10);
+	reader.Read(c);
+	EXPECT_EQ(expected[10], c);
+
+	reader.SeekBackward(6);
+	EXPECT_EQ(5u, reader.Position());
+	reader.Read(c);
+	EXPECT_EQ(expected[5], c);
+
+	reader.SeekForward(3);
+	reader.Read(c);
+	EXPECT_EQ(expected[9], c);
+
+	EXPECT_THROW(reader.Seek(expected.size() + 1), std::runtime_error);
+	EXPECT_EQ(10u, reader.Position());
+}
+
+TEST(HuffLZReader, SeekWithCheckpoints)
+{
+	// Noisy data, so the compressed stream spans several input chunks
+	const auto data = MakePseudoRandomData(60000, 1, 0x3F);
+	std::vector<uint8_t> compressed;
+	ASSERT_TRUE(Archive::HuffLZEncoder::Compress(data.data(), data.size(), compressed));
+
+	Archive::HuffLZReader reader(std::make_unique<Stream::MemoryReader>(compressed.data(), compressed.size()), data.size(), 1000);
+
+	for (uint64_t position : { 50000u, 1500u, 999u, 1000u, 45678u, 59999u, 0u, 30000u, 12345u }) {
+		reader.Seek(position);
+		EXPECT_EQ(position, reader.Position());
+
+		uint8_t value;
+		reader.Read(value);
+		EXPECT_EQ(data[position], value);
+	}
+
+	// Reading across checkpoint positions after a restore
+	reader.Seek(2500);
+	reader.SeekForward(20000);
+	std::vector<uint8_t> actual(20000);
+	reader.Read(actual);
+	EXPECT_TRUE(std::equal(actual.begin(), actual.end(), data.begin() + 22500));
+}
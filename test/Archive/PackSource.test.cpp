@@ -0,0 +1,86 @@
+#include "Archive/PackSource.h"
+#include "Stream/FileWriter.h"
+#include "Stream/MemoryReader.h"
+#include "XFile.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+using namespace OP2Utility;
+
+TEST(PackSource, FromFile)
+{
+	const std::string filename("PackSourceFile.txt");
+	{
+		Stream::FileWriter writer(filename);
+		writer.Write("contents", 8);
+	}
+
+	const auto source = Archive::PackSource::FromFile("./" + filename);
+	EXPECT_EQ(filename, source.name);
+	EXPECT_EQ(8u, source.size);
+
+	std::string contents(8, '\0');
+	source.Open()->Read(contents);
+	EXPECT_EQ("contents", contents);
+
+	XFile::DeletePath(filename);
+	EXPECT_THROW(Archive::PackSource::FromFiles({ filename }), std::runtime_error);
+}
+
+TEST(PackSource, FromBuffer)
+{
+	const auto source = Archive::PackSource::FromBuffer("Buffer.txt", { 1, 2, 3 });
+	EXPECT_EQ("Buffer.txt", source.name);
+	EXPECT_EQ(3u, source.size);
+
+	// Each open is independent
+	std::vector<uint8_t> contents(3);
+	source.Open()->Read(contents);
+	EXPECT_EQ((std::vector<uint8_t>{ 1, 2, 3 }), contents);
+	source.Open()->Read(contents);
+	EXPECT_EQ((std::vector<uint8_t>{ 1, 2, 3 }), contents);
+}
+
+TEST(PackSource, OpenVerifiesSize)
+{
+	static const char data[] = "data";
+	const Archive::PackSource source{ "Changed.txt", 10, []() {
+		return std::make_unique<Stream::MemoryReader>(data, 4);
+	} };
+
+	EXPECT_THROW(source.Open(), std::runtime_error);
+}
+
+TEST(PackSource, FindDuplicates)
+{
+	std::size_t openCount = 0;
+	auto countedSource = [&openCount](const std::string& name, std::vector<uint8_t> contents) {
+		auto bufferSource = Archive::PackSource::FromBuffer(name, std::move(contents));
+		return Archive::PackSource{ bufferSource.name, bufferSource.size, [bufferSource, &openCount]() {
+			++openCount;
+			return bufferSource.Open();
+		} };
+	};
+
+	const std::vector<Archive::PackSource> sources{
+		countedSource("A", { 1, 2, 3 }),
+		countedSource("B", { 1, 2, 4 }),
+		countedSource("C", { 9 }),
+		countedSource("D", { 1, 2, 3 }),
+		countedSource("E", { 1, 2, 4 }),
+		countedSource("F", { 1, 2, 3 }),
+		countedSource("G", {}),
+	};
+
+	EXPECT_EQ((std::vector<std::size_t>{ 0, 1, 2, 0, 1, 0, 6 }), Archive::PackSource::FindDuplicates(sources));
+
+	// Sources with a unique size are not read
+	openCount = 0;
+	Archive::PackSource::FindDuplicates({ sources[2], sources[6] });
+	EXPECT_EQ(0u, openCount);
+
+	EXPECT_TRUE(Archive::PackSource::FindDuplicates({}).empty());
+}
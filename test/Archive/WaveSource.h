@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Archive/PackSource.h"
+#include "Archive/WaveFile.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A wave file holding samples, as a source for packing CLM archives (mono 16 bit PCM, 22050 Hz)
+inline OP2Utility::Archive::PackSource MakeWaveSource(const std::string& name, const std::vector<uint8_t>& samples)
+{
+	const OP2Utility::Archive::WaveFormatEx waveFormat{ 1, 1, 22050, 44100, 2, 16, 0 };
+	const auto header = OP2Utility::Archive::WaveHeader::Create(waveFormat, static_cast<uint32_t>(samples.size()));
+
+	std::vector<uint8_t> waveFile(reinterpret_cast<const uint8_t*>(&header), reinterpret_cast<const uint8_t*>(&header) + sizeof(header));
+	waveFile.insert(waveFile.end(), samples.begin(), samples.end());
+	return OP2Utility::Archive::PackSource::FromBuffer(name, std::move(waveFile));
+}
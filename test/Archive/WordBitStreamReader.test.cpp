@@ -0,0 +1,91 @@
+#include "Archive/WordBitStreamReader.h"
+#include "Archive/BitStreamReader.h"
+#include "Stream/MemoryReader.h"
+#include "../PseudoRandom.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include <cstdint>
+
+using namespace OP2Utility;
+
+namespace {
+	// Reads bitCount bits a bit at a time, first bit in the MSB
+	unsigned int ReadBits(Archive::BitStreamReader& bitStreamReader, unsigned int bitCount)
+	{
+		unsigned int value = 0;
+		for (unsigned int i = 0; i < bitCount; ++i) {
+			value = (value << 1) | bitStreamReader.ReadNextBit();
+		}
+		return value;
+	}
+
+	// Compares a mix of reads of varying sizes against BitStreamReader
+	void ExpectMatchesBitStreamReader(Archive::WordBitStreamReader& wordBitStreamReader, std::vector<uint8_t>& data)
+	{
+		Archive::BitStreamReader reference(data.data(), data.size());
+
+		for (unsigned int step = 1; !reference.EndOfStream(); step = step % 32 + 5) {
+			// Bits past the end of the stream are read as 0
+			auto expected = Archive::BitStreamReader(reference);
+			ASSERT_EQ(ReadBits(expected, step), wordBitStreamReader.PeekBits(step));
+
+			wordBitStreamReader.ConsumeBits(step / 2);
+			ReadBits(reference, step / 2);
+			ASSERT_EQ(reference.GetBitReadPos(), wordBitStreamReader.GetBitReadPos());
+
+			ASSERT_EQ(reference.ReadNextBit(), wordBitStreamReader.ReadNextBit());
+			ASSERT_EQ(reference.ReadNext8Bits(), wordBitStreamReader.ReadNext8Bits());
+			ASSERT_EQ(reference.EndOfStream(), wordBitStreamReader.EndOfStream());
+		}
+
+		wordBitStreamReader.ConsumeBits(32);
+		EXPECT_TRUE(wordBitStreamReader.EndOfStream());
+		EXPECT_EQ(data.size() * 8, wordBitStreamReader.GetBitReadPos());
+		EXPECT_FALSE(wordBitStreamReader.ReadNextBit());
+		EXPECT_EQ(0u, wordBitStreamReader.PeekBits(32));
+	}
+}
+
+TEST(WordBitStreamReader, MatchesBitStreamReaderFromBuffer)
+{
+	auto data = MakePseudoRandomData(1000, 3);
+	Archive::WordBitStreamReader wordBitStreamReader(data.data(), data.size());
+
+	EXPECT_EQ(((uint32_t(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3]), wordBitStreamReader.PeekBits(32));
+	ExpectMatchesBitStreamReader(wordBitStreamReader, data);
+}
+
+TEST(WordBitStreamReader, MatchesBitStreamReaderAcrossChunks)
+{
+	auto data = MakePseudoRandomData(1000, 3);
+
+	for (std::size_t chunkSize : {1, 3, 8, 13, 4096}) {
+		Stream::MemoryReader memoryReader(data.data(), data.size());
+		Archive::WordBitStreamReader wordBitStreamReader(memoryReader, data.size(), chunkSize);
+		ExpectMatchesBitStreamReader(wordBitStreamReader, data);
+	}
+}
+
+TEST(WordBitStreamReader, CopyReadsIndependently)
+{
+	auto data = MakePseudoRandomData(100, 3);
+	Stream::MemoryReader memoryReader(data.data(), data.size());
+	Archive::WordBitStreamReader wordBitStreamReader(memoryReader, data.size(), 16);
+	wordBitStreamReader.ConsumeBits(20);
+
+	// The copy holds its own accumulator and chunk
+	Archive::WordBitStreamReader copy(wordBitStreamReader);
+	const auto expected = wordBitStreamReader.PeekBits(32);
+	wordBitStreamReader.ConsumeBits(32);
+	EXPECT_EQ(expected, copy.PeekBits(32));
+	EXPECT_EQ(20u, copy.GetBitReadPos());
+}
+
+TEST(WordBitStreamReader, EmptyStream)
+{
+	Archive::WordBitStreamReader wordBitStreamReader(nullptr, 0);
+	EXPECT_TRUE(wordBitStreamReader.EndOfStream());
+	EXPECT_EQ(0u, wordBitStreamReader.PeekBits(16));
+	wordBitStreamReader.ConsumeBits(16);
+	EXPECT_EQ(0u, wordBitStreamReader.GetBitReadPos());
+}
@@ -0,0 +1,99 @@
+#include "ParallelFor.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace OP2Utility;
+
+TEST(ParallelFor, CallsEachIndexOnce)
+{
+	for (std::size_t threadCount : {0, 1, 3, 64}) {
+		std::vector<std::atomic<int>> callCounts(1000);
+		ParallelFor(callCounts.size(), threadCount, [&](std::size_t index) {
+			++callCounts[index];
+		});
+
+		for (const auto& callCount : callCounts) {
+			EXPECT_EQ(1, callCount);
+		}
+	}
+}
+
+TEST(ParallelFor, EmptyRange)
+{
+	ParallelFor(0, 4, [](std::size_t) {
+		FAIL();
+	});
+}
+
+TEST(ParallelFor, RethrowsException)
+{
+	std::atomic<int> callCount(0);
+	EXPECT_THROW(ParallelFor(100, 4, [&](std::size_t index) {
+		++callCount;
+		if (index == 10) {
+			throw std::runtime_error("Failure");
+		}
+	}), std::runtime_error);
+
+	EXPECT_GE(callCount, 11);
+}
+
+TEST(ParallelOrderedFor, ConsumesInOrder)
+{
+	for (std::size_t threadCount : {0, 1, 3, 64}) {
+		std::vector<std::size_t> results(500);
+		std::vector<std::size_t> consumeOrder;
+		ParallelOrderedFor(results.size(), threadCount, 4, [&](std::size_t index) {
+			results[index] = index * index;
+		}, [&](std::size_t index) {
+			EXPECT_EQ(index * index, results[index]);
+			consumeOrder.push_back(index);
+		});
+
+		ASSERT_EQ(results.size(), consumeOrder.size());
+		for (std::size_t i = 0; i < consumeOrder.size(); ++i) {
+			EXPECT_EQ(i, consumeOrder[i]);
+		}
+	}
+}
+
+TEST(ParallelOrderedFor, LimitsPendingIndexes)
+{
+	const std::size_t maxPending = 3;
+	std::atomic<std::size_t> producedCount(0);
+	std::size_t consumedCount = 0;
+	ParallelOrderedFor(200, 8, maxPending, [&](std::size_t) {
+		++producedCount;
+	}, [&](std::size_t) {
+		EXPECT_LE(producedCount - consumedCount, maxPending);
+		++consumedCount;
+	});
+
+	EXPECT_EQ(200u, consumedCount);
+}
+
+TEST(ParallelOrderedFor, RethrowsException)
+{
+	std::size_t consumedCount = 0;
+	EXPECT_THROW(ParallelOrderedFor(100, 4, 8, [&](std::size_t index) {
+		if (index == 10) {
+			throw std::runtime_error("Failure");
+		}
+	}, [&](std::size_t) {
+		++consumedCount;
+	}), std::runtime_error);
+	EXPECT_LE(consumedCount, 10u);
+
+	EXPECT_THROW(ParallelOrderedFor(100, 4, 8, [](std::size_t) {}, [](std::size_t index) {
+		if (index == 20) {
+			throw std::runtime_error("Failure");
+		}
+	}), std::runtime_error);
+}
+
+TEST(ParallelFor, HardwareThreadCount)
+{
+	EXPECT_GE(HardwareThreadCount(), 1u);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Repeatable pseudo random values for test and benchmark data (a linear congruential generator)
+class PseudoRandom
+{
+public:
+	explicit PseudoRandom(uint32_t seed) : seed(seed) { }
+
+	// Returns a value from 0 to 0xFFFF, from the generator's better distributed high bits
+	uint32_t Next() {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	}
+
+private:
+	uint32_t seed;
+};
+
+// Pseudo random bytes, with the bits outside mask cleared
+inline std::vector<uint8_t> MakePseudoRandomData(std::size_t size, uint32_t seed, uint8_t mask = 0xFF)
+{
+	PseudoRandom random(seed);
+	std::vector<uint8_t> data(size);
+	for (auto& value : data) {
+		value = static_cast<uint8_t>(random.Next()) & mask;
+	}
+	return data;
+}
@@ -1,6 +1,9 @@
 #include "../src/ResourceManager.h"
 #include "../src/Archive/VolFile.h"
+#include "../src/Archive/DecompressedEntryCache.h"
+#include "../src/Archive/ArchiveIndexCache.h"
 #include "../src/XFile.h"
+#include "../src/Stream/FileWriter.h"
 #include <gtest/gtest.h>
 #include <stdexcept>
 
@@ -59,3 +62,139 @@ TEST(ResourceManager, GetArchiveFilenames)
 
 	XFile::DeletePath(archiveName);
 }
+
+TEST(ResourceManager, GetResourceStreamMemoryMapped)
+{
+	const std::string archiveName("./data/Mapped.vol");
+	const std::string packedFilename("MappedResource.txt");
+	{
+		Stream::FileWriter writer(packedFilename);
+		writer.Write("mapped", 6);
+	}
+	Archive::VolFile::CreateArchive(archiveName, { packedFilename });
+	XFile::DeletePath(packedFilename);
+
+	{
+		ResourceManager resourceManager("./data", Archive::ArchiveBackend::MemoryMapped);
+		auto stream = resourceManager.GetResourceStream(packedFilename);
+		ASSERT_NE(nullptr, stream);
+
+		std::string contents(6, '\0');
+		stream->Read(contents);
+		EXPECT_EQ("mapped", contents);
+	}
+
+	XFile::DeletePath(archiveName);
+}
+
+TEST(ResourceManager, GetResourceStreamCached)
+{
+	const std::string archiveName("./data/Cached.vol");
+	const std::string packedFilename("CachedResource.txt");
+	const std::string packedContents(2000, 'r');
+	{
+		Stream::FileWriter writer(packedFilename);
+		writer.Write(packedContents.data(), packedContents.size());
+	}
+	Archive::VolFile::CreateArchive(archiveName, { packedFilename }, Archive::CompressionType::LZH);
+	XFile::DeletePath(packedFilename);
+
+	{
+		auto cache = std::make_shared<Archive::DecompressedEntryCache>(1 << 20);
+		ResourceManager resourceManager("./data");
+		resourceManager.SetDecompressedEntryCache(cache);
+
+		for (int i = 0; i < 2; ++i) {
+			auto stream = resourceManager.GetResourceStream(packedFilename);
+			ASSERT_NE(nullptr, stream);
+
+			std::string contents(packedContents.size(), '\0');
+			stream->Read(contents);
+			EXPECT_EQ(packedContents, contents);
+		}
+
+		EXPECT_EQ(1u, cache->GetStatistics().misses);
+		EXPECT_EQ(1u, cache->GetStatistics().hits);
+	}
+
+	XFile::DeletePath(archiveName);
+}
+
+TEST(ResourceManager, VerifyArchives)
+{
+	const std::string directory("VerifyArchives");
+	const std::string archiveName(XFile::Append(directory, "Verified.vol"));
+	const std::string manifestName(Archive::ArchiveManifest::GetManifestFilename(archiveName));
+	XFile::NewDirectory(directory);
+	Archive::VolFile::CreateArchiveFromSources(archiveName, {
+		Archive::PackSource::FromBuffer("First.txt", { 1, 2, 3 }),
+		Archive::PackSource::FromBuffer("Second.txt", std::vector<uint8_t>(1000, 2)),
+	}, Archive::CompressionType::LZH);
+
+	{
+		ResourceManager resourceManager(directory);
+		EXPECT_THROW(resourceManager.VerifyArchives(), std::runtime_error);
+
+		Archive::VolFile archiveFile(archiveName);
+		Archive::ArchiveManifest::Create(archiveFile).Save(manifestName);
+
+		const auto results = resourceManager.VerifyArchives(2);
+		ASSERT_EQ(2u, results.size());
+		EXPECT_TRUE(results[0].succeeded);
+		EXPECT_TRUE(results[1].succeeded);
+	}
+
+	XFile::DeletePath(manifestName);
+	XFile::DeletePath(archiveName);
+	XFile::DeletePath(directory);
+}
+
+TEST(ResourceManager, IndexCache)
+{
+	const std::string directory("IndexCacheResources");
+	const std::string archiveName(XFile::Append(directory, "Cached.vol"));
+	const std::string cacheFilename("ResourceIndex.cache");
+	XFile::NewDirectory(directory);
+	Archive::VolFile::CreateArchiveFromSources(archiveName, { Archive::PackSource::FromBuffer("Indexed.txt", { 'i' }) });
+
+	{
+		ResourceManager resourceManager(directory, Archive::ArchiveBackend::FileStream, cacheFilename);
+		EXPECT_EQ(1u, Archive::ArchiveIndexCache::Load(cacheFilename).GetCount());
+		EXPECT_EQ(archiveName, resourceManager.FindContainingArchivePath("Indexed.txt"));
+	}
+
+	{
+		ResourceManager resourceManager(directory, Archive::ArchiveBackend::FileStream, cacheFilename);
+		auto stream = resourceManager.GetResourceStream("Indexed.txt");
+		ASSERT_NE(nullptr, stream);
+		char contents;
+		stream->Read(contents);
+		EXPECT_EQ('i', contents);
+	}
+
+	XFile::DeletePath(cacheFilename);
+	XFile::DeletePath(archiveName);
+	XFile::DeletePath(directory);
+}
+
+TEST(ResourceManager, UnwritableIndexCacheIsIgnored)
+{
+	const std::string directory("UnwritableIndexCacheResources");
+	const std::string archiveName(XFile::Append(directory, "Cached.vol"));
+	// A path below a regular file can not be created
+	const std::string blockerFilename("IndexCacheBlocker.txt");
+	const std::string cacheFilename(XFile::Append(blockerFilename, "ResourceIndex.cache"));
+	XFile::NewDirectory(directory);
+	Archive::VolFile::CreateArchiveFromSources(archiveName, { Archive::PackSource::FromBuffer("Indexed.txt", { 'i' }) });
+	Stream::FileWriter(blockerFilename).Write('b');
+
+	{
+		std::unique_ptr<ResourceManager> resourceManager;
+		ASSERT_NO_THROW(resourceManager = std::make_unique<ResourceManager>(directory, Archive::ArchiveBackend::FileStream, cacheFilename));
+		EXPECT_EQ(archiveName, resourceManager->FindContainingArchivePath("Indexed.txt"));
+	}
+
+	XFile::DeletePath(blockerFilename);
+	XFile::DeletePath(archiveName);
+	XFile::DeletePath(directory);
+}
@@ -0,0 +1,144 @@
+#include "BidirectionalReader.test.h"
+#include "Stream/BufferedReader.h"
+#include "Stream/FileHandleReader.h"
+#include "Stream/MemoryReader.h"
+#include <array>
+#include <memory>
+#include <string>
+
+using namespace OP2Utility;
+
+namespace {
+	// Counts the calls made to the underlying MemoryReader
+	class CountingReader : public Stream::MemoryReader
+	{
+	public:
+		CountingReader(const void* buffer, std::size_t size, std::shared_ptr<std::size_t> callCount) :
+			MemoryReader(buffer, size), callCount(callCount) { }
+
+		std::size_t ReadPartial(void* buffer, std::size_t size) noexcept override {
+			++*callCount;
+			return MemoryReader::ReadPartial(buffer, size);
+		}
+
+		void Seek(uint64_t position) override {
+			++*callCount;
+			MemoryReader::Seek(position);
+		}
+
+		void SeekForward(uint64_t offset) override {
+			++*callCount;
+			MemoryReader::SeekForward(offset);
+		}
+
+	protected:
+		void ReadImplementation(void* buffer, std::size_t size) override {
+			++*callCount;
+			MemoryReader::ReadImplementation(buffer, size);
+		}
+
+	private:
+		std::shared_ptr<std::size_t> callCount;
+	};
+
+	const std::string Data("0123456789abcdefghij");
+}
+
+template <>
+Stream::BufferedReader<Stream::FileHandleReader> CreateBidirectionalReader<Stream::BufferedReader<Stream::FileHandleReader>>() {
+	return Stream::BufferedReader<Stream::FileHandleReader>(
+		Stream::FileHandleReader(std::make_shared<const Stream::FileHandle>("Stream/data/SimpleStream.txt")), 2);
+}
+
+INSTANTIATE_TYPED_TEST_SUITE_P(BufferedReader, SimpleBidirectionalReader, Stream::BufferedReader<Stream::FileHandleReader>);
+
+
+TEST(BufferedReader, SmallReadsAreBatched) {
+	auto callCount = std::make_shared<std::size_t>(0);
+	Stream::BufferedReader<CountingReader> reader(CountingReader(Data.data(), Data.size(), callCount), 8);
+
+	std::string value(3, '\0');
+	reader.Read(value);
+	EXPECT_EQ("012", value);
+	reader.Read(value);
+	EXPECT_EQ("345", value);
+	EXPECT_EQ(1u, *callCount);
+
+	// Reads span buffer refills
+	reader.Read(value);
+	EXPECT_EQ("678", value);
+	EXPECT_EQ(2u, *callCount);
+	EXPECT_EQ(9u, reader.Position());
+
+	// Large reads go straight to the wrapped stream
+	std::string large(8, '\0');
+	reader.Read(large);
+	EXPECT_EQ("9abcdefg", large);
+	EXPECT_EQ(17u, reader.Position());
+
+	EXPECT_THROW(reader.Read(large), std::runtime_error);
+	EXPECT_EQ(17u, reader.Position());
+	EXPECT_EQ(3u, reader.ReadPartial(&large[0], large.size()));
+	EXPECT_EQ(20u, reader.Position());
+}
+
+TEST(BufferedReader, PeekAndSeekWithinBuffer) {
+	auto callCount = std::make_shared<std::size_t>(0);
+	Stream::BufferedReader<CountingReader> reader(CountingReader(Data.data(), Data.size(), callCount), 8);
+
+	std::array<char, 4> value;
+	reader.Peek(value);
+	EXPECT_EQ('0', value[0]);
+	EXPECT_EQ(0u, reader.Position());
+
+	reader.SeekForward(5);
+	reader.Peek(value.data(), 2);
+	EXPECT_EQ('5', value[0]);
+	reader.SeekBackward(3);
+	reader.Seek(7);
+	EXPECT_EQ(1u, *callCount);
+
+	// Peeking past the buffered bytes keeps the unread bytes
+	reader.Peek(value);
+	EXPECT_EQ(std::string("789a"), std::string(value.data(), value.size()));
+	EXPECT_EQ(7u, reader.Position());
+	EXPECT_EQ(2u, *callCount);
+
+	// Seeks outside the buffer move the wrapped stream
+	reader.SeekForward(10);
+	reader.Read(value[0]);
+	EXPECT_EQ('h', value[0]);
+	reader.Seek(1);
+	reader.Read(value[0]);
+	EXPECT_EQ('1', value[0]);
+
+	EXPECT_THROW(reader.SeekForward(20), std::runtime_error);
+	EXPECT_THROW(reader.Seek(21), std::runtime_error);
+	EXPECT_EQ(2u, reader.Position());
+}
+
+TEST(BufferedReader, CopyStartsAtSamePosition) {
+	Stream::BufferedReader<Stream::MemoryReader> reader(Stream::MemoryReader(Data.data(), Data.size()), 4);
+	reader.SeekForward(2);
+	char value;
+	reader.Read(value);
+
+	auto copy = reader;
+	copy.Read(value);
+	EXPECT_EQ('3', value);
+	reader.Read(value);
+	EXPECT_EQ('3', value);
+}
+
+TEST(BufferedReader, TryGetContiguousOnceBufferIsEmpty) {
+	Stream::BufferedReader<Stream::MemoryReader> reader(Stream::MemoryReader(Data.data(), Data.size()), 4);
+	char value;
+	reader.Read(value);
+	EXPECT_EQ(nullptr, reader.TryGetContiguous(2));
+
+	reader.SeekForward(3);
+	EXPECT_EQ(Data.data() + 4, reader.TryGetContiguous(2));
+	EXPECT_EQ(6u, reader.Position());
+	reader.Read(value);
+	EXPECT_EQ('6', value);
+}
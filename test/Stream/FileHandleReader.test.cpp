@@ -0,0 +1,101 @@
+#include "BidirectionalReader.test.h"
+#include "Stream/FileHandleReader.h"
+#include <memory>
+#include <string>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace OP2Utility;
+
+namespace {
+	std::shared_ptr<const Stream::FileHandle> OpenSimpleStream()
+	{
+		return std::make_shared<const Stream::FileHandle>("Stream/data/SimpleStream.txt");
+	}
+}
+
+template <>
+Stream::FileHandleReader CreateBidirectionalReader<Stream::FileHandleReader>() {
+	return Stream::FileHandleReader(OpenSimpleStream());
+}
+
+INSTANTIATE_TYPED_TEST_SUITE_P(FileHandleReader, SimpleBidirectionalReader, Stream::FileHandleReader);
+
+
+TEST(FileHandle, ReadAt) {
+	Stream::FileHandle fileHandle("Stream/data/SimpleStream.txt");
+	ASSERT_EQ(5u, fileHandle.Size());
+
+	std::string buffer(3, '\0');
+	EXPECT_EQ(3u, fileHandle.ReadAt(1, &buffer[0], buffer.size()));
+	EXPECT_EQ("est", buffer);
+
+	// Reads are cut short at the end of the file
+	EXPECT_EQ(2u, fileHandle.ReadAt(3, &buffer[0], buffer.size()));
+	EXPECT_EQ(0u, fileHandle.ReadAt(5, &buffer[0], buffer.size()));
+	EXPECT_THROW(fileHandle.ReadExactAt(3, &buffer[0], buffer.size()), std::runtime_error);
+}
+
+TEST(FileHandle, AccessNonexistingFile) {
+	EXPECT_THROW(Stream::FileHandle("Stream/MissingFile.txt"), std::runtime_error);
+}
+
+TEST(FileHandleReader, SliceIsBoundsChecked) {
+	auto fileHandle = OpenSimpleStream();
+	Stream::FileHandleReader stream(fileHandle);
+
+	EXPECT_THROW(Stream::FileHandleReader(fileHandle, 1, std::numeric_limits<uint64_t>::max()), std::runtime_error);
+	EXPECT_THROW(Stream::FileHandleReader(fileHandle, 0, fileHandle->Size() + 1), std::runtime_error);
+
+	EXPECT_THROW(stream.Slice(1, std::numeric_limits<uint64_t>::max()), std::runtime_error);
+	EXPECT_THROW(stream.Slice(std::numeric_limits<uint64_t>::max(), 1), std::runtime_error);
+	EXPECT_THROW(stream.Slice(1, stream.Length()), std::runtime_error);
+	EXPECT_NO_THROW(stream.Slice(stream.Length(), 0));
+}
+
+TEST(FileHandleReader, ReadersSharingHandleKeepOwnPosition) {
+	auto fileHandle = OpenSimpleStream();
+	Stream::FileHandleReader reader1(fileHandle);
+	Stream::FileHandleReader reader2(fileHandle, 1, 4);
+
+	char c;
+	reader1.Read(c);
+	EXPECT_EQ('t', c);
+	reader2.Read(c);
+	EXPECT_EQ('e', c);
+	reader1.Read(c);
+	EXPECT_EQ('e', c);
+	EXPECT_EQ(2u, reader1.Position());
+	EXPECT_EQ(1u, reader2.Position());
+
+	auto slice = reader2.Slice(2);
+	EXPECT_EQ(3u, reader2.Position());
+	std::string contents(2, '\0');
+	slice.Read(contents);
+	EXPECT_EQ("st", contents);
+}
+
+TEST(FileHandleReader, ConcurrentReads) {
+	auto fileHandle = OpenSimpleStream();
+
+	std::vector<std::thread> threads;
+	std::vector<int> matches(8, 0);
+	for (std::size_t t = 0; t < matches.size(); ++t) {
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < 200; ++i) {
+				Stream::FileHandleReader reader(fileHandle, t % 5, 5 - t % 5);
+				std::string contents(static_cast<std::size_t>(reader.Length()), '\0');
+				reader.Read(contents);
+				matches[t] += (contents == std::string("test!").substr(t % 5)) ? 1 : 0;
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	for (auto matchCount : matches) {
+		EXPECT_EQ(200, matchCount);
+	}
+}
@@ -1,6 +1,10 @@
 #include "BidirectionalReader.test.h"
 #include "Stream/FileReader.h"
+#include "Stream/FileWriter.h"
+#include "XFile.h"
 #include <array>
+#include <vector>
+#include <string>
 
 using namespace OP2Utility;
 
@@ -51,3 +55,68 @@ TEST_F(SimpleFileReader, SeekRelativeOutOfBoundsBeginningPreservesPosition) {
 TEST_F(SimpleFileReader, StreamSizeMatchesInitialization) {
 	EXPECT_EQ(5u, stream.Length());
 }
+
+TEST_F(SimpleFileReader, BorrowCopiesFileData) {
+	EXPECT_EQ(nullptr, stream.TryGetContiguous(1));
+	EXPECT_EQ(0u, stream.Position());
+
+	std::vector<uint8_t> copyBuffer;
+	const auto* data = stream.Borrow(4, copyBuffer);
+	EXPECT_EQ(copyBuffer.data(), data);
+	EXPECT_EQ("test", std::string(reinterpret_cast<const char*>(data), 4));
+	EXPECT_EQ(4u, stream.Position());
+}
+
+TEST(FileReaderTest, BufferedReads) {
+	const std::string filename("Stream/data/BufferedReads.bin");
+	std::vector<uint8_t> contents(100);
+	for (std::size_t i = 0; i < contents.size(); ++i) {
+		contents[i] = static_cast<uint8_t>(i);
+	}
+	Stream::FileWriter(filename).Write(contents);
+
+	{
+		// Small buffer, so reads cross buffer boundaries
+		Stream::FileReader stream(filename, 16);
+		std::vector<uint8_t> buffer(10);
+
+		stream.Read(buffer);
+		EXPECT_EQ(std::vector<uint8_t>(contents.begin(), contents.begin() + 10), buffer);
+		stream.Read(buffer);
+		EXPECT_EQ(std::vector<uint8_t>(contents.begin() + 10, contents.begin() + 20), buffer);
+		EXPECT_EQ(20u, stream.Position());
+
+		// Seeking back within the buffered range
+		stream.SeekBackward(5);
+		uint8_t value;
+		stream.Read(value);
+		EXPECT_EQ(15u, value);
+
+		// Reads larger than the buffer bypass it
+		std::vector<uint8_t> largeBuffer(40);
+		stream.Read(largeBuffer);
+		EXPECT_EQ(std::vector<uint8_t>(contents.begin() + 16, contents.begin() + 56), largeBuffer);
+
+		stream.Seek(95);
+		EXPECT_EQ(5u, stream.ReadPartial(buffer.data(), buffer.size()));
+		EXPECT_EQ(std::vector<uint8_t>(contents.begin() + 95, contents.end()), std::vector<uint8_t>(buffer.begin(), buffer.begin() + 5));
+		EXPECT_EQ(0u, stream.ReadPartial(buffer.data(), buffer.size()));
+
+		stream.Seek(95);
+		EXPECT_THROW(stream.Read(buffer), std::runtime_error);
+		EXPECT_EQ(95u, stream.Position());
+		EXPECT_THROW(stream.Seek(101), std::runtime_error);
+		EXPECT_THROW(stream.SeekForward(6), std::runtime_error);
+	}
+
+	{
+		// Copies read independently
+		Stream::FileReader stream(filename);
+		stream.Seek(50);
+		Stream::FileReader copy(stream);
+		EXPECT_EQ(0u, copy.Position());
+		EXPECT_EQ(100u, copy.Length());
+	}
+
+	XFile::DeletePath(filename);
+}
@@ -1,4 +1,5 @@
 #include "Stream/FileWriter.h"
+#include "Stream/FileReader.h"
 #include "XFile.h"
 #include <gtest/gtest.h>
 #include <string>
@@ -63,6 +64,31 @@ TEST(FileWriterOpenMode, PermissionChecks) {
 	XFile::DeletePath(directoryAndFilename);
 }
 
+TEST(FileWriterOpenMode, ExistingContentsKeptWithoutTruncate) {
+	using OpenMode = Stream::FileWriter::OpenMode;
+	const std::string filename("OpenModeExistingContents.temp");
+
+	{
+		Stream::FileWriter writer(filename);
+		writer.Write("ABCD", 4);
+	}
+	{
+		// Overwrite in place, without truncating
+		Stream::FileWriter writer(filename, OpenMode::CanOpenExisting);
+		EXPECT_EQ(4u, writer.Length());
+		writer.Seek(1);
+		writer.Write("X", 1);
+	}
+	{
+		Stream::FileReader reader(filename);
+		std::string contents(4, '\0');
+		reader.Read(contents);
+		EXPECT_EQ("AXCD", contents);
+	}
+
+	XFile::DeletePath(filename);
+}
+
 
 TEST(FileWriter, MoveConstructible) {
 	std::string filename("TestFile.temp");
@@ -75,6 +101,57 @@ TEST(FileWriter, MoveConstructible) {
 	XFile::DeletePath(filename);
 }
 
+TEST(FileWriter, BufferedWrites) {
+	const std::string filename("BufferedWrites.temp");
+	{
+		Stream::FileWriter writer(filename, Stream::FileWriter::OpenMode::Default, 4);
+		writer.Write("ab", 2);
+		writer.Write("c", 1);
+		EXPECT_EQ(3u, writer.Position());
+		EXPECT_EQ(0u, XFile::GetFileSize(filename));
+
+		// Writes which overflow the buffer write it out first
+		writer.Write("de", 2);
+		EXPECT_EQ(5u, writer.Position());
+		writer.Flush();
+		EXPECT_EQ(5u, XFile::GetFileSize(filename));
+
+		// Large writes pass straight through
+		writer.Write("fghi", 4);
+		EXPECT_EQ(9u, writer.Position());
+
+		// Seeking writes buffered data before moving
+		writer.Write("j", 1);
+		EXPECT_EQ(10u, writer.Length());
+		writer.Write("k", 1);
+		writer.SeekBackward(11);
+		writer.Write("A", 1);
+		writer.SeekForward(10);
+		writer.Write("l", 1);
+		EXPECT_EQ(12u, writer.Position());
+
+		// Moved writers keep buffered data
+		Stream::FileWriter movedWriter(std::move(writer));
+		movedWriter.Write("m", 1);
+	}
+
+	Stream::FileReader reader(filename);
+	std::string contents(static_cast<std::size_t>(reader.Length()), '\0');
+	reader.Read(contents);
+	EXPECT_EQ("Abcdefghijklm", contents);
+
+	XFile::DeletePath(filename);
+}
+
+#ifdef __linux__
+// Writes to /dev/full fail as if the disk were full
+TEST(FileWriter, FlushReportsWriteErrors) {
+	Stream::FileWriter writer("/dev/full");
+	writer.Write("abc", 3);
+	EXPECT_THROW(writer.Flush(), std::runtime_error);
+}
+#endif
+
 TEST(FileWriter, InvalidFilename) {
 	EXPECT_THROW(Stream::FileWriter fileWriter(""), std::runtime_error);
 	EXPECT_THROW(Stream::FileWriter fileWriter("data"), std::runtime_error);
@@ -0,0 +1,52 @@
+#include "BidirectionalReader.test.h"
+#include "Stream/MemoryMappedFile.h"
+#include "Stream/SharedMemoryReader.h"
+#include <memory>
+#include <string>
+
+using namespace OP2Utility;
+
+namespace {
+	std::shared_ptr<const Stream::MemoryMappedFile> MapSimpleStream()
+	{
+		return std::make_shared<const Stream::MemoryMappedFile>("Stream/data/SimpleStream.txt");
+	}
+}
+
+template <>
+Stream::SharedMemoryReader CreateBidirectionalReader<Stream::SharedMemoryReader>() {
+	auto mappedFile = MapSimpleStream();
+	return Stream::SharedMemoryReader(mappedFile, mappedFile->Data(), mappedFile->Size());
+}
+
+INSTANTIATE_TYPED_TEST_SUITE_P(SharedMemoryReader, SimpleBidirectionalReader, Stream::SharedMemoryReader);
+
+
+TEST(MemoryMappedFile, MapsFileContents) {
+	Stream::MemoryMappedFile mappedFile("Stream/data/SimpleStream.txt");
+
+	ASSERT_EQ(5u, mappedFile.Size());
+	EXPECT_EQ("Stream/data/SimpleStream.txt", mappedFile.GetFilename());
+	EXPECT_EQ("test!", std::string(static_cast<const char*>(mappedFile.Data()), mappedFile.Size()));
+}
+
+TEST(MemoryMappedFile, EmptyFile) {
+	Stream::MemoryMappedFile mappedFile("Stream/data/EmptyFile.txt");
+
+	EXPECT_EQ(0u, mappedFile.Size());
+	EXPECT_EQ(nullptr, mappedFile.Data());
+}
+
+TEST(MemoryMappedFile, AccessNonexistingFile) {
+	EXPECT_THROW(Stream::MemoryMappedFile("Stream/MissingFile.txt"), std::runtime_error);
+}
+
+TEST(SharedMemoryReader, KeepsMappingAlive) {
+	auto mappedFile = MapSimpleStream();
+	Stream::SharedMemoryReader reader(mappedFile, mappedFile->Data(), mappedFile->Size());
+	mappedFile.reset();
+
+	std::string contents(5, '\0');
+	reader.Read(contents);
+	EXPECT_EQ("test!", contents);
+}
@@ -2,6 +2,7 @@
 #include "BidirectionalReader.test.h"
 #include "Stream/MemoryReader.h"
 #include <array>
+#include <vector>
 #include <string>
 #include <stdexcept>
 
@@ -87,6 +88,35 @@ TEST_F(SimpleMemoryReader, SeekRelativeOutOfBoundsEndPreservesPosition) {
 	EXPECT_EQ(position, stream.Position());
 }
 
+TEST_F(SimpleMemoryReader, ReadPartialPastEndStopsAtEnd) {
+	std::array<char, 8> destinationBuffer;
+	EXPECT_EQ(5u, stream.ReadPartial(destinationBuffer.data(), destinationBuffer.size()));
+	EXPECT_EQ(5u, stream.Position());
+	EXPECT_EQ(0u, stream.ReadPartial(destinationBuffer.data(), destinationBuffer.size()));
+}
+
+TEST_F(SimpleMemoryReader, TryGetContiguousPointsIntoBuffer) {
+	EXPECT_EQ(buffer.data(), stream.TryGetContiguous(2));
+	EXPECT_EQ(2u, stream.Position());
+
+	// Requests past the end fail without moving
+	EXPECT_EQ(nullptr, stream.TryGetContiguous(4));
+	EXPECT_EQ(2u, stream.Position());
+
+	EXPECT_EQ(buffer.data() + 2, stream.TryGetContiguous(3));
+	EXPECT_NE(nullptr, stream.TryGetContiguous(0));
+}
+
+TEST_F(SimpleMemoryReader, BorrowDoesNotCopy) {
+	std::vector<uint8_t> copyBuffer;
+	stream.SeekForward(1);
+	EXPECT_EQ(reinterpret_cast<const uint8_t*>(buffer.data() + 1), stream.Borrow(3, copyBuffer));
+	EXPECT_TRUE(copyBuffer.empty());
+	EXPECT_EQ(4u, stream.Position());
+
+	EXPECT_THROW(stream.Borrow(2, copyBuffer), std::runtime_error);
+}
+
 TEST(MemoryReader, ReadNullTerminatedStringUnbounded)
 {
 	constexpr std::array<char, 5> terminatedBuffer{ 'n', 'u', 'l', 'l', '\0' };
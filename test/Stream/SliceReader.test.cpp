@@ -89,3 +89,19 @@ TEST(FileSliceReader, SliceOfSliceMatchesCorrectOffset2Param) {
 	EXPECT_EQ(data, data1);
 	EXPECT_EQ(data, data2);
 }
+
+TEST(FileSliceReader, SliceOutlivesSourceStream) {
+	auto slice = Stream::FileReader("Stream/data/SimpleStream.txt").Slice(1, 3);
+	auto sliceCopy = slice;
+
+	// Slices share the source's open file, with their own positions
+	char data[3];
+	slice.Read(data);
+	EXPECT_EQ(std::string("est"), std::string(data, sizeof(data)));
+	EXPECT_EQ(0u, sliceCopy.Position());
+	EXPECT_THROW(slice.Read(data[0]), std::runtime_error);
+
+	sliceCopy.Seek(2);
+	sliceCopy.Read(data[0]);
+	EXPECT_EQ('t', data[0]);
+}